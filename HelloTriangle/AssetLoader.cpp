@@ -0,0 +1,169 @@
+#include "AssetLoader.h"
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+
+namespace
+{
+	const char ARCHIVE_MAGIC[4] = { 'H', 'T', 'P', 'K' };
+	const uint32_t ARCHIVE_VERSION = 1;
+	//NOTE: keeps every entry aligned for SPIR-V and vertex data, the archive mapping itself is page aligned
+	const uint64_t ARCHIVE_ENTRY_ALIGNMENT = 64;
+	const size_t ARCHIVE_MAX_NAME_LENGTH = 111;
+
+	struct SArchiveHeader
+	{
+		char		Magic[4];
+		uint32_t	Version;
+		uint32_t	EntryCount;
+		uint32_t	Reserved;
+	};
+
+	struct SArchiveRecord
+	{
+		uint64_t	Offset;
+		uint64_t	Size;
+		char		Name[ARCHIVE_MAX_NAME_LENGTH + 1];
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+static bool __isSpirvName(const std::string& vName)
+{
+	return vName.size() >= 4 && vName.compare(vName.size() - 4, 4, ".spv") == 0;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CAssetLoader::openArchive(const std::string& vArchiveFile)
+{
+	closeArchive();
+
+	if (!m_Archive.open(vArchiveFile))
+		throw std::runtime_error("failed to open asset archive: " + vArchiveFile);
+
+	SArchiveHeader Header;
+	if (m_Archive.getSize() < sizeof(Header))
+		throw std::runtime_error("invalid asset archive: " + vArchiveFile);
+	memcpy(&Header, m_Archive.getData(), sizeof(Header));
+
+	uint64_t RecordsEnd = sizeof(Header) + static_cast<uint64_t>(Header.EntryCount) * sizeof(SArchiveRecord);
+	if (memcmp(Header.Magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 || Header.Version != ARCHIVE_VERSION || RecordsEnd > m_Archive.getSize())
+		throw std::runtime_error("invalid asset archive: " + vArchiveFile);
+
+	for (uint32_t i = 0; i < Header.EntryCount; ++i)
+	{
+		SArchiveRecord Record;
+		memcpy(&Record, m_Archive.getData() + sizeof(Header) + i * sizeof(SArchiveRecord), sizeof(Record));
+		Record.Name[ARCHIVE_MAX_NAME_LENGTH] = '\0';
+
+		if (Record.Offset < RecordsEnd || Record.Offset > m_Archive.getSize() || Record.Size > m_Archive.getSize() - Record.Offset)
+			throw std::runtime_error("invalid asset archive entry: " + std::string(Record.Name));
+
+		//NOTE: views are handed out as they are, SPIR-V in particular goes straight to vkCreateShaderModule as uint32_t words
+		if (Record.Offset % ARCHIVE_ENTRY_ALIGNMENT != 0 || (__isSpirvName(Record.Name) && Record.Size % sizeof(uint32_t) != 0))
+			throw std::runtime_error("misaligned asset archive entry: " + std::string(Record.Name));
+
+		m_Entries[Record.Name] = { Record.Offset, Record.Size };
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CAssetLoader::closeArchive()
+{
+	m_Entries.clear();
+	m_Archive.close();
+}
+
+//******************************************************************************************
+//FUNCTION:
+CAsset CAssetLoader::load(const std::string& vName) const
+{
+	auto Iter = m_Entries.find(vName);
+	if (Iter != m_Entries.end())
+	{
+		++m_ArchiveLoadCount;
+		m_LoadedBytes += Iter->second.Size;
+		return CAsset(m_Archive.getData() + Iter->second.Offset, static_cast<size_t>(Iter->second.Size));
+	}
+
+	CMappedFile File;
+	if (!File.open(vName))
+		throw std::runtime_error("failed to open file: " + vName);
+
+	++m_FileLoadCount;
+	m_LoadedBytes += File.getSize();
+	return CAsset(std::move(File));
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CAssetLoader::packArchive(const std::string& vArchiveFile, const std::vector<std::string>& vFiles)
+{
+	std::vector<CMappedFile> Files(vFiles.size());
+	std::vector<SArchiveRecord> Records(vFiles.size());
+
+	uint64_t Offset = sizeof(SArchiveHeader) + vFiles.size() * sizeof(SArchiveRecord);
+	for (size_t i = 0; i < vFiles.size(); ++i)
+	{
+		if (vFiles[i].size() > ARCHIVE_MAX_NAME_LENGTH)
+			throw std::runtime_error("asset name is too long for the archive: " + vFiles[i]);
+		if (!Files[i].open(vFiles[i]))
+			throw std::runtime_error("failed to open file: " + vFiles[i]);
+		if (__isSpirvName(vFiles[i]) && Files[i].getSize() % sizeof(uint32_t) != 0)
+			throw std::runtime_error("SPIR-V file is no whole number of words: " + vFiles[i]);
+
+		Offset = (Offset + ARCHIVE_ENTRY_ALIGNMENT - 1) / ARCHIVE_ENTRY_ALIGNMENT * ARCHIVE_ENTRY_ALIGNMENT;
+
+		memset(&Records[i], 0, sizeof(SArchiveRecord));
+		Records[i].Offset = Offset;
+		Records[i].Size = Files[i].getSize();
+		memcpy(Records[i].Name, vFiles[i].data(), vFiles[i].size());
+
+		Offset += Files[i].getSize();
+	}
+
+	SArchiveHeader Header = {};
+	memcpy(Header.Magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+	Header.Version = ARCHIVE_VERSION;
+	Header.EntryCount = static_cast<uint32_t>(vFiles.size());
+
+	//NOTE: write next to the target and rename over it, so a crash mid-write never leaves a truncated archive behind
+	std::string TempArchiveFile = vArchiveFile + ".tmp";
+	{
+		std::ofstream Archive(TempArchiveFile, std::ios::binary | std::ios::trunc);
+		if (!Archive.is_open())
+			throw std::runtime_error("failed to write asset archive: " + TempArchiveFile);
+
+		Archive.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		Archive.write(reinterpret_cast<const char*>(Records.data()), Records.size() * sizeof(SArchiveRecord));
+
+		uint64_t Position = sizeof(Header) + Records.size() * sizeof(SArchiveRecord);
+		const char Padding[ARCHIVE_ENTRY_ALIGNMENT] = {};
+		for (size_t i = 0; i < Files.size(); ++i)
+		{
+			Archive.write(Padding, Records[i].Offset - Position);
+			Archive.write(Files[i].getData(), Files[i].getSize());
+			Position = Records[i].Offset + Records[i].Size;
+		}
+
+		if (!Archive.good())
+			throw std::runtime_error("failed to write asset archive: " + TempArchiveFile);
+	}
+
+	std::error_code ErrorCode;
+	std::filesystem::rename(TempArchiveFile, vArchiveFile, ErrorCode);
+	if (ErrorCode)
+		throw std::runtime_error("failed to replace asset archive " + vArchiveFile + ": " + ErrorCode.message());
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CAssetLoader::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	vOutput << "{ \"archive\": " << (hasArchive() ? "true" : "false") << ", \"archive_loads\": " << m_ArchiveLoadCount
+		<< ", \"file_loads\": " << m_FileLoadCount << ", \"loaded_bytes\": " << m_LoadedBytes << " }";
+}
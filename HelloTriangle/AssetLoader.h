@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+#include <utility>
+#include "MappedFile.h"
+
+//NOTE: either a view into the archive mapping or its own mapping of a loose file, which is unmapped with the asset
+class CAsset
+{
+public:
+	CAsset() = default;
+	CAsset(const char* vData, size_t vSize) : m_pData(vData), m_Size(vSize) {}
+	explicit CAsset(CMappedFile&& vFile) : m_File(std::move(vFile)), m_pData(m_File.getData()), m_Size(m_File.getSize()) {}
+
+	const char* getData() const { return m_pData; }
+	size_t getSize() const { return m_Size; }
+
+private:
+	CMappedFile	m_File;
+	const char*	m_pData = nullptr;
+	size_t		m_Size = 0;
+};
+
+class CAssetLoader
+{
+public:
+	void openArchive(const std::string& vArchiveFile);
+	void closeArchive();
+
+	bool hasArchive() const { return m_Archive.isOpen(); }
+
+	//NOTE: the archive wins over loose files, an archive view stays valid until the archive is closed
+	CAsset load(const std::string& vName) const;
+
+	static void packArchive(const std::string& vArchiveFile, const std::vector<std::string>& vFiles);
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	struct SArchiveEntry
+	{
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	CMappedFile	m_Archive;
+	std::unordered_map<std::string, SArchiveEntry> m_Entries;
+
+	mutable uint64_t	m_ArchiveLoadCount = 0;
+	mutable uint64_t	m_FileLoadCount = 0;
+	mutable uint64_t	m_LoadedBytes = 0;
+};
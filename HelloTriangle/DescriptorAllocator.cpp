@@ -0,0 +1,154 @@
+#include "DescriptorAllocator.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace
+{
+	const uint32_t MAX_SETS_PER_POOL = 64;
+
+	//NOTE: descriptors per set of each type in a pool; sets and descriptors are counted so a pool is left before it would run out, since exhausting one is undefined on vulkan 1.0 without maintenance1
+	const std::vector<std::pair<VkDescriptorType, uint32_t>> POOL_DESCRIPTORS_PER_SET =
+	{
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 }
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorAllocator::create(VkDevice vDevice, uint32_t vFrameCount)
+{
+	m_VkDevice = vDevice;
+	m_FramePools.resize(vFrameCount);
+	for (auto& Frame : m_FramePools) Frame.CurrentPoolDescriptorCounts.assign(POOL_DESCRIPTORS_PER_SET.size(), 0);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorAllocator::destroy()
+{
+	for (auto& Frame : m_FramePools)
+	{
+		for (auto Pool : Frame.Pools) vkDestroyDescriptorPool(m_VkDevice, Pool, nullptr);
+	}
+	m_FramePools.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorAllocator::resetFrame(uint32_t vFrame)
+{
+	SFramePools& Frame = m_FramePools[vFrame];
+
+	//NOTE: only the pools used since the last reset hold sets, the rest are already empty
+	for (size_t i = 0; i < Frame.Pools.size() && i <= Frame.CurrentPool; ++i) vkResetDescriptorPool(m_VkDevice, Frame.Pools[i], 0);
+
+	Frame.CurrentPool = 0;
+	Frame.CurrentPoolAllocationCount = 0;
+	std::fill(Frame.CurrentPoolDescriptorCounts.begin(), Frame.CurrentPoolDescriptorCounts.end(), 0);
+	Frame.AllocationCount = 0;
+	++m_ResetCount;
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkDescriptorSet CDescriptorAllocator::allocate(uint32_t vFrame, VkDescriptorSetLayout vLayout, const std::vector<VkDescriptorSetLayoutBinding>& vBindings)
+{
+	SFramePools& Frame = m_FramePools[vFrame];
+
+	std::vector<uint32_t> RequiredCounts(POOL_DESCRIPTORS_PER_SET.size(), 0);
+	for (const auto& Binding : vBindings)
+	{
+		auto Iter = std::find_if(POOL_DESCRIPTORS_PER_SET.begin(), POOL_DESCRIPTORS_PER_SET.end(), [&Binding](const std::pair<VkDescriptorType, uint32_t>& vEntry) { return vEntry.first == Binding.descriptorType; });
+		if (Iter == POOL_DESCRIPTORS_PER_SET.end())
+			throw std::runtime_error("descriptor set layout does not fit into a descriptor pool!");
+		RequiredCounts[Iter - POOL_DESCRIPTORS_PER_SET.begin()] += Binding.descriptorCount;
+	}
+	for (size_t i = 0; i < RequiredCounts.size(); ++i)
+	{
+		if (RequiredCounts[i] > POOL_DESCRIPTORS_PER_SET[i].second * MAX_SETS_PER_POOL)
+			throw std::runtime_error("descriptor set layout does not fit into a descriptor pool!");
+	}
+
+	auto fitsIntoCurrentPool = [&Frame, &RequiredCounts]()
+	{
+		if (Frame.CurrentPoolAllocationCount >= MAX_SETS_PER_POOL) return false;
+		for (size_t i = 0; i < RequiredCounts.size(); ++i)
+		{
+			if (Frame.CurrentPoolDescriptorCounts[i] + RequiredCounts[i] > POOL_DESCRIPTORS_PER_SET[i].second * MAX_SETS_PER_POOL) return false;
+		}
+		return true;
+	};
+	auto advancePool = [&Frame]()
+	{
+		++Frame.CurrentPool;
+		Frame.CurrentPoolAllocationCount = 0;
+		std::fill(Frame.CurrentPoolDescriptorCounts.begin(), Frame.CurrentPoolDescriptorCounts.end(), 0);
+	};
+
+	VkDescriptorSetAllocateInfo AllocInfo = {};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	AllocInfo.descriptorSetCount = 1;
+	AllocInfo.pSetLayouts = &vLayout;
+
+	for (;;)
+	{
+		if (!fitsIntoCurrentPool()) advancePool();
+		if (Frame.CurrentPool == Frame.Pools.size()) Frame.Pools.push_back(__createPool());
+		AllocInfo.descriptorPool = Frame.Pools[Frame.CurrentPool];
+
+		VkDescriptorSet DescriptorSet;
+		VkResult Result = vkAllocateDescriptorSets(m_VkDevice, &AllocInfo, &DescriptorSet);
+		if (Result == VK_SUCCESS)
+		{
+			++Frame.CurrentPoolAllocationCount;
+			for (size_t i = 0; i < RequiredCounts.size(); ++i) Frame.CurrentPoolDescriptorCounts[i] += RequiredCounts[i];
+			++Frame.AllocationCount;
+			++m_TotalAllocationCount;
+			m_PeakAllocationsPerFrame = std::max(m_PeakAllocationsPerFrame, Frame.AllocationCount);
+			return DescriptorSet;
+		}
+
+		if (Result != VK_ERROR_OUT_OF_POOL_MEMORY && Result != VK_ERROR_FRAGMENTED_POOL)
+			throw std::runtime_error("failed to allocate descriptor set!");
+
+		//NOTE: only reached when the driver disagrees with the counting above, an empty pool that cannot hold the set never will
+		if (0 == Frame.CurrentPoolAllocationCount)
+			throw std::runtime_error("descriptor set layout does not fit into a descriptor pool!");
+
+		advancePool();
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorAllocator::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	size_t PoolCount = 0;
+	for (const auto& Frame : m_FramePools) PoolCount += Frame.Pools.size();
+
+	vOutput << "{ \"pools\": " << PoolCount << ", \"allocations\": " << m_TotalAllocationCount << ", \"peak_allocations_per_frame\": " << m_PeakAllocationsPerFrame
+		<< ", \"mean_allocations_per_frame\": " << (m_ResetCount > 0 ? static_cast<double>(m_TotalAllocationCount) / m_ResetCount : 0.0) << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkDescriptorPool CDescriptorAllocator::__createPool() const
+{
+	std::vector<VkDescriptorPoolSize> PoolSizes;
+	for (const auto& Entry : POOL_DESCRIPTORS_PER_SET) PoolSizes.push_back({ Entry.first, Entry.second * MAX_SETS_PER_POOL });
+
+	VkDescriptorPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	PoolInfo.maxSets = MAX_SETS_PER_POOL;
+	PoolInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
+	PoolInfo.pPoolSizes = PoolSizes.data();
+
+	VkDescriptorPool Pool;
+	if (vkCreateDescriptorPool(m_VkDevice, &PoolInfo, nullptr, &Pool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create descriptor pool!");
+
+	return Pool;
+}
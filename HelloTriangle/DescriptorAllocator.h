@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+class CDescriptorAllocator
+{
+public:
+	void create(VkDevice vDevice, uint32_t vFrameCount);
+	void destroy();
+
+	//NOTE: must only be called once the frame's fence has signaled, every set allocated for the frame becomes invalid at once
+	void resetFrame(uint32_t vFrame);
+	//NOTE: vBindings are the bindings vLayout was created from, they tell how many descriptors the set takes out of a pool
+	VkDescriptorSet allocate(uint32_t vFrame, VkDescriptorSetLayout vLayout, const std::vector<VkDescriptorSetLayoutBinding>& vBindings);
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	struct SFramePools
+	{
+		std::vector<VkDescriptorPool> Pools;
+		size_t		CurrentPool = 0;
+		uint32_t	CurrentPoolAllocationCount = 0;
+		std::vector<uint32_t> CurrentPoolDescriptorCounts;		//indexed like the pool sizes
+		uint32_t	AllocationCount = 0;
+	};
+
+	VkDevice m_VkDevice = VK_NULL_HANDLE;
+	std::vector<SFramePools> m_FramePools;
+
+	uint64_t m_ResetCount = 0;
+	uint64_t m_TotalAllocationCount = 0;
+	uint32_t m_PeakAllocationsPerFrame = 0;
+
+	VkDescriptorPool __createPool() const;
+};
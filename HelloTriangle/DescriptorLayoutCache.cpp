@@ -0,0 +1,111 @@
+#include "DescriptorLayoutCache.h"
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorLayoutCache::create(VkDevice vDevice)
+{
+	m_VkDevice = vDevice;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorLayoutCache::destroy()
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	for (auto& Bucket : m_Layouts)
+	{
+		for (auto& Entry : Bucket.second) vkDestroyDescriptorSetLayout(m_VkDevice, Entry.Layout, nullptr);
+	}
+	m_Layouts.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkDescriptorSetLayout CDescriptorLayoutCache::getLayout(const std::vector<VkDescriptorSetLayoutBinding>& vBindings)
+{
+	std::vector<VkDescriptorSetLayoutBinding> Bindings = vBindings;
+	std::sort(Bindings.begin(), Bindings.end(), [](const VkDescriptorSetLayoutBinding& vLhs, const VkDescriptorSetLayoutBinding& vRhs) { return vLhs.binding < vRhs.binding; });
+
+	size_t Hash = hashBindings(Bindings);
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	auto& Bucket = m_Layouts[Hash];
+	for (const auto& Entry : Bucket)
+	{
+		if (__isSameBindings(Entry.Bindings, Bindings))
+		{
+			++m_HitCount;
+			return Entry.Layout;
+		}
+	}
+
+	VkDescriptorSetLayoutCreateInfo LayoutInfo = {};
+	LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	LayoutInfo.bindingCount = static_cast<uint32_t>(Bindings.size());
+	LayoutInfo.pBindings = Bindings.data();
+
+	VkDescriptorSetLayout Layout;
+	if (vkCreateDescriptorSetLayout(m_VkDevice, &LayoutInfo, nullptr, &Layout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create descriptor set layout!");
+
+	++m_MissCount;
+	Bucket.push_back({ Bindings, Layout });
+
+	return Layout;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDescriptorLayoutCache::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	size_t LayoutCount = 0;
+	for (const auto& Bucket : m_Layouts) LayoutCount += Bucket.second.size();
+
+	uint64_t LookupCount = m_HitCount + m_MissCount;
+	vOutput << "{ \"layouts\": " << LayoutCount << ", \"hits\": " << m_HitCount << ", \"misses\": " << m_MissCount
+		<< ", \"hit_rate\": " << (LookupCount > 0 ? static_cast<double>(m_HitCount) / LookupCount : 0.0) << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+size_t CDescriptorLayoutCache::hashBindings(const std::vector<VkDescriptorSetLayoutBinding>& vBindings)
+{
+	//NOTE: immutable samplers are not part of the key, layouts using them must not go through the cache; summing the per binding hashes makes the order irrelevant
+	size_t Hash = std::hash<size_t>()(vBindings.size());
+
+	for (const auto& Binding : vBindings)
+	{
+		size_t BindingHash = 0;
+		auto combine = [&BindingHash](size_t vValue) { BindingHash ^= std::hash<size_t>()(vValue) + 0x9e3779b9 + (BindingHash << 6) + (BindingHash >> 2); };
+		combine(Binding.binding);
+		combine(static_cast<size_t>(Binding.descriptorType));
+		combine(Binding.descriptorCount);
+		combine(Binding.stageFlags);
+		Hash += BindingHash;
+	}
+
+	return Hash;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CDescriptorLayoutCache::__isSameBindings(const std::vector<VkDescriptorSetLayoutBinding>& vLhs, const std::vector<VkDescriptorSetLayoutBinding>& vRhs)
+{
+	if (vLhs.size() != vRhs.size()) return false;
+
+	for (size_t i = 0; i < vLhs.size(); ++i)
+	{
+		if (vLhs[i].binding != vRhs[i].binding || vLhs[i].descriptorType != vRhs[i].descriptorType ||
+			vLhs[i].descriptorCount != vRhs[i].descriptorCount || vLhs[i].stageFlags != vRhs[i].stageFlags)
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+class CDescriptorLayoutCache
+{
+public:
+	void create(VkDevice vDevice);
+	void destroy();
+
+	//NOTE: layouts are owned by the cache, identical binding lists always map to the same layout no matter their order
+	VkDescriptorSetLayout getLayout(const std::vector<VkDescriptorSetLayoutBinding>& vBindings);
+
+	//NOTE: the key getLayout looks layouts up by, it does not depend on the order of the bindings
+	static size_t hashBindings(const std::vector<VkDescriptorSetLayoutBinding>& vBindings);
+
+	uint64_t getHitCount() const { return m_HitCount; }
+	uint64_t getMissCount() const { return m_MissCount; }
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	struct SLayoutEntry
+	{
+		std::vector<VkDescriptorSetLayoutBinding> Bindings;
+		VkDescriptorSetLayout Layout;
+	};
+
+	VkDevice m_VkDevice = VK_NULL_HANDLE;
+	std::unordered_map<size_t, std::vector<SLayoutEntry>> m_Layouts;
+	mutable std::mutex m_Mutex;
+
+	uint64_t m_HitCount = 0;
+	uint64_t m_MissCount = 0;
+
+	static bool __isSameBindings(const std::vector<VkDescriptorSetLayoutBinding>& vLhs, const std::vector<VkDescriptorSetLayoutBinding>& vRhs);
+};
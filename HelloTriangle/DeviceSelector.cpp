@@ -0,0 +1,149 @@
+#include "DeviceSelector.h"
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+	//NOTE: the device type dominates the score, memory and the remaining capabilities only order devices of the same type
+	const int DISCRETE_GPU_SCORE = 100000;
+	const int INTEGRATED_GPU_SCORE = 50000;
+	const int VIRTUAL_GPU_SCORE = 20000;
+	const int OTHER_DEVICE_SCORE = 10000;
+	const int CPU_DEVICE_SCORE = 0;
+	const VkDeviceSize MEMORY_SCORE_GRANULARITY = 64 * 1024 * 1024;
+	const int MAX_MEMORY_SCORE = 8192;
+	const int DEDICATED_COMPUTE_QUEUE_SCORE = 500;
+	const int DEDICATED_TRANSFER_QUEUE_SCORE = 500;
+	const int MULTI_DRAW_INDIRECT_SCORE = 500;
+	const uint32_t IMAGE_DIMENSION_SCORE_GRANULARITY = 1024;
+}
+
+//******************************************************************************************
+//FUNCTION:
+SPhysicalDeviceInfo CDeviceSelector::queryDeviceInfo(VkPhysicalDevice vDevice)
+{
+	SPhysicalDeviceInfo Info;
+	Info.Device = vDevice;
+	vkGetPhysicalDeviceProperties(vDevice, &Info.Properties);
+	vkGetPhysicalDeviceFeatures(vDevice, &Info.Features);
+	vkGetPhysicalDeviceMemoryProperties(vDevice, &Info.MemoryProperties);
+
+	uint32_t QueueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(vDevice, &QueueFamilyCount, nullptr);
+	Info.QueueFamilies.resize(QueueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(vDevice, &QueueFamilyCount, Info.QueueFamilies.data());
+
+	return Info;
+}
+
+//******************************************************************************************
+//FUNCTION:
+int CDeviceSelector::computeScore(const SPhysicalDeviceInfo& vInfo)
+{
+	if (!vInfo.IsSuitable) return -1;
+
+	int Score = 0;
+	switch (vInfo.Properties.deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: Score += DISCRETE_GPU_SCORE; break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: Score += INTEGRATED_GPU_SCORE; break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: Score += VIRTUAL_GPU_SCORE; break;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU: Score += CPU_DEVICE_SCORE; break;
+	default: Score += OTHER_DEVICE_SCORE; break;
+	}
+
+	VkDeviceSize DeviceLocalSize = __getDeviceLocalHeapSize(vInfo.MemoryProperties);
+	Score += static_cast<int>(std::min<VkDeviceSize>(DeviceLocalSize / MEMORY_SCORE_GRANULARITY, MAX_MEMORY_SCORE));
+
+	//NOTE: queues without graphics let compute and uploads run beside rendering instead of being serialized with it
+	if (__hasDedicatedQueueFamily(vInfo.QueueFamilies, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT)) Score += DEDICATED_COMPUTE_QUEUE_SCORE;
+	if (__hasDedicatedQueueFamily(vInfo.QueueFamilies, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) Score += DEDICATED_TRANSFER_QUEUE_SCORE;
+
+	if (vInfo.Features.multiDrawIndirect && vInfo.Features.drawIndirectFirstInstance) Score += MULTI_DRAW_INDIRECT_SCORE;
+	Score += static_cast<int>(vInfo.Properties.limits.maxImageDimension2D / IMAGE_DIMENSION_SCORE_GRANULARITY);
+
+	return Score;
+}
+
+//******************************************************************************************
+//FUNCTION:
+int CDeviceSelector::findOverride(const std::vector<SPhysicalDeviceInfo>& vDevices, const std::string& vOverride)
+{
+	//NOTE: digits that are no valid index fall through to the name match, so model numbers like 3090 still find their device; the length check keeps stoul from overflowing
+	bool IsIndex = !vOverride.empty() && vOverride.size() <= 9 && std::all_of(vOverride.begin(), vOverride.end(), [](unsigned char vChar) { return std::isdigit(vChar); });
+	if (IsIndex && std::stoul(vOverride) < vDevices.size()) return static_cast<int>(std::stoul(vOverride));
+
+	auto toLower = [](std::string vText)
+	{
+		std::transform(vText.begin(), vText.end(), vText.begin(), [](unsigned char vChar) { return static_cast<char>(std::tolower(vChar)); });
+		return vText;
+	};
+
+	std::string Pattern = toLower(vOverride);
+	for (size_t i = 0; i < vDevices.size(); ++i)
+	{
+		if (toLower(vDevices[i].Properties.deviceName).find(Pattern) != std::string::npos) return static_cast<int>(i);
+	}
+
+	return -1;
+}
+
+//******************************************************************************************
+//FUNCTION:
+int CDeviceSelector::findBest(const std::vector<SPhysicalDeviceInfo>& vDevices)
+{
+	int BestIndex = -1;
+	int BestScore = -1;
+	for (size_t i = 0; i < vDevices.size(); ++i)
+	{
+		int Score = computeScore(vDevices[i]);
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestIndex = static_cast<int>(i);
+		}
+	}
+
+	return BestIndex;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDeviceSelector::dumpDeviceList(std::ostream& vOutput, const std::vector<SPhysicalDeviceInfo>& vDevices)
+{
+	const char* const DeviceTypeNames[] = { "other", "integrated", "discrete", "virtual", "cpu" };
+
+	for (size_t i = 0; i < vDevices.size(); ++i)
+	{
+		const auto& Properties = vDevices[i].Properties;
+		int TypeIndex = static_cast<int>(Properties.deviceType);
+		const char* TypeName = (TypeIndex >= 0 && TypeIndex <= 4) ? DeviceTypeNames[TypeIndex] : DeviceTypeNames[0];
+
+		vOutput << "[" << i << "] " << Properties.deviceName << " (" << TypeName << ", " << std::hex << "0x" << Properties.vendorID << ":0x" << Properties.deviceID << std::dec
+			<< ", " << __getDeviceLocalHeapSize(vDevices[i].MemoryProperties) / (1024 * 1024) << " MB device local) score " << computeScore(vDevices[i])
+			<< (vDevices[i].IsSuitable ? "" : " unsuitable") << std::endl;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkDeviceSize CDeviceSelector::__getDeviceLocalHeapSize(const VkPhysicalDeviceMemoryProperties& vMemoryProperties)
+{
+	VkDeviceSize LargestHeap = 0;
+	for (uint32_t i = 0; i < vMemoryProperties.memoryHeapCount; ++i)
+	{
+		if (vMemoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) LargestHeap = std::max(LargestHeap, vMemoryProperties.memoryHeaps[i].size);
+	}
+
+	return LargestHeap;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CDeviceSelector::__hasDedicatedQueueFamily(const std::vector<VkQueueFamilyProperties>& vQueueFamilies, VkQueueFlags vRequiredFlag, VkQueueFlags vExcludedFlags)
+{
+	return std::any_of(vQueueFamilies.begin(), vQueueFamilies.end(), [&](const VkQueueFamilyProperties& vFamily)
+	{
+		return vFamily.queueCount > 0 && (vFamily.queueFlags & vRequiredFlag) && !(vFamily.queueFlags & vExcludedFlags);
+	});
+}
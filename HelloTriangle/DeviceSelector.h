@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+struct SPhysicalDeviceInfo
+{
+	VkPhysicalDevice					Device = VK_NULL_HANDLE;
+	VkPhysicalDeviceProperties			Properties = {};
+	VkPhysicalDeviceFeatures			Features = {};
+	VkPhysicalDeviceMemoryProperties	MemoryProperties = {};
+	std::vector<VkQueueFamilyProperties> QueueFamilies;
+	bool								IsSuitable = false;
+};
+
+class CDeviceSelector
+{
+public:
+	static SPhysicalDeviceInfo queryDeviceInfo(VkPhysicalDevice vDevice);
+
+	//NOTE: depends on nothing but the info struct, so any device description can be scored without a driver; unsuitable devices score -1
+	static int computeScore(const SPhysicalDeviceInfo& vInfo);
+
+	//NOTE: the override is an index into the enumeration order or a case-insensitive part of the device name, digits that are no valid index are matched as a name too; returns -1 when no device matches
+	static int findOverride(const std::vector<SPhysicalDeviceInfo>& vDevices, const std::string& vOverride);
+	static int findBest(const std::vector<SPhysicalDeviceInfo>& vDevices);
+
+	static void dumpDeviceList(std::ostream& vOutput, const std::vector<SPhysicalDeviceInfo>& vDevices);
+
+private:
+	static VkDeviceSize __getDeviceLocalHeapSize(const VkPhysicalDeviceMemoryProperties& vMemoryProperties);
+	static bool __hasDedicatedQueueFamily(const std::vector<VkQueueFamilyProperties>& vQueueFamilies, VkQueueFlags vRequiredFlag, VkQueueFlags vExcludedFlags);
+};
@@ -0,0 +1,80 @@
+#include "DrawSorter.h"
+#include <array>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	const uint32_t RADIX_BITS = 8;
+	const uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+	const uint32_t RADIX_PASS_COUNT = 64 / RADIX_BITS;
+	const uint32_t PIPELINE_ID_BITS = 12;
+	const uint32_t MATERIAL_ID_BITS = 20;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static uint32_t __convertFloatToOrderedBits(float vValue)
+{
+	//NOTE: flipping the sign bit of positive floats and every bit of negative ones makes the unsigned order match the float order
+	uint32_t Bits;
+	memcpy(&Bits, &vValue, sizeof(Bits));
+	return (Bits & 0x80000000u) ? ~Bits : (Bits | 0x80000000u);
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint64_t CDrawSorter::makeSortKey(uint32_t vPipelineId, float vDepth, uint32_t vMaterialId)
+{
+	uint64_t PipelineBits = static_cast<uint64_t>(vPipelineId & ((1u << PIPELINE_ID_BITS) - 1)) << (64 - PIPELINE_ID_BITS);
+	uint64_t DepthBits = static_cast<uint64_t>(__convertFloatToOrderedBits(vDepth)) << MATERIAL_ID_BITS;
+	return PipelineBits | DepthBits | (vMaterialId & ((1u << MATERIAL_ID_BITS) - 1));
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CDrawSorter::sort(const std::vector<uint64_t>& vKeys)
+{
+	size_t Count = vKeys.size();
+	m_Keys.assign(vKeys.begin(), vKeys.end());
+	m_ScratchKeys.resize(Count);
+	m_Order.resize(Count);
+	m_ScratchOrder.resize(Count);
+	for (uint32_t i = 0; i < Count; ++i) m_Order[i] = i;
+	m_LastPassCount = 0;
+
+	//NOTE: all digit histograms come from a single read of the keys, then each least significant digit first pass scatters once
+	std::vector<std::array<uint32_t, RADIX_SIZE>> Histograms(RADIX_PASS_COUNT);
+	for (auto& Histogram : Histograms) Histogram.fill(0);
+	for (uint64_t Key : m_Keys)
+	{
+		for (uint32_t Pass = 0; Pass < RADIX_PASS_COUNT; ++Pass) ++Histograms[Pass][(Key >> (Pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+	}
+
+	for (uint32_t Pass = 0; Pass < RADIX_PASS_COUNT; ++Pass)
+	{
+		auto& Histogram = Histograms[Pass];
+
+		//NOTE: a digit shared by every key would only copy the arrays, with a single pipeline and material most passes are skipped
+		if (std::any_of(Histogram.begin(), Histogram.end(), [Count](uint32_t vBucketSize) { return vBucketSize == Count; })) continue;
+
+		uint32_t Offset = 0;
+		for (uint32_t& Bucket : Histogram)
+		{
+			uint32_t BucketSize = Bucket;
+			Bucket = Offset;
+			Offset += BucketSize;
+		}
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			uint32_t Destination = Histogram[(m_Keys[i] >> (Pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+			m_ScratchKeys[Destination] = m_Keys[i];
+			m_ScratchOrder[Destination] = m_Order[i];
+		}
+
+		m_Keys.swap(m_ScratchKeys);
+		m_Order.swap(m_ScratchOrder);
+		++m_LastPassCount;
+	}
+}
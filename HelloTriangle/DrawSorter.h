@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+class CDrawSorter
+{
+public:
+	//NOTE: pipeline in the top 12 bits so state changes are grouped first, then depth in 32 bits, then material in the low 20 bits
+	static uint64_t makeSortKey(uint32_t vPipelineId, float vDepth, uint32_t vMaterialId);
+
+	//NOTE: stable and ascending, the resulting order lists indices into vKeys
+	void sort(const std::vector<uint64_t>& vKeys);
+
+	const std::vector<uint32_t>& getOrder() const { return m_Order; }
+	uint32_t getLastPassCount() const { return m_LastPassCount; }
+
+private:
+	std::vector<uint64_t> m_Keys;
+	std::vector<uint64_t> m_ScratchKeys;
+	std::vector<uint32_t> m_Order;
+	std::vector<uint32_t> m_ScratchOrder;
+	uint32_t m_LastPassCount = 0;
+};
@@ -0,0 +1,378 @@
+#include "FrameCapture.h"
+#include "ImageEncoder.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+	const char* const FILE_FORMAT_EXTENSIONS[] = { ".png", ".rgba" };
+	const char* const FILE_FORMAT_NAMES[] = { "png", "raw" };
+	static_assert(sizeof(FILE_FORMAT_EXTENSIONS) / sizeof(FILE_FORMAT_EXTENSIONS[0]) == static_cast<size_t>(ECaptureFileFormat::Count), "every capture file format needs an extension");
+
+	const uint32_t NO_SLOT = ~0u;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static bool __readFile(const std::string& vFilename, std::vector<char>& voData)
+{
+	std::ifstream File(vFilename, std::ios::ate | std::ios::binary);
+	if (!File.is_open()) return false;
+
+	voData.resize(static_cast<size_t>(File.tellg()));
+	File.seekg(0);
+	File.read(voData.data(), voData.size());
+
+	return File.good();
+}
+
+//******************************************************************************************
+//FUNCTION:
+static bool __writeFile(const std::string& vFilename, const std::vector<uint8_t>& vData)
+{
+	std::ofstream File(vFilename, std::ios::binary | std::ios::trunc);
+	if (!File.is_open()) return false;
+
+	File.write(reinterpret_cast<const char*>(vData.data()), vData.size());
+	return File.good();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::create(VkDevice vDevice, CGpuMemoryAllocator* vAllocator, const std::string& vDirectory, ECaptureFileFormat vFileFormat, uint32_t vSlotCount, uint32_t vEncoderThreadCount, bool vIsBlocking)
+{
+	m_VkDevice = vDevice;
+	m_pAllocator = vAllocator;
+	m_Directory = vDirectory;
+	m_FileFormat = vFileFormat;
+	m_IsBlocking = vIsBlocking;
+	m_Slots.assign(std::max(vSlotCount, 1u), SReadbackSlot());
+	m_NextSlot = 0;
+
+	std::error_code ErrorCode;
+	std::filesystem::create_directories(m_Directory, ErrorCode);
+	if (ErrorCode) throw std::runtime_error("failed to create capture directory " + m_Directory + ": " + ErrorCode.message());
+
+	m_IsStopping = false;
+	for (uint32_t i = 0; i < std::max(vEncoderThreadCount, 1u); ++i) m_EncoderThreads.emplace_back(&CFrameCapture::__encodeLoop, this);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::destroy()
+{
+	flush();
+	__stopEncoders();
+	__destroySlotBuffers();
+	m_Slots.clear();
+	m_EncodeQueue.clear();
+	m_VkDevice = VK_NULL_HANDLE;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CFrameCapture::setTarget(VkExtent2D vExtent, VkFormat vFormat)
+{
+	flush();
+
+	if (vFormat != VK_FORMAT_R8G8B8A8_UNORM && vFormat != VK_FORMAT_R8G8B8A8_SRGB && vFormat != VK_FORMAT_B8G8R8A8_UNORM && vFormat != VK_FORMAT_B8G8R8A8_SRGB) return false;
+
+	__destroySlotBuffers();
+	m_Extent = vExtent;
+	m_IsBgra = vFormat == VK_FORMAT_B8G8R8A8_UNORM || vFormat == VK_FORMAT_B8G8R8A8_SRGB;
+	__createSlotBuffers();
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CFrameCapture::recordReadback(VkCommandBuffer vCommandBuffer, uint32_t vFrame, VkImage vImage, uint64_t vFrameNumber)
+{
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+
+	const uint32_t SlotCount = static_cast<uint32_t>(m_Slots.size());
+	auto findFreeSlot = [this, SlotCount]()
+	{
+		for (uint32_t i = 0; i < SlotCount; ++i)
+		{
+			uint32_t Index = (m_NextSlot + i) % SlotCount;
+			if (m_Slots[Index].State == ESlotState::Free) return Index;
+		}
+		return NO_SLOT;
+	};
+
+	uint32_t SlotIndex = findFreeSlot();
+	if (NO_SLOT == SlotIndex && m_IsBlocking)
+	{
+		//NOTE: only the slots held by the encoders can free up meanwhile, the copying ones wait for a fence this thread has not waited on yet
+		auto StartTime = std::chrono::steady_clock::now();
+		m_IdleSignal.wait(Lock, [&]()
+		{
+			SlotIndex = findFreeSlot();
+			return SlotIndex != NO_SLOT || std::none_of(m_Slots.begin(), m_Slots.end(), [](const SReadbackSlot& vSlot) { return vSlot.State == ESlotState::Encoding; });
+		});
+		m_SlotWaitTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	}
+
+	if (NO_SLOT == SlotIndex)
+	{
+		++m_DroppedFrameCount;
+		return false;
+	}
+
+	SReadbackSlot& Slot = m_Slots[SlotIndex];
+	Slot.State = ESlotState::Copying;
+	Slot.Frame = vFrame;
+	Slot.FrameNumber = vFrameNumber;
+	m_NextSlot = (SlotIndex + 1) % SlotCount;
+	Lock.unlock();
+
+	VkBufferImageCopy Region = {};
+	Region.bufferOffset = 0;
+	Region.bufferRowLength = 0;
+	Region.bufferImageHeight = 0;
+	Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.imageSubresource.mipLevel = 0;
+	Region.imageSubresource.baseArrayLayer = 0;
+	Region.imageSubresource.layerCount = 1;
+	Region.imageOffset = { 0, 0, 0 };
+	Region.imageExtent = { m_Extent.width, m_Extent.height, 1 };
+	vkCmdCopyImageToBuffer(vCommandBuffer, vImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Slot.Buffer, 1, &Region);
+
+	//NOTE: the fence makes the copy available, the barrier still has to make it visible to host reads
+	VkBufferMemoryBarrier HostBarrier = {};
+	HostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	HostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	HostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	HostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	HostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	HostBarrier.buffer = Slot.Buffer;
+	HostBarrier.offset = 0;
+	HostBarrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &HostBarrier, 0, nullptr);
+
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::collect(uint32_t vFrame)
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		for (uint32_t i = 0; i < m_Slots.size(); ++i)
+		{
+			if (m_Slots[i].State != ESlotState::Copying || m_Slots[i].Frame != vFrame) continue;
+
+			m_Slots[i].State = ESlotState::Encoding;
+			m_EncodeQueue.push_back(i);
+		}
+	}
+	m_WorkSignal.notify_all();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::flush()
+{
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	for (uint32_t i = 0; i < m_Slots.size(); ++i)
+	{
+		if (m_Slots[i].State != ESlotState::Copying) continue;
+
+		m_Slots[i].State = ESlotState::Encoding;
+		m_EncodeQueue.push_back(i);
+	}
+	m_WorkSignal.notify_all();
+
+	m_IdleSignal.wait(Lock, [this]() { return m_EncodeQueue.empty() && 0 == m_BusyEncoderCount; });
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CFrameCapture::compareWithReference(const std::string& vDirectory)
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	std::vector<std::string> ReferenceFiles;
+	std::error_code ErrorCode;
+	for (const auto& Entry : std::filesystem::directory_iterator(vDirectory, ErrorCode))
+	{
+		if (Entry.is_regular_file() && Entry.path().extension() == FILE_FORMAT_EXTENSIONS[static_cast<int>(m_FileFormat)]) ReferenceFiles.push_back(Entry.path().filename().string());
+	}
+	if (ErrorCode || ReferenceFiles.empty())
+	{
+		std::cerr << "no reference frames found in " << vDirectory << std::endl;
+		return false;
+	}
+	std::sort(ReferenceFiles.begin(), ReferenceFiles.end());
+
+	//NOTE: a reference frame that was dropped counts as a failure too, comparisons want blocking captures
+	m_ReferenceMatchCount = m_ReferenceMismatchCount = m_ReferenceMissingCount = 0;
+	std::vector<char> Captured, Reference;
+	for (const auto& Filename : ReferenceFiles)
+	{
+		if (std::find(m_WrittenFiles.begin(), m_WrittenFiles.end(), Filename) == m_WrittenFiles.end())
+		{
+			std::cerr << "reference frame " << Filename << " was not captured" << std::endl;
+			++m_ReferenceMissingCount;
+			continue;
+		}
+
+		bool IsRead = __readFile((std::filesystem::path(m_Directory) / Filename).string(), Captured) && __readFile((std::filesystem::path(vDirectory) / Filename).string(), Reference);
+		if (IsRead && Captured == Reference)
+		{
+			++m_ReferenceMatchCount;
+			continue;
+		}
+
+		std::cerr << "captured frame " << Filename << " differs from the reference" << std::endl;
+		++m_ReferenceMismatchCount;
+	}
+
+	return 0 == m_ReferenceMismatchCount && 0 == m_ReferenceMissingCount;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	vOutput << "{ \"format\": \"" << FILE_FORMAT_NAMES[static_cast<int>(m_FileFormat)] << "\", \"slots\": " << m_Slots.size() << ", \"encoder_threads\": " << m_EncoderThreads.size()
+		<< ", \"blocking\": " << (m_IsBlocking ? "true" : "false") << ", \"captured\": " << m_CapturedFrameCount << ", \"dropped\": " << m_DroppedFrameCount
+		<< ", \"failed\": " << m_FailedFrameCount << ", \"bytes_written\": " << m_WrittenBytes
+		<< ", \"avg_encode_ms\": " << (m_CapturedFrameCount > 0 ? m_TotalEncodeTime / m_CapturedFrameCount : 0.0) << ", \"max_encode_ms\": " << m_MaxEncodeTime
+		<< ", \"slot_wait_ms\": " << m_SlotWaitTime << ", \"reference_matches\": " << m_ReferenceMatchCount
+		<< ", \"reference_mismatches\": " << m_ReferenceMismatchCount << ", \"reference_missing\": " << m_ReferenceMissingCount << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::__createSlotBuffers()
+{
+	//NOTE: cached memory makes the encoders' reads far cheaper, coherent spares the invalidation ranges
+	VkMemoryPropertyFlags Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	if (m_pAllocator->hasMemoryType(Properties | VK_MEMORY_PROPERTY_HOST_CACHED_BIT)) Properties |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+	VkDeviceSize Size = VkDeviceSize(m_Extent.width) * m_Extent.height * 4;
+	for (auto& Slot : m_Slots)
+	{
+		m_pAllocator->createBuffer(Size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Properties, Slot.Buffer, Slot.Allocation);
+		Slot.State = ESlotState::Free;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::__destroySlotBuffers()
+{
+	for (auto& Slot : m_Slots)
+	{
+		if (Slot.Buffer != VK_NULL_HANDLE) m_pAllocator->destroyBuffer(Slot.Buffer, Slot.Allocation);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::__stopEncoders()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_WorkSignal.notify_all();
+
+	for (auto& Thread : m_EncoderThreads) Thread.join();
+	m_EncoderThreads.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::__encodeLoop()
+{
+	std::vector<uint8_t> Pixels, Encoded;
+	while (true)
+	{
+		uint32_t SlotIndex = 0;
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_WorkSignal.wait(Lock, [this]() { return m_IsStopping || !m_EncodeQueue.empty(); });
+			if (m_EncodeQueue.empty()) return;
+
+			SlotIndex = m_EncodeQueue.front();
+			m_EncodeQueue.pop_front();
+			++m_BusyEncoderCount;
+		}
+
+		auto StartTime = std::chrono::steady_clock::now();
+
+		//NOTE: the slot goes back to the ring as soon as its pixels are copied out, encoding works on the private copy
+		uint64_t FrameNumber = m_Slots[SlotIndex].FrameNumber;
+		__convertToRgba(static_cast<const uint8_t*>(m_Slots[SlotIndex].Allocation.pMappedData), Pixels);
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Slots[SlotIndex].State = ESlotState::Free;
+		}
+		m_IdleSignal.notify_all();
+
+		std::string Filename = __getFilename(FrameNumber);
+		const std::vector<uint8_t>* pOutput = &Pixels;
+		if (m_FileFormat == ECaptureFileFormat::Png)
+		{
+			CImageEncoder::encodePng(Pixels.data(), m_Extent.width, m_Extent.height, Encoded);
+			pOutput = &Encoded;
+		}
+
+		bool IsWritten = __writeFile((std::filesystem::path(m_Directory) / Filename).string(), *pOutput);
+		if (!IsWritten) std::cerr << "failed to write captured frame " << Filename << std::endl;
+		double EncodeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			--m_BusyEncoderCount;
+			if (IsWritten)
+			{
+				++m_CapturedFrameCount;
+				m_WrittenBytes += pOutput->size();
+				m_TotalEncodeTime += EncodeTime;
+				m_MaxEncodeTime = std::max(m_MaxEncodeTime, EncodeTime);
+				m_WrittenFiles.push_back(Filename);
+			}
+			else
+			{
+				++m_FailedFrameCount;
+			}
+		}
+		m_IdleSignal.notify_all();
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameCapture::__convertToRgba(const uint8_t* vSource, std::vector<uint8_t>& voPixels) const
+{
+	const size_t ByteCount = size_t(m_Extent.width) * m_Extent.height * 4;
+	voPixels.assign(vSource, vSource + ByteCount);
+	if (!m_IsBgra) return;
+
+	for (size_t i = 0; i < ByteCount; i += 4) std::swap(voPixels[i], voPixels[i + 2]);
+}
+
+//******************************************************************************************
+//FUNCTION:
+std::string CFrameCapture::__getFilename(uint64_t vFrameNumber) const
+{
+	//NOTE: raw files carry their extent in the name since nothing else in them records it
+	std::ostringstream Filename;
+	Filename << "frame_" << std::setw(6) << std::setfill('0') << vFrameNumber;
+	if (m_FileFormat == ECaptureFileFormat::Raw) Filename << "_" << m_Extent.width << "x" << m_Extent.height;
+	Filename << FILE_FORMAT_EXTENSIONS[static_cast<int>(m_FileFormat)];
+	return Filename.str();
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ostream>
+#include <vulkan/vulkan.h>
+#include "GpuMemoryAllocator.h"
+
+enum class ECaptureFileFormat
+{
+	Png = 0,
+	Raw,		//tightly packed RGBA8 rows
+	Count
+};
+
+//NOTE: frames are copied into a ring of host visible buffers and only handed to the encoder threads once their fence has signaled, so capturing never makes the render loop wait on the GPU
+class CFrameCapture
+{
+public:
+	~CFrameCapture() { __stopEncoders(); }
+
+	//NOTE: in blocking mode a frame waits for an encoder to free a slot instead of being dropped, which keeps captures complete at the cost of frame rate
+	void create(VkDevice vDevice, CGpuMemoryAllocator* vAllocator, const std::string& vDirectory, ECaptureFileFormat vFileFormat, uint32_t vSlotCount, uint32_t vEncoderThreadCount, bool vIsBlocking);
+	//NOTE: like flush, the frames captured so far are still written out
+	void destroy();
+
+	bool isCreated() const { return m_VkDevice != VK_NULL_HANDLE; }
+
+	//NOTE: flushes the frames captured so far, false when images of this format cannot be written
+	bool setTarget(VkExtent2D vExtent, VkFormat vFormat);
+
+	//NOTE: the image has to be in TRANSFER_SRC_OPTIMAL, false when every slot was busy and the frame was dropped
+	bool recordReadback(VkCommandBuffer vCommandBuffer, uint32_t vFrame, VkImage vImage, uint64_t vFrameNumber);
+
+	//NOTE: called once the fence of vFrame has signaled, the copies recorded in that frame go to the encoders
+	void collect(uint32_t vFrame);
+
+	//NOTE: no recorded copy may still be executing, returns once every captured frame is on disk
+	void flush();
+
+	//NOTE: files are compared byte for byte, the encoder is deterministic so references just have to be captured by this writer too
+	bool compareWithReference(const std::string& vDirectory);
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	enum class ESlotState
+	{
+		Free = 0,
+		Copying,
+		Encoding
+	};
+
+	struct SReadbackSlot
+	{
+		VkBuffer		Buffer = VK_NULL_HANDLE;
+		SGpuAllocation	Allocation;
+		ESlotState		State = ESlotState::Free;
+		uint32_t		Frame = 0;
+		uint64_t		FrameNumber = 0;
+	};
+
+	VkDevice				m_VkDevice = VK_NULL_HANDLE;
+	CGpuMemoryAllocator*	m_pAllocator = nullptr;
+	std::string				m_Directory;
+	ECaptureFileFormat		m_FileFormat = ECaptureFileFormat::Png;
+	bool					m_IsBlocking = false;
+	VkExtent2D				m_Extent = { 0, 0 };
+	bool					m_IsBgra = false;
+
+	std::vector<SReadbackSlot>	m_Slots;
+	uint32_t					m_NextSlot = 0;
+	std::deque<uint32_t>		m_EncodeQueue;
+	uint32_t					m_BusyEncoderCount = 0;
+	std::vector<std::thread>	m_EncoderThreads;
+	mutable std::mutex			m_Mutex;
+	std::condition_variable		m_WorkSignal;
+	std::condition_variable		m_IdleSignal;
+	bool						m_IsStopping = false;
+	std::vector<std::string>	m_WrittenFiles;
+
+	uint64_t	m_CapturedFrameCount = 0;
+	uint64_t	m_DroppedFrameCount = 0;
+	uint64_t	m_FailedFrameCount = 0;
+	uint64_t	m_WrittenBytes = 0;
+	double		m_TotalEncodeTime = 0.0;
+	double		m_MaxEncodeTime = 0.0;
+	double		m_SlotWaitTime = 0.0;
+	uint32_t	m_ReferenceMatchCount = 0;
+	uint32_t	m_ReferenceMismatchCount = 0;
+	uint32_t	m_ReferenceMissingCount = 0;
+
+	void __createSlotBuffers();
+	void __destroySlotBuffers();
+	void __stopEncoders();
+	void __encodeLoop();
+	void __convertToRgba(const uint8_t* vSource, std::vector<uint8_t>& voPixels) const;
+	std::string __getFilename(uint64_t vFrameNumber) const;
+};
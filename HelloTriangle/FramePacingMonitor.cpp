@@ -0,0 +1,126 @@
+#include "FramePacingMonitor.h"
+#include "FrameStatistics.h"
+#include <algorithm>
+
+namespace
+{
+	//NOTE: an interval this many times longer than the expected one is counted as a stutter
+	const double STUTTER_THRESHOLD_FACTOR = 1.5;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFramePacingMonitor::create(VkDevice vDevice, bool vUseDisplayTiming)
+{
+	m_VkDevice = vDevice;
+
+	if (vUseDisplayTiming)
+	{
+		m_pfnGetPastPresentationTiming = reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(vkGetDeviceProcAddr(m_VkDevice, "vkGetPastPresentationTimingGOOGLE"));
+		m_pfnGetRefreshCycleDuration = reinterpret_cast<PFN_vkGetRefreshCycleDurationGOOGLE>(vkGetDeviceProcAddr(m_VkDevice, "vkGetRefreshCycleDurationGOOGLE"));
+		if (!m_pfnGetPastPresentationTiming || !m_pfnGetRefreshCycleDuration)
+		{
+			m_pfnGetPastPresentationTiming = nullptr;
+			m_pfnGetRefreshCycleDuration = nullptr;
+		}
+	}
+
+	m_PresentTimesInfo.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+	m_PresentTimesInfo.swapchainCount = 1;
+	m_PresentTimesInfo.pTimes = &m_PresentTime;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFramePacingMonitor::setSwapChain(VkSwapchainKHR vSwapChain)
+{
+	//NOTE: timings of the old swap chain are gone with it, so the next interval must not span the rebuild
+	m_VkSwapChain = vSwapChain;
+	m_HasLastPresent = false;
+	m_RefreshDuration = 0.0;
+
+	if (isUsingDisplayTiming())
+	{
+		VkRefreshCycleDurationGOOGLE RefreshCycle = {};
+		if (m_pfnGetRefreshCycleDuration(m_VkDevice, m_VkSwapChain, &RefreshCycle) == VK_SUCCESS)
+			m_RefreshDuration = RefreshCycle.refreshDuration / 1.0e6;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFramePacingMonitor::reset()
+{
+	m_PresentIntervals.clear();
+	m_HasLastPresent = false;
+}
+
+//******************************************************************************************
+//FUNCTION:
+const void* CFramePacingMonitor::preparePresent()
+{
+	if (!isUsingDisplayTiming()) return nullptr;
+
+	//NOTE: a desired time of zero asks for no scheduling, the id is only there to match the timing reported later
+	m_PresentTime.presentID = m_NextPresentID++;
+	m_PresentTime.desiredPresentTime = 0;
+
+	return &m_PresentTimesInfo;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFramePacingMonitor::onPresented()
+{
+	if (!isUsingDisplayTiming())
+	{
+		auto Now = std::chrono::steady_clock::now();
+		if (m_HasLastPresent) __recordPresent(std::chrono::duration<double, std::milli>(Now - m_LastCpuPresentTime).count());
+
+		m_LastCpuPresentTime = Now;
+		m_HasLastPresent = true;
+		return;
+	}
+
+	uint32_t TimingCount = 0;
+	if (m_pfnGetPastPresentationTiming(m_VkDevice, m_VkSwapChain, &TimingCount, nullptr) != VK_SUCCESS || 0 == TimingCount) return;
+
+	std::vector<VkPastPresentationTimingGOOGLE> Timings(TimingCount);
+	if (m_pfnGetPastPresentationTiming(m_VkDevice, m_VkSwapChain, &TimingCount, Timings.data()) < VK_SUCCESS) return;
+	Timings.resize(TimingCount);
+
+	std::sort(Timings.begin(), Timings.end(), [](const VkPastPresentationTimingGOOGLE& vLhs, const VkPastPresentationTimingGOOGLE& vRhs) { return vLhs.presentID < vRhs.presentID; });
+
+	for (const auto& Timing : Timings)
+	{
+		if (m_HasLastPresent && Timing.actualPresentTime > m_LastActualPresentTime)
+			__recordPresent((Timing.actualPresentTime - m_LastActualPresentTime) / 1.0e6);
+
+		m_LastActualPresentTime = Timing.actualPresentTime;
+		m_HasLastPresent = true;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFramePacingMonitor::dumpJson(std::ostream& vOutput) const
+{
+	SStatisticSummary Intervals = CFrameStatistics::computeSummary(m_PresentIntervals);
+
+	//NOTE: without a known refresh cycle the median interval stands in for the expected one
+	double ExpectedInterval = m_RefreshDuration > 0.0 ? m_RefreshDuration : Intervals.P50;
+	double StutterThreshold = ExpectedInterval * STUTTER_THRESHOLD_FACTOR;
+	size_t StutterCount = std::count_if(m_PresentIntervals.begin(), m_PresentIntervals.end(), [&](double vInterval) { return vInterval > StutterThreshold; });
+
+	vOutput << "{ \"source\": \"" << (isUsingDisplayTiming() ? "display_timing" : "cpu") << "\", \"refresh_ms\": " << m_RefreshDuration
+		<< ", \"presents\": " << m_PresentIntervals.size() << ", \"stutter_threshold_ms\": " << StutterThreshold << ", \"stutters\": " << StutterCount << ", \"interval_ms\": ";
+	CFrameStatistics::dumpSummaryJson(vOutput, Intervals);
+	vOutput << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFramePacingMonitor::__recordPresent(double vIntervalMilliseconds)
+{
+	m_PresentIntervals.push_back(vIntervalMilliseconds);
+}
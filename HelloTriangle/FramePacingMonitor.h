@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+class CFramePacingMonitor
+{
+public:
+	void create(VkDevice vDevice, bool vUseDisplayTiming);
+	void setSwapChain(VkSwapchainKHR vSwapChain);
+	void reset();
+
+	bool isUsingDisplayTiming() const { return m_pfnGetPastPresentationTiming != nullptr; }
+
+	//NOTE: returns the pNext chain to put into VkPresentInfoKHR, nullptr when display timing is unavailable
+	const void* preparePresent();
+	void onPresented();
+
+	void dumpJson(std::ostream& vOutput) const;
+
+private:
+	VkDevice		m_VkDevice = VK_NULL_HANDLE;
+	VkSwapchainKHR	m_VkSwapChain = VK_NULL_HANDLE;
+
+	PFN_vkGetPastPresentationTimingGOOGLE	m_pfnGetPastPresentationTiming = nullptr;
+	PFN_vkGetRefreshCycleDurationGOOGLE		m_pfnGetRefreshCycleDuration = nullptr;
+
+	VkPresentTimeGOOGLE			m_PresentTime = {};
+	VkPresentTimesInfoGOOGLE	m_PresentTimesInfo = {};
+	uint32_t					m_NextPresentID = 1;
+	double						m_RefreshDuration = 0.0;
+
+	std::chrono::steady_clock::time_point	m_LastCpuPresentTime;
+	uint64_t								m_LastActualPresentTime = 0;
+	bool									m_HasLastPresent = false;
+	std::vector<double>						m_PresentIntervals;
+
+	void __recordPresent(double vIntervalMilliseconds);
+};
@@ -0,0 +1,250 @@
+#include "FrameStatistics.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace
+{
+	const char* PHASE_NAMES[] = { "fence_wait", "acquire", "record", "submit", "present" };
+	static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<size_t>(EFramePhase::Count), "every frame phase needs a name");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::reset()
+{
+	for (auto& Samples : m_PhaseTimes) Samples.clear();
+	m_FrameTimes.clear();
+	m_InputLatencies.clear();
+	m_GpuScopeTimes.clear();
+	m_EventTimes.clear();
+	m_CounterValues.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::setMetadata(const std::string& vKey, const std::string& vValue)
+{
+	setMetadataJson(vKey, escapeJson(vValue));
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::setMetadataJson(const std::string& vKey, const std::string& vJsonValue)
+{
+	for (auto& Entry : m_Metadata)
+	{
+		if (Entry.first == vKey) { Entry.second = vJsonValue; return; }
+	}
+
+	m_Metadata.emplace_back(vKey, vJsonValue);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::beginFrame()
+{
+	m_FrameStart = Clock::now();
+	m_PhaseStart = m_FrameStart;
+	m_CurrentPhaseTimes.fill(0.0);
+
+	if (m_FrameTimes.empty()) m_FirstFrameStart = m_FrameStart;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::endPhase(EFramePhase vPhase)
+{
+	auto Now = Clock::now();
+	m_CurrentPhaseTimes[static_cast<size_t>(vPhase)] += __toMilliseconds(Now - m_PhaseStart);
+	m_PhaseStart = Now;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::endFrame()
+{
+	m_LastFrameEnd = Clock::now();
+	m_FrameTimes.push_back(__toMilliseconds(m_LastFrameEnd - m_FrameStart));
+
+	for (size_t i = 0; i < m_PhaseTimes.size(); ++i)
+		m_PhaseTimes[i].push_back(m_CurrentPhaseTimes[i]);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::recordGpuScope(const std::string& vName, double vMilliseconds)
+{
+	__recordNamedSample(m_GpuScopeTimes, vName, vMilliseconds);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::recordEvent(const std::string& vName, double vMilliseconds)
+{
+	__recordNamedSample(m_EventTimes, vName, vMilliseconds);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::recordCounter(const std::string& vName, double vValue)
+{
+	__recordNamedSample(m_CounterValues, vName, vValue);
+}
+
+//******************************************************************************************
+//FUNCTION:
+SStatisticSummary CFrameStatistics::computeSummary(std::vector<double> vSamples)
+{
+	SStatisticSummary Summary;
+	if (vSamples.empty()) return Summary;
+
+	std::sort(vSamples.begin(), vSamples.end());
+
+	auto percentile = [&](double vPercent)
+	{
+		size_t Rank = static_cast<size_t>(std::ceil(vPercent / 100.0 * vSamples.size()));
+		return vSamples[std::min(std::max<size_t>(Rank, 1), vSamples.size()) - 1];
+	};
+
+	Summary.Min = vSamples.front();
+	Summary.Max = vSamples.back();
+	Summary.Mean = std::accumulate(vSamples.begin(), vSamples.end(), 0.0) / vSamples.size();
+	Summary.P50 = percentile(50.0);
+	Summary.P95 = percentile(95.0);
+	Summary.P99 = percentile(99.0);
+
+	return Summary;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::dumpJson(std::ostream& vOutput) const
+{
+	double TotalSeconds = m_FrameTimes.empty() ? 0.0 : __toMilliseconds(m_LastFrameEnd - m_FirstFrameStart) / 1000.0;
+	double FramesPerSecond = TotalSeconds > 0.0 ? m_FrameTimes.size() / TotalSeconds : 0.0;
+
+	vOutput << "{\n";
+	for (const auto& Entry : m_Metadata)
+		vOutput << "  " << escapeJson(Entry.first) << ": " << Entry.second << ",\n";
+
+	vOutput << "  \"frames\": " << m_FrameTimes.size() << ",\n";
+	vOutput << "  \"total_seconds\": " << TotalSeconds << ",\n";
+	vOutput << "  \"fps\": " << FramesPerSecond << ",\n";
+	vOutput << "  \"frame_ms\": ";
+	dumpSummaryJson(vOutput, computeSummary(m_FrameTimes));
+	vOutput << ",\n  \"input_to_gpu_complete_ms\": ";
+	dumpSummaryJson(vOutput, computeSummary(m_InputLatencies));
+	vOutput << ",\n  \"phase_ms\": {\n";
+
+	for (size_t i = 0; i < m_PhaseTimes.size(); ++i)
+	{
+		vOutput << "    \"" << PHASE_NAMES[i] << "\": ";
+		dumpSummaryJson(vOutput, computeSummary(m_PhaseTimes[i]));
+		vOutput << (i + 1 < m_PhaseTimes.size() ? ",\n" : "\n");
+	}
+
+	vOutput << "  },\n  \"gpu_ms\": ";
+	__dumpNamedSamples(vOutput, m_GpuScopeTimes);
+	vOutput << ",\n  \"event_ms\": ";
+	__dumpNamedSamples(vOutput, m_EventTimes);
+	vOutput << ",\n  \"counters\": ";
+	__dumpNamedSamples(vOutput, m_CounterValues);
+	vOutput << "\n}\n";
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CFrameStatistics::getGpuScopeSummary(const std::string& vName, SStatisticSummary& voSummary) const
+{
+	return __findNamedSummary(m_GpuScopeTimes, vName, voSummary);
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CFrameStatistics::getCounterSummary(const std::string& vName, SStatisticSummary& voSummary) const
+{
+	return __findNamedSummary(m_CounterValues, vName, voSummary);
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CFrameStatistics::__findNamedSummary(const std::vector<std::pair<std::string, std::vector<double>>>& vSamples, const std::string& vName, SStatisticSummary& voSummary)
+{
+	for (const auto& Entry : vSamples)
+	{
+		if (Entry.first == vName) { voSummary = computeSummary(Entry.second); return true; }
+	}
+
+	return false;
+}
+
+//******************************************************************************************
+//FUNCTION:
+double CFrameStatistics::__toMilliseconds(Clock::duration vDuration)
+{
+	return std::chrono::duration<double, std::milli>(vDuration).count();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::dumpSummaryJson(std::ostream& vOutput, const SStatisticSummary& vSummary)
+{
+	vOutput << "{ \"min\": " << vSummary.Min << ", \"mean\": " << vSummary.Mean << ", \"p50\": " << vSummary.P50
+		<< ", \"p95\": " << vSummary.P95 << ", \"p99\": " << vSummary.P99 << ", \"max\": " << vSummary.Max << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+std::string CFrameStatistics::escapeJson(const std::string& vValue)
+{
+	static const char HexDigits[] = "0123456789abcdef";
+
+	std::string Result = "\"";
+	for (char Character : vValue)
+	{
+		unsigned char Code = static_cast<unsigned char>(Character);
+		if (Character == '"' || Character == '\\')
+		{
+			Result += '\\';
+			Result += Character;
+		}
+		else if (Code < 0x20)
+		{
+			Result += "\\u00";
+			Result += HexDigits[Code >> 4];
+			Result += HexDigits[Code & 0xF];
+		}
+		else
+		{
+			Result += Character;
+		}
+	}
+	Result += '"';
+	return Result;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::__recordNamedSample(std::vector<std::pair<std::string, std::vector<double>>>& vioSamples, const std::string& vName, double vValue)
+{
+	for (auto& Entry : vioSamples)
+	{
+		if (Entry.first == vName) { Entry.second.push_back(vValue); return; }
+	}
+
+	vioSamples.emplace_back(vName, std::vector<double>{ vValue });
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameStatistics::__dumpNamedSamples(std::ostream& vOutput, const std::vector<std::pair<std::string, std::vector<double>>>& vSamples)
+{
+	vOutput << "{";
+	for (size_t i = 0; i < vSamples.size(); ++i)
+	{
+		vOutput << (i > 0 ? ",\n    " : "\n    ") << escapeJson(vSamples[i].first) << ": ";
+		dumpSummaryJson(vOutput, computeSummary(vSamples[i].second));
+	}
+	vOutput << (vSamples.empty() ? "}" : "\n  }");
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <utility>
+
+enum class EFramePhase
+{
+	FenceWait = 0,
+	Acquire,
+	Record,
+	Submit,
+	Present,
+	Count
+};
+
+struct SStatisticSummary
+{
+	double Min = 0.0;
+	double Mean = 0.0;
+	double P50 = 0.0;
+	double P95 = 0.0;
+	double P99 = 0.0;
+	double Max = 0.0;
+};
+
+class CFrameStatistics
+{
+public:
+	void reset();
+	void setMetadata(const std::string& vKey, const std::string& vValue);
+	void setMetadataJson(const std::string& vKey, const std::string& vJsonValue);
+
+	void beginFrame();
+	void endPhase(EFramePhase vPhase);
+	void endFrame();
+
+	void recordGpuScope(const std::string& vName, double vMilliseconds);
+	void recordEvent(const std::string& vName, double vMilliseconds);
+	void recordCounter(const std::string& vName, double vValue);
+	void recordInputLatency(double vMilliseconds) { m_InputLatencies.push_back(vMilliseconds); }		//from polling input until the GPU finished the frame
+
+	size_t getFrameCount() const { return m_FrameTimes.size(); }
+	SStatisticSummary getFrameTimeSummary() const { return computeSummary(m_FrameTimes); }
+	SStatisticSummary getPhaseSummary(EFramePhase vPhase) const { return computeSummary(m_PhaseTimes[static_cast<size_t>(vPhase)]); }
+	bool getGpuScopeSummary(const std::string& vName, SStatisticSummary& voSummary) const;
+	bool getCounterSummary(const std::string& vName, SStatisticSummary& voSummary) const;
+
+	void dumpJson(std::ostream& vOutput) const;
+
+	static SStatisticSummary computeSummary(std::vector<double> vSamples);
+	static void dumpSummaryJson(std::ostream& vOutput, const SStatisticSummary& vSummary);
+
+	//NOTE: quotes and escapes a string value, device names and paths are not guaranteed to be plain text
+	static std::string escapeJson(const std::string& vValue);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point m_FrameStart;
+	Clock::time_point m_PhaseStart;
+	Clock::time_point m_FirstFrameStart;
+	Clock::time_point m_LastFrameEnd;
+
+	std::array<double, static_cast<size_t>(EFramePhase::Count)> m_CurrentPhaseTimes = {};
+	std::array<std::vector<double>, static_cast<size_t>(EFramePhase::Count)> m_PhaseTimes;
+	std::vector<double> m_FrameTimes;
+	std::vector<double> m_InputLatencies;
+	std::vector<std::pair<std::string, std::vector<double>>> m_GpuScopeTimes;
+	std::vector<std::pair<std::string, std::vector<double>>> m_EventTimes;
+	std::vector<std::pair<std::string, std::vector<double>>> m_CounterValues;
+	std::vector<std::pair<std::string, std::string>> m_Metadata;
+
+	static double __toMilliseconds(Clock::duration vDuration);
+	static bool __findNamedSummary(const std::vector<std::pair<std::string, std::vector<double>>>& vSamples, const std::string& vName, SStatisticSummary& voSummary);
+	static void __recordNamedSample(std::vector<std::pair<std::string, std::vector<double>>>& vioSamples, const std::string& vName, double vValue);
+	static void __dumpNamedSamples(std::ostream& vOutput, const std::vector<std::pair<std::string, std::vector<double>>>& vSamples);
+};
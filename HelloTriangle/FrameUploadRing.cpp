@@ -0,0 +1,68 @@
+#include "FrameUploadRing.h"
+#include <stdexcept>
+#include <algorithm>
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameUploadRing::create(VkPhysicalDevice vPhysicalDevice, CGpuMemoryAllocator* vAllocator, uint32_t vFrameCount, VkDeviceSize vBytesPerFrame)
+{
+	m_pAllocator = vAllocator;
+
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(vPhysicalDevice, &Properties);
+	m_Alignment = std::max<VkDeviceSize>(Properties.limits.minUniformBufferOffsetAlignment, 1);
+	m_BytesPerFrame = (vBytesPerFrame + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+	//NOTE: host-visible video memory lets the gpu read the data in place; without it the data stays in system memory and is read over the bus
+	const VkMemoryPropertyFlags DeviceLocalProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	m_IsDeviceLocal = m_pAllocator->hasMemoryType(DeviceLocalProperties);
+	VkMemoryPropertyFlags MemoryProperties = m_IsDeviceLocal ? DeviceLocalProperties : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	m_pAllocator->createBuffer(m_BytesPerFrame * vFrameCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, MemoryProperties, m_VkBuffer, m_Allocation);
+	if (!m_Allocation.pMappedData)
+		throw std::runtime_error("failed to map frame upload ring!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameUploadRing::destroy()
+{
+	if (m_VkBuffer != VK_NULL_HANDLE) m_pAllocator->destroyBuffer(m_VkBuffer, m_Allocation);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameUploadRing::beginFrame(uint32_t vFrame)
+{
+	if (m_FrameCount > 0) m_PeakBytesPerFrame = std::max(m_PeakBytesPerFrame, m_FrameHead);
+
+	m_CurrentFrame = vFrame;
+	m_FrameHead = 0;
+	++m_FrameCount;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void* CFrameUploadRing::allocate(VkDeviceSize vSize, uint32_t& voOffset)
+{
+	VkDeviceSize AlignedSize = (vSize + m_Alignment - 1) / m_Alignment * m_Alignment;
+	if (m_FrameHead + AlignedSize > m_BytesPerFrame)
+		throw std::runtime_error("frame upload ring is full!");
+
+	VkDeviceSize Offset = m_CurrentFrame * m_BytesPerFrame + m_FrameHead;
+	m_FrameHead += AlignedSize;
+	m_TotalBytesWritten += vSize;
+
+	voOffset = static_cast<uint32_t>(Offset);
+	return static_cast<char*>(m_Allocation.pMappedData) + Offset;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CFrameUploadRing::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	VkDeviceSize PeakBytes = std::max(m_PeakBytesPerFrame, m_FrameHead);
+
+	vOutput << "{ \"device_local\": " << (m_IsDeviceLocal ? "true" : "false") << ", \"bytes_per_frame_capacity\": " << m_BytesPerFrame
+		<< ", \"peak_bytes_per_frame\": " << PeakBytes << ", \"mean_bytes_per_frame\": " << (m_FrameCount > 0 ? static_cast<double>(m_TotalBytesWritten) / m_FrameCount : 0.0) << " }";
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <ostream>
+#include <vulkan/vulkan.h>
+#include "GpuMemoryAllocator.h"
+
+class CFrameUploadRing
+{
+public:
+	void create(VkPhysicalDevice vPhysicalDevice, CGpuMemoryAllocator* vAllocator, uint32_t vFrameCount, VkDeviceSize vBytesPerFrame);
+	void destroy();
+
+	//NOTE: must only be called once the frame's fence has signaled, its whole region is reused from the start
+	void beginFrame(uint32_t vFrame);
+
+	//NOTE: returns a pointer into the mapped buffer and the offset to pass as dynamic offset, valid until the frame's region is reused
+	void* allocate(VkDeviceSize vSize, uint32_t& voOffset);
+
+	template<typename T>
+	uint32_t push(const T& vData)
+	{
+		uint32_t Offset = 0;
+		*static_cast<T*>(allocate(sizeof(T), Offset)) = vData;
+		return Offset;
+	}
+
+	VkBuffer		getBuffer() const { return m_VkBuffer; }
+	VkDeviceSize	getBytesPerFrame() const { return m_BytesPerFrame; }
+	bool			isDeviceLocal() const { return m_IsDeviceLocal; }
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	CGpuMemoryAllocator*	m_pAllocator = nullptr;
+	VkBuffer				m_VkBuffer = VK_NULL_HANDLE;
+	SGpuAllocation			m_Allocation;
+	VkDeviceSize			m_BytesPerFrame = 0;
+	VkDeviceSize			m_Alignment = 1;
+	bool					m_IsDeviceLocal = false;
+
+	uint32_t				m_CurrentFrame = 0;
+	VkDeviceSize			m_FrameHead = 0;
+
+	uint64_t				m_FrameCount = 0;
+	uint64_t				m_TotalBytesWritten = 0;
+	VkDeviceSize			m_PeakBytesPerFrame = 0;
+};
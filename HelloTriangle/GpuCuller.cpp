@@ -0,0 +1,213 @@
+#include "GpuCuller.h"
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+	const uint32_t CULL_WORKGROUP_SIZE = 64;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuCuller::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, CGpuMemoryAllocator* vAllocator, CDescriptorLayoutCache* vLayoutCache, VkPipelineCache vPipelineCache, const CAsset& vShaderCode, uint32_t vFrameCount, bool vUseDrawIndirectCount)
+{
+	m_VkDevice = vDevice;
+	m_pAllocator = vAllocator;
+	m_UseDrawIndirectCount = vUseDrawIndirectCount;
+	m_FrameResources.resize(vFrameCount);
+
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(vPhysicalDevice, &Properties);
+	m_MaxObjectCount = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(Properties.limits.maxComputeWorkGroupCount[0]) * CULL_WORKGROUP_SIZE, Properties.limits.maxDrawIndirectCount));
+
+	if (m_UseDrawIndirectCount)
+	{
+		m_pfnCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(m_VkDevice, "vkCmdDrawIndexedIndirectCountKHR"));
+		m_UseDrawIndirectCount = m_pfnCmdDrawIndexedIndirectCount != nullptr;
+	}
+
+	std::vector<VkDescriptorSetLayoutBinding> Bindings(3);
+	for (uint32_t i = 0; i < Bindings.size(); ++i)
+	{
+		Bindings[i].binding = i;
+		Bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		Bindings[i].descriptorCount = 1;
+		Bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	m_VkDescriptorSetLayout = vLayoutCache->getLayout(Bindings);
+
+	VkDescriptorPoolSize PoolSize = {};
+	PoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	PoolSize.descriptorCount = static_cast<uint32_t>(Bindings.size()) * vFrameCount;
+
+	VkDescriptorPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	PoolInfo.maxSets = vFrameCount;
+	PoolInfo.poolSizeCount = 1;
+	PoolInfo.pPoolSizes = &PoolSize;
+
+	if (vkCreateDescriptorPool(m_VkDevice, &PoolInfo, nullptr, &m_VkDescriptorPool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create culling descriptor pool!");
+
+	std::vector<VkDescriptorSetLayout> SetLayouts(vFrameCount, m_VkDescriptorSetLayout);
+	std::vector<VkDescriptorSet> DescriptorSets(vFrameCount);
+
+	VkDescriptorSetAllocateInfo AllocInfo = {};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	AllocInfo.descriptorPool = m_VkDescriptorPool;
+	AllocInfo.descriptorSetCount = vFrameCount;
+	AllocInfo.pSetLayouts = SetLayouts.data();
+
+	if (vkAllocateDescriptorSets(m_VkDevice, &AllocInfo, DescriptorSets.data()) != VK_SUCCESS)
+		throw std::runtime_error("failed to allocate culling descriptor sets!");
+
+	for (uint32_t i = 0; i < vFrameCount; ++i) m_FrameResources[i].DescriptorSet = DescriptorSets[i];
+
+	VkPushConstantRange PushConstantRange = {};
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(SCullParameters);
+
+	VkPipelineLayoutCreateInfo PipelineLayoutInfo = {};
+	PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	PipelineLayoutInfo.setLayoutCount = 1;
+	PipelineLayoutInfo.pSetLayouts = &m_VkDescriptorSetLayout;
+	PipelineLayoutInfo.pushConstantRangeCount = 1;
+	PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
+
+	if (vkCreatePipelineLayout(m_VkDevice, &PipelineLayoutInfo, nullptr, &m_VkPipelineLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create culling pipeline layout!");
+
+	VkShaderModuleCreateInfo ShaderModuleInfo = {};
+	ShaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	ShaderModuleInfo.codeSize = vShaderCode.getSize();
+	ShaderModuleInfo.pCode = reinterpret_cast<const uint32_t*>(vShaderCode.getData());
+
+	VkShaderModule ShaderModule;
+	if (vkCreateShaderModule(m_VkDevice, &ShaderModuleInfo, nullptr, &ShaderModule) != VK_SUCCESS)
+		throw std::runtime_error("failed to create shader module!");
+
+	VkComputePipelineCreateInfo PipelineInfo = {};
+	PipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	PipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	PipelineInfo.stage.module = ShaderModule;
+	PipelineInfo.stage.pName = "main";
+	PipelineInfo.layout = m_VkPipelineLayout;
+
+	VkResult Result = vkCreateComputePipelines(m_VkDevice, vPipelineCache, 1, &PipelineInfo, nullptr, &m_VkPipeline);
+	vkDestroyShaderModule(m_VkDevice, ShaderModule, nullptr);
+
+	if (Result != VK_SUCCESS)
+		throw std::runtime_error("failed to create culling pipeline!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuCuller::destroy()
+{
+	if (m_VkDevice == VK_NULL_HANDLE) return;
+
+	__destroyFrameBuffers();
+	m_FrameResources.clear();
+
+	vkDestroyPipeline(m_VkDevice, m_VkPipeline, nullptr);
+	vkDestroyPipelineLayout(m_VkDevice, m_VkPipelineLayout, nullptr);
+	vkDestroyDescriptorPool(m_VkDevice, m_VkDescriptorPool, nullptr);
+
+	m_VkPipeline = VK_NULL_HANDLE;
+	m_VkPipelineLayout = VK_NULL_HANDLE;
+	m_VkDescriptorPool = VK_NULL_HANDLE;
+	m_VkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_VkDevice = VK_NULL_HANDLE;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuCuller::setObjects(VkBuffer vBoundsBuffer, uint32_t vObjectCount)
+{
+	//NOTE: the caller must make sure no submitted frame still reads the previous draw commands
+	if (vObjectCount > m_MaxObjectCount)
+		throw std::runtime_error("too many objects for gpu culling!");
+
+	__destroyFrameBuffers();
+	m_ObjectCount = vObjectCount;
+
+	//NOTE: every frame in flight gets its own command and count buffers, so culling the next frame never races the draws of the previous one
+	for (auto& Frame : m_FrameResources)
+	{
+		m_pAllocator->createBuffer(sizeof(VkDrawIndexedIndirectCommand) * std::max(m_ObjectCount, 1u), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Frame.CommandBuffer, Frame.CommandAllocation);
+		m_pAllocator->createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Frame.CountBuffer, Frame.CountAllocation);
+
+		std::array<VkDescriptorBufferInfo, 3> BufferInfos = {};
+		BufferInfos[0] = { vBoundsBuffer, 0, VK_WHOLE_SIZE };
+		BufferInfos[1] = { Frame.CommandBuffer, 0, VK_WHOLE_SIZE };
+		BufferInfos[2] = { Frame.CountBuffer, 0, VK_WHOLE_SIZE };
+
+		std::array<VkWriteDescriptorSet, 3> Writes = {};
+		for (uint32_t i = 0; i < Writes.size(); ++i)
+		{
+			Writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			Writes[i].dstSet = Frame.DescriptorSet;
+			Writes[i].dstBinding = i;
+			Writes[i].descriptorCount = 1;
+			Writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			Writes[i].pBufferInfo = &BufferInfos[i];
+		}
+
+		vkUpdateDescriptorSets(m_VkDevice, static_cast<uint32_t>(Writes.size()), Writes.data(), 0, nullptr);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuCuller::recordCulling(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vIndexCount) const
+{
+	const SFrameResources& Frame = m_FrameResources[vFrame];
+
+	//NOTE: without a draw count every command slot is consumed, so slots of culled objects must hold zero-sized draws
+	vkCmdFillBuffer(vCommandBuffer, Frame.CountBuffer, 0, sizeof(uint32_t), 0);
+	if (!m_UseDrawIndirectCount) vkCmdFillBuffer(vCommandBuffer, Frame.CommandBuffer, 0, VK_WHOLE_SIZE, 0);
+
+	VkMemoryBarrier ClearBarrier = {};
+	ClearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	ClearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	ClearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &ClearBarrier, 0, nullptr, 0, nullptr);
+
+	SCullParameters Parameters = { m_ObjectCount, vIndexCount };
+	vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_VkPipeline);
+	vkCmdBindDescriptorSets(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_VkPipelineLayout, 0, 1, &Frame.DescriptorSet, 0, nullptr);
+	vkCmdPushConstants(vCommandBuffer, m_VkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Parameters), &Parameters);
+	vkCmdDispatch(vCommandBuffer, (m_ObjectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuCuller::recordDraw(VkCommandBuffer vCommandBuffer, uint32_t vFrame) const
+{
+	if (0 == m_ObjectCount) return;
+
+	const SFrameResources& Frame = m_FrameResources[vFrame];
+
+	if (m_UseDrawIndirectCount)
+		m_pfnCmdDrawIndexedIndirectCount(vCommandBuffer, Frame.CommandBuffer, 0, Frame.CountBuffer, 0, m_ObjectCount, sizeof(VkDrawIndexedIndirectCommand));
+	else
+		vkCmdDrawIndexedIndirect(vCommandBuffer, Frame.CommandBuffer, 0, m_ObjectCount, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuCuller::__destroyFrameBuffers()
+{
+	for (auto& Frame : m_FrameResources)
+	{
+		if (Frame.CommandBuffer != VK_NULL_HANDLE) m_pAllocator->destroyBuffer(Frame.CommandBuffer, Frame.CommandAllocation);
+		if (Frame.CountBuffer != VK_NULL_HANDLE) m_pAllocator->destroyBuffer(Frame.CountBuffer, Frame.CountAllocation);
+	}
+	m_ObjectCount = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan.h>
+#include "GpuMemoryAllocator.h"
+#include "DescriptorLayoutCache.h"
+#include "AssetLoader.h"
+
+class CGpuCuller
+{
+public:
+	void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, CGpuMemoryAllocator* vAllocator, CDescriptorLayoutCache* vLayoutCache, VkPipelineCache vPipelineCache, const CAsset& vShaderCode, uint32_t vFrameCount, bool vUseDrawIndirectCount);
+	void destroy();
+
+	void setObjects(VkBuffer vBoundsBuffer, uint32_t vObjectCount);
+
+	//NOTE: the caller orders the culling writes before the indirect reads of the draw, the per-frame buffers are the ones to synchronize
+	void recordCulling(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vIndexCount) const;
+	void recordDraw(VkCommandBuffer vCommandBuffer, uint32_t vFrame) const;
+
+	VkBuffer getIndirectBuffer(uint32_t vFrame) const { return m_FrameResources[vFrame].CommandBuffer; }
+	VkBuffer getCountBuffer(uint32_t vFrame) const { return m_FrameResources[vFrame].CountBuffer; }
+
+	bool isCreated() const { return m_VkPipeline != VK_NULL_HANDLE; }
+	bool isUsingDrawIndirectCount() const { return m_UseDrawIndirectCount; }
+	uint32_t getMaxObjectCount() const { return m_MaxObjectCount; }
+
+private:
+	struct SFrameResources
+	{
+		VkBuffer		CommandBuffer = VK_NULL_HANDLE;
+		SGpuAllocation	CommandAllocation;
+		VkBuffer		CountBuffer = VK_NULL_HANDLE;
+		SGpuAllocation	CountAllocation;
+		VkDescriptorSet	DescriptorSet = VK_NULL_HANDLE;
+	};
+
+	struct SCullParameters
+	{
+		uint32_t ObjectCount;
+		uint32_t IndexCount;
+	};
+
+	VkDevice				m_VkDevice = VK_NULL_HANDLE;
+	CGpuMemoryAllocator*	m_pAllocator = nullptr;
+	VkDescriptorSetLayout	m_VkDescriptorSetLayout = VK_NULL_HANDLE;	//owned by the layout cache
+	VkDescriptorPool		m_VkDescriptorPool = VK_NULL_HANDLE;
+	VkPipelineLayout		m_VkPipelineLayout = VK_NULL_HANDLE;
+	VkPipeline				m_VkPipeline = VK_NULL_HANDLE;
+
+	PFN_vkCmdDrawIndexedIndirectCountKHR m_pfnCmdDrawIndexedIndirectCount = nullptr;
+
+	std::vector<SFrameResources> m_FrameResources;
+	uint32_t	m_ObjectCount = 0;
+	uint32_t	m_MaxObjectCount = 0;
+	bool		m_UseDrawIndirectCount = false;
+
+	void __destroyFrameBuffers();
+};
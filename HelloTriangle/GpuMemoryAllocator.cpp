@@ -0,0 +1,409 @@
+#include "GpuMemoryAllocator.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	VkDeviceSize alignUp(VkDeviceSize vValue, VkDeviceSize vAlignment)
+	{
+		return (vValue + vAlignment - 1) / vAlignment * vAlignment;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+CGpuMemoryBlock::CGpuMemoryBlock(VkDeviceMemory vMemory, VkDeviceSize vSize, uint32_t vMemoryTypeIndex, EAllocationStrategy vStrategy, VkDeviceSize vGranularity, void* vMappedData)
+	: m_VkMemory(vMemory), m_Size(vSize), m_MemoryTypeIndex(vMemoryTypeIndex), m_Strategy(vStrategy), m_Granularity(std::max<VkDeviceSize>(vGranularity, 1)), m_pMappedData(vMappedData)
+{
+	m_Ranges.push_back({ 0, vSize, true, EGpuResourceKind::Linear });
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CGpuMemoryBlock::allocate(VkDeviceSize vSize, VkDeviceSize vAlignment, EGpuResourceKind vKind, VkDeviceSize& voOffset)
+{
+	vAlignment = std::max<VkDeviceSize>(vAlignment, 1);
+
+	bool Succeeded = (m_Strategy == EAllocationStrategy::Linear) ? __allocateLinear(vSize, vAlignment, vKind, voOffset) : __allocateFromFreeList(vSize, vAlignment, vKind, voOffset);
+	if (!Succeeded) return false;
+
+	m_UsedBytes += vSize;
+	m_AllocationCount++;
+
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryBlock::free(VkDeviceSize vOffset)
+{
+	if (m_Strategy == EAllocationStrategy::Linear)
+	{
+		//NOTE: a linear block only reclaims its space once every allocation in it is gone
+		if (--m_AllocationCount == 0)
+		{
+			m_LinearHead = 0;
+			m_UsedBytes = 0;
+		}
+		return;
+	}
+
+	auto Iter = std::find_if(m_Ranges.begin(), m_Ranges.end(), [&](const SRange& vRange) { return !vRange.IsFree && vRange.Offset == vOffset; });
+	if (Iter == m_Ranges.end())
+		throw std::runtime_error("freeing an offset that was never allocated from this block!");
+
+	m_UsedBytes -= Iter->Size;
+	m_AllocationCount--;
+	Iter->IsFree = true;
+
+	auto Next = std::next(Iter);
+	if (Next != m_Ranges.end() && Next->IsFree)
+	{
+		Iter->Size += Next->Size;
+		m_Ranges.erase(Next);
+	}
+
+	if (Iter != m_Ranges.begin())
+	{
+		auto Prev = std::prev(Iter);
+		if (Prev->IsFree)
+		{
+			Prev->Size += Iter->Size;
+			m_Ranges.erase(Iter);
+		}
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkDeviceSize CGpuMemoryBlock::getLargestFreeRange() const
+{
+	if (m_Strategy == EAllocationStrategy::Linear) return m_Size - m_LinearHead;
+
+	VkDeviceSize Largest = 0;
+	for (const auto& Range : m_Ranges)
+		if (Range.IsFree) Largest = std::max(Largest, Range.Size);
+
+	return Largest;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CGpuMemoryBlock::__allocateFromFreeList(VkDeviceSize vSize, VkDeviceSize vAlignment, EGpuResourceKind vKind, VkDeviceSize& voOffset)
+{
+	auto BestFit = m_Ranges.end();
+	VkDeviceSize BestOffset = 0;
+
+	for (auto Iter = m_Ranges.begin(); Iter != m_Ranges.end(); ++Iter)
+	{
+		if (!Iter->IsFree || Iter->Size < vSize) continue;
+
+		VkDeviceSize Offset = alignUp(Iter->Offset, vAlignment);
+
+		if (Iter != m_Ranges.begin())
+		{
+			const SRange& Prev = *std::prev(Iter);
+			if (!Prev.IsFree && Prev.Kind != vKind && __isOnSamePage(Prev.Offset + Prev.Size - 1, Offset))
+				Offset = alignUp(Offset, m_Granularity);
+		}
+
+		if (Offset + vSize > Iter->Offset + Iter->Size) continue;
+
+		auto Next = std::next(Iter);
+		if (Next != m_Ranges.end() && !Next->IsFree && Next->Kind != vKind && __isOnSamePage(Offset + vSize - 1, Next->Offset)) continue;
+
+		if (BestFit == m_Ranges.end() || Iter->Size < BestFit->Size)
+		{
+			BestFit = Iter;
+			BestOffset = Offset;
+		}
+	}
+
+	if (BestFit == m_Ranges.end()) return false;
+
+	VkDeviceSize RangeEnd = BestFit->Offset + BestFit->Size;
+
+	if (BestOffset > BestFit->Offset)
+	{
+		m_Ranges.insert(BestFit, { BestFit->Offset, BestOffset - BestFit->Offset, true, EGpuResourceKind::Linear });
+	}
+
+	BestFit->Offset = BestOffset;
+	BestFit->Size = vSize;
+	BestFit->IsFree = false;
+	BestFit->Kind = vKind;
+
+	if (BestOffset + vSize < RangeEnd)
+	{
+		m_Ranges.insert(std::next(BestFit), { BestOffset + vSize, RangeEnd - BestOffset - vSize, true, EGpuResourceKind::Linear });
+	}
+
+	voOffset = BestOffset;
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CGpuMemoryBlock::__allocateLinear(VkDeviceSize vSize, VkDeviceSize vAlignment, EGpuResourceKind vKind, VkDeviceSize& voOffset)
+{
+	VkDeviceSize Offset = alignUp(m_LinearHead, vAlignment);
+	if (m_AllocationCount > 0 && m_LinearLastKind != vKind && __isOnSamePage(m_LinearHead - 1, Offset))
+		Offset = alignUp(Offset, m_Granularity);
+
+	if (Offset + vSize > m_Size) return false;
+
+	m_LinearHead = Offset + vSize;
+	m_LinearLastKind = vKind;
+	voOffset = Offset;
+
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CGpuMemoryBlock::__isOnSamePage(VkDeviceSize vEndOfPrevious, VkDeviceSize vStartOfNext) const
+{
+	return (vEndOfPrevious / m_Granularity) == (vStartOfNext / m_Granularity);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, VkDeviceSize vBlockSize)
+{
+	m_VkPhysicalDevice = vPhysicalDevice;
+	m_VkDevice = vDevice;
+	m_BlockSize = vBlockSize;
+
+	vkGetPhysicalDeviceMemoryProperties(m_VkPhysicalDevice, &m_VkMemoryProperties);
+
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
+	m_BufferImageGranularity = Properties.limits.bufferImageGranularity;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::destroy()
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	for (auto& Block : m_Blocks)
+	{
+		if (Block->getMappedData()) vkUnmapMemory(m_VkDevice, Block->getMemory());
+		vkFreeMemory(m_VkDevice, Block->getMemory(), nullptr);
+	}
+	m_Blocks.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+SGpuAllocation CGpuMemoryAllocator::allocate(const VkMemoryRequirements& vRequirements, VkMemoryPropertyFlags vProperties, EGpuResourceKind vKind, EAllocationStrategy vStrategy)
+{
+	uint32_t MemoryTypeIndex = findMemoryType(vRequirements.memoryTypeBits, vProperties);
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	SGpuAllocation Allocation;
+	Allocation.Size = vRequirements.size;
+
+	for (auto& Block : m_Blocks)
+	{
+		if (Block->getMemoryTypeIndex() != MemoryTypeIndex || Block->getStrategy() != vStrategy) continue;
+
+		if (Block->allocate(vRequirements.size, vRequirements.alignment, vKind, Allocation.Offset))
+		{
+			Allocation.pBlock = Block.get();
+			break;
+		}
+	}
+
+	if (!Allocation.isValid())
+	{
+		CGpuMemoryBlock* pBlock = __createBlock(MemoryTypeIndex, std::max(m_BlockSize, vRequirements.size), vStrategy);
+		if (!pBlock->allocate(vRequirements.size, vRequirements.alignment, vKind, Allocation.Offset))
+			throw std::runtime_error("failed to sub-allocate from a fresh memory block!");
+		Allocation.pBlock = pBlock;
+	}
+
+	Allocation.Memory = Allocation.pBlock->getMemory();
+	if (Allocation.pBlock->getMappedData())
+		Allocation.pMappedData = static_cast<char*>(Allocation.pBlock->getMappedData()) + Allocation.Offset;
+
+	return Allocation;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::free(SGpuAllocation& vioAllocation)
+{
+	if (!vioAllocation.isValid()) return;
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	CGpuMemoryBlock* pBlock = vioAllocation.pBlock;
+	pBlock->free(vioAllocation.Offset);
+
+	//NOTE: keep one empty block per memory type and strategy around so alternating create/destroy does not thrash vkAllocateMemory
+	if (pBlock->isEmpty())
+	{
+		auto Siblings = std::count_if(m_Blocks.begin(), m_Blocks.end(), [&](const std::unique_ptr<CGpuMemoryBlock>& vBlock)
+		{
+			return vBlock->getMemoryTypeIndex() == pBlock->getMemoryTypeIndex() && vBlock->getStrategy() == pBlock->getStrategy();
+		});
+		if (Siblings > 1) __destroyBlock(pBlock);
+	}
+
+	vioAllocation = SGpuAllocation();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::createBuffer(VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkMemoryPropertyFlags vProperties, VkBuffer& voBuffer, SGpuAllocation& voAllocation, EAllocationStrategy vStrategy)
+{
+	VkBufferCreateInfo BufferInfo = {};
+	BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	BufferInfo.size = vSize;
+	BufferInfo.usage = vUsage;
+	BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(m_VkDevice, &BufferInfo, nullptr, &voBuffer) != VK_SUCCESS)
+		throw std::runtime_error("failed to create buffer!");
+
+	VkMemoryRequirements MemRequirements;
+	vkGetBufferMemoryRequirements(m_VkDevice, voBuffer, &MemRequirements);
+
+	voAllocation = allocate(MemRequirements, vProperties, EGpuResourceKind::Linear, vStrategy);
+	vkBindBufferMemory(m_VkDevice, voBuffer, voAllocation.Memory, voAllocation.Offset);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::destroyBuffer(VkBuffer& vioBuffer, SGpuAllocation& vioAllocation)
+{
+	vkDestroyBuffer(m_VkDevice, vioBuffer, nullptr);
+	vioBuffer = VK_NULL_HANDLE;
+	free(vioAllocation);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::createImage(const VkImageCreateInfo& vImageInfo, VkMemoryPropertyFlags vProperties, VkImage& voImage, SGpuAllocation& voAllocation)
+{
+	if (vkCreateImage(m_VkDevice, &vImageInfo, nullptr, &voImage) != VK_SUCCESS)
+		throw std::runtime_error("failed to create image!");
+
+	VkMemoryRequirements MemRequirements;
+	vkGetImageMemoryRequirements(m_VkDevice, voImage, &MemRequirements);
+
+	EGpuResourceKind Kind = (vImageInfo.tiling == VK_IMAGE_TILING_OPTIMAL) ? EGpuResourceKind::Optimal : EGpuResourceKind::Linear;
+	voAllocation = allocate(MemRequirements, vProperties, Kind);
+	vkBindImageMemory(m_VkDevice, voImage, voAllocation.Memory, voAllocation.Offset);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::destroyImage(VkImage& vioImage, SGpuAllocation& vioAllocation)
+{
+	vkDestroyImage(m_VkDevice, vioImage, nullptr);
+	vioImage = VK_NULL_HANDLE;
+	free(vioAllocation);
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CGpuMemoryAllocator::findMemoryType(uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties) const
+{
+	for (uint32_t i = 0; i < m_VkMemoryProperties.memoryTypeCount; ++i)
+	{
+		if ((vTypeFilter & (1 << i)) && (m_VkMemoryProperties.memoryTypes[i].propertyFlags & vProperties) == vProperties)
+			return i;
+	}
+
+	throw std::runtime_error("failed to find suitable memory type!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CGpuMemoryAllocator::hasMemoryType(VkMemoryPropertyFlags vProperties) const
+{
+	for (uint32_t i = 0; i < m_VkMemoryProperties.memoryTypeCount; ++i)
+	{
+		if ((m_VkMemoryProperties.memoryTypes[i].propertyFlags & vProperties) == vProperties) return true;
+	}
+
+	return false;
+}
+
+//******************************************************************************************
+//FUNCTION:
+SGpuMemoryStatistics CGpuMemoryAllocator::getStatistics() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	SGpuMemoryStatistics Statistics;
+	VkDeviceSize FreeBytes = 0;
+
+	for (const auto& Block : m_Blocks)
+	{
+		Statistics.BlockCount++;
+		Statistics.AllocationCount += Block->getAllocationCount();
+		Statistics.ReservedBytes += Block->getSize();
+		Statistics.UsedBytes += Block->getUsedBytes();
+		Statistics.LargestFreeRange = std::max(Statistics.LargestFreeRange, Block->getLargestFreeRange());
+		FreeBytes += Block->getSize() - Block->getUsedBytes();
+	}
+
+	//NOTE: 0 means all free space is one contiguous range, values close to 1 mean it is scattered in small holes
+	if (FreeBytes > 0)
+		Statistics.Fragmentation = 1.0 - static_cast<double>(Statistics.LargestFreeRange) / static_cast<double>(FreeBytes);
+
+	return Statistics;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	SGpuMemoryStatistics Statistics = getStatistics();
+
+	vOutput << "{ \"blocks\": " << Statistics.BlockCount << ", \"allocations\": " << Statistics.AllocationCount
+		<< ", \"reserved_bytes\": " << Statistics.ReservedBytes << ", \"used_bytes\": " << Statistics.UsedBytes
+		<< ", \"largest_free_range\": " << Statistics.LargestFreeRange << ", \"fragmentation\": " << Statistics.Fragmentation << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+CGpuMemoryBlock* CGpuMemoryAllocator::__createBlock(uint32_t vMemoryTypeIndex, VkDeviceSize vSize, EAllocationStrategy vStrategy)
+{
+	VkMemoryAllocateInfo AllocInfo = {};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	AllocInfo.allocationSize = vSize;
+	AllocInfo.memoryTypeIndex = vMemoryTypeIndex;
+
+	VkDeviceMemory Memory;
+	if (vkAllocateMemory(m_VkDevice, &AllocInfo, nullptr, &Memory) != VK_SUCCESS)
+		throw std::runtime_error("failed to allocate memory block!");
+
+	//NOTE: host-visible blocks stay mapped for their whole lifetime, sub-allocations just offset into the mapping
+	void* pMappedData = nullptr;
+	if (m_VkMemoryProperties.memoryTypes[vMemoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		if (vkMapMemory(m_VkDevice, Memory, 0, VK_WHOLE_SIZE, 0, &pMappedData) != VK_SUCCESS)
+			throw std::runtime_error("failed to map memory block!");
+	}
+
+	m_Blocks.push_back(std::make_unique<CGpuMemoryBlock>(Memory, vSize, vMemoryTypeIndex, vStrategy, m_BufferImageGranularity, pMappedData));
+	return m_Blocks.back().get();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuMemoryAllocator::__destroyBlock(CGpuMemoryBlock* vBlock)
+{
+	auto Iter = std::find_if(m_Blocks.begin(), m_Blocks.end(), [&](const std::unique_ptr<CGpuMemoryBlock>& vCandidate) { return vCandidate.get() == vBlock; });
+	if (Iter == m_Blocks.end()) return;
+
+	if (vBlock->getMappedData()) vkUnmapMemory(m_VkDevice, vBlock->getMemory());
+	vkFreeMemory(m_VkDevice, vBlock->getMemory(), nullptr);
+	m_Blocks.erase(Iter);
+}
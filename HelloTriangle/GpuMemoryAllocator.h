@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+enum class EAllocationStrategy
+{
+	FreeList = 0,
+	Linear
+};
+
+enum class EGpuResourceKind
+{
+	Linear = 0,		//buffers and linear-tiling images
+	Optimal			//optimal-tiling images, must not share a bufferImageGranularity page with linear resources
+};
+
+class CGpuMemoryBlock
+{
+public:
+	CGpuMemoryBlock(VkDeviceMemory vMemory, VkDeviceSize vSize, uint32_t vMemoryTypeIndex, EAllocationStrategy vStrategy, VkDeviceSize vGranularity, void* vMappedData);
+
+	bool allocate(VkDeviceSize vSize, VkDeviceSize vAlignment, EGpuResourceKind vKind, VkDeviceSize& voOffset);
+	void free(VkDeviceSize vOffset);
+
+	VkDeviceMemory		getMemory() const { return m_VkMemory; }
+	VkDeviceSize		getSize() const { return m_Size; }
+	VkDeviceSize		getUsedBytes() const { return m_UsedBytes; }
+	VkDeviceSize		getLargestFreeRange() const;
+	uint32_t			getMemoryTypeIndex() const { return m_MemoryTypeIndex; }
+	uint32_t			getAllocationCount() const { return m_AllocationCount; }
+	EAllocationStrategy	getStrategy() const { return m_Strategy; }
+	void*				getMappedData() const { return m_pMappedData; }
+	bool				isEmpty() const { return 0 == m_AllocationCount; }
+
+private:
+	struct SRange
+	{
+		VkDeviceSize		Offset;
+		VkDeviceSize		Size;
+		bool				IsFree;
+		EGpuResourceKind	Kind;
+	};
+
+	VkDeviceMemory		m_VkMemory;
+	VkDeviceSize		m_Size;
+	uint32_t			m_MemoryTypeIndex;
+	EAllocationStrategy	m_Strategy;
+	VkDeviceSize		m_Granularity;
+	void*				m_pMappedData;
+
+	VkDeviceSize		m_UsedBytes = 0;
+	uint32_t			m_AllocationCount = 0;
+
+	std::list<SRange>	m_Ranges;
+
+	VkDeviceSize		m_LinearHead = 0;
+	EGpuResourceKind	m_LinearLastKind = EGpuResourceKind::Linear;
+
+	bool __allocateFromFreeList(VkDeviceSize vSize, VkDeviceSize vAlignment, EGpuResourceKind vKind, VkDeviceSize& voOffset);
+	bool __allocateLinear(VkDeviceSize vSize, VkDeviceSize vAlignment, EGpuResourceKind vKind, VkDeviceSize& voOffset);
+	bool __isOnSamePage(VkDeviceSize vEndOfPrevious, VkDeviceSize vStartOfNext) const;
+};
+
+struct SGpuAllocation
+{
+	VkDeviceMemory		Memory = VK_NULL_HANDLE;
+	VkDeviceSize		Offset = 0;
+	VkDeviceSize		Size = 0;
+	void*				pMappedData = nullptr;
+	CGpuMemoryBlock*	pBlock = nullptr;
+
+	bool isValid() const { return pBlock != nullptr; }
+};
+
+struct SGpuMemoryStatistics
+{
+	uint32_t		BlockCount = 0;
+	uint32_t		AllocationCount = 0;
+	VkDeviceSize	ReservedBytes = 0;
+	VkDeviceSize	UsedBytes = 0;
+	VkDeviceSize	LargestFreeRange = 0;
+	double			Fragmentation = 0.0;
+};
+
+class CGpuMemoryAllocator
+{
+public:
+	void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, VkDeviceSize vBlockSize);
+	void destroy();
+
+	SGpuAllocation allocate(const VkMemoryRequirements& vRequirements, VkMemoryPropertyFlags vProperties, EGpuResourceKind vKind, EAllocationStrategy vStrategy = EAllocationStrategy::FreeList);
+	void free(SGpuAllocation& vioAllocation);
+
+	void createBuffer(VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkMemoryPropertyFlags vProperties, VkBuffer& voBuffer, SGpuAllocation& voAllocation, EAllocationStrategy vStrategy = EAllocationStrategy::FreeList);
+	void destroyBuffer(VkBuffer& vioBuffer, SGpuAllocation& vioAllocation);
+	void createImage(const VkImageCreateInfo& vImageInfo, VkMemoryPropertyFlags vProperties, VkImage& voImage, SGpuAllocation& voAllocation);
+	void destroyImage(VkImage& vioImage, SGpuAllocation& vioAllocation);
+
+	uint32_t findMemoryType(uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties) const;
+	bool hasMemoryType(VkMemoryPropertyFlags vProperties) const;
+
+	SGpuMemoryStatistics getStatistics() const;
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	VkPhysicalDevice					m_VkPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice							m_VkDevice = VK_NULL_HANDLE;
+	VkPhysicalDeviceMemoryProperties	m_VkMemoryProperties = {};
+	VkDeviceSize						m_BlockSize = 0;
+	VkDeviceSize						m_BufferImageGranularity = 1;
+
+	std::vector<std::unique_ptr<CGpuMemoryBlock>> m_Blocks;
+	mutable std::mutex m_Mutex;
+
+	CGpuMemoryBlock* __createBlock(uint32_t vMemoryTypeIndex, VkDeviceSize vSize, EAllocationStrategy vStrategy);
+	void __destroyBlock(CGpuMemoryBlock* vBlock);
+};
@@ -0,0 +1,106 @@
+#include "GpuTimestampProfiler.h"
+#include <stdexcept>
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuTimestampProfiler::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, uint32_t vQueueFamilyIndex, uint32_t vSlotCount, uint32_t vMaxScopesPerSlot)
+{
+	m_VkDevice = vDevice;
+	m_MaxScopesPerSlot = vMaxScopesPerSlot;
+	m_SlotScopeNames.assign(vSlotCount, {});
+
+	uint32_t QueueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(vPhysicalDevice, &QueueFamilyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> QueueFamilies(QueueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(vPhysicalDevice, &QueueFamilyCount, QueueFamilies.data());
+
+	uint32_t ValidBits = QueueFamilies[vQueueFamilyIndex].timestampValidBits;
+	if (0 == ValidBits) return;
+
+	m_TimestampMask = (ValidBits >= 64) ? ~0ull : ((1ull << ValidBits) - 1);
+
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(vPhysicalDevice, &Properties);
+	m_NanosecondsPerTick = Properties.limits.timestampPeriod;
+
+	VkQueryPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	PoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	PoolInfo.queryCount = vSlotCount * vMaxScopesPerSlot * 2;
+
+	if (vkCreateQueryPool(m_VkDevice, &PoolInfo, nullptr, &m_VkQueryPool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create timestamp query pool!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuTimestampProfiler::destroy()
+{
+	if (m_VkQueryPool != VK_NULL_HANDLE) vkDestroyQueryPool(m_VkDevice, m_VkQueryPool, nullptr);
+	m_VkQueryPool = VK_NULL_HANDLE;
+	m_SlotScopeNames.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuTimestampProfiler::resetSlot(VkCommandBuffer vCommandBuffer, uint32_t vSlot)
+{
+	if (!isSupported()) return;
+
+	m_SlotScopeNames[vSlot].clear();
+	vkCmdResetQueryPool(vCommandBuffer, m_VkQueryPool, __getFirstQuery(vSlot), m_MaxScopesPerSlot * 2);
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CGpuTimestampProfiler::beginScope(VkCommandBuffer vCommandBuffer, uint32_t vSlot, const std::string& vName)
+{
+	auto& ScopeNames = m_SlotScopeNames[vSlot];
+	if (!isSupported() || ScopeNames.size() >= m_MaxScopesPerSlot) return UINT32_MAX;
+
+	uint32_t Scope = static_cast<uint32_t>(ScopeNames.size());
+	ScopeNames.push_back(vName);
+	vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_VkQueryPool, __getFirstQuery(vSlot) + Scope * 2);
+
+	return Scope;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CGpuTimestampProfiler::endScope(VkCommandBuffer vCommandBuffer, uint32_t vSlot, uint32_t vScope)
+{
+	if (!isSupported() || vScope == UINT32_MAX) return;
+
+	vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_VkQueryPool, __getFirstQuery(vSlot) + vScope * 2 + 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CGpuTimestampProfiler::fetchResults(uint32_t vSlot, std::vector<std::pair<std::string, double>>& voScopeTimes)
+{
+	voScopeTimes.clear();
+
+	auto& ScopeNames = m_SlotScopeNames[vSlot];
+	if (!isSupported() || ScopeNames.empty()) return false;
+
+	//NOTE: each result is followed by its availability word, so this never blocks; callers only ask after the slot's fence has signaled
+	uint32_t QueryCount = static_cast<uint32_t>(ScopeNames.size()) * 2;
+	std::vector<uint64_t> Results(QueryCount * 2);
+	VkResult Result = vkGetQueryPoolResults(m_VkDevice, m_VkQueryPool, __getFirstQuery(vSlot), QueryCount, Results.size() * sizeof(uint64_t), Results.data(),
+		2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (Result != VK_SUCCESS) return false;
+
+	for (size_t i = 0; i < ScopeNames.size(); ++i)
+	{
+		const uint64_t* pBegin = &Results[i * 4];
+		const uint64_t* pEnd = &Results[i * 4 + 2];
+		if (0 == pBegin[1] || 0 == pEnd[1]) continue;
+
+		uint64_t Ticks = ((pEnd[0] & m_TimestampMask) - (pBegin[0] & m_TimestampMask)) & m_TimestampMask;
+		voScopeTimes.emplace_back(ScopeNames[i], Ticks * m_NanosecondsPerTick / 1.0e6);
+	}
+	ScopeNames.clear();
+
+	return !voScopeTimes.empty();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <utility>
+#include <vulkan/vulkan.h>
+
+class CGpuTimestampProfiler
+{
+public:
+	void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, uint32_t vQueueFamilyIndex, uint32_t vSlotCount, uint32_t vMaxScopesPerSlot);
+	void destroy();
+
+	bool isSupported() const { return m_VkQueryPool != VK_NULL_HANDLE; }
+
+	void resetSlot(VkCommandBuffer vCommandBuffer, uint32_t vSlot);
+	uint32_t beginScope(VkCommandBuffer vCommandBuffer, uint32_t vSlot, const std::string& vName);
+	void endScope(VkCommandBuffer vCommandBuffer, uint32_t vSlot, uint32_t vScope);
+
+	//NOTE: the results of a slot are handed out once, a frame that is retried after an out of date swapchain does not count them again
+	bool fetchResults(uint32_t vSlot, std::vector<std::pair<std::string, double>>& voScopeTimes);
+
+private:
+	VkDevice	m_VkDevice = VK_NULL_HANDLE;
+	VkQueryPool	m_VkQueryPool = VK_NULL_HANDLE;
+	double		m_NanosecondsPerTick = 1.0;
+	uint64_t	m_TimestampMask = ~0ull;
+	uint32_t	m_MaxScopesPerSlot = 0;
+
+	std::vector<std::vector<std::string>> m_SlotScopeNames;
+
+	uint32_t __getFirstQuery(uint32_t vSlot) const { return vSlot * m_MaxScopesPerSlot * 2; }
+};
@@ -1,16 +1,72 @@
 #include "HelloTriangleApplication.h"
-#include <map>
 #include <set>
 #include <algorithm>
 #include <fstream>
+#include <cstring>
+#include <sstream>
+#include <chrono>
 #include <array>
+#include <thread>
+#include <cmath>
+#include <random>
 #include <glm/glm.hpp>
 
 namespace
 {
-	const int WINDOW_WIDTH = 800;
-	const int WINDOW_HEIGHT = 600;
-	const int MAX_FRAMES_IN_FLIGHT = 2;
+	const uint32_t MAX_FRAMES_IN_FLIGHT = 8;
+	const uint32_t DEFAULT_HEADLESS_FRAME_COUNT = 100;
+	const VkFormat OFFSCREEN_IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+	const uint32_t MAX_GPU_SCOPES_PER_FRAME = 16;
+	const VkDeviceSize MIN_STREAMING_STAGING_SIZE = 1024 * 1024;
+	const VkDeviceSize FRAME_UPLOAD_RING_BYTES_PER_FRAME = 64 * 1024;
+	const std::vector<size_t> RECORD_BENCHMARK_DRAW_COUNTS = { 1024, 4096, 16384, 65536 };
+	const uint32_t RECORD_BENCHMARK_ITERATIONS = 20;
+	const uint32_t STRESS_START_INSTANCES = 1024;
+	const uint32_t STRESS_WARMUP_FRAMES_PER_STEP = 30;
+	const uint32_t STRESS_FRAMES_PER_STEP = 120;
+	const double STRESS_FRAME_BUDGET_MS = 1000.0 / 30.0;
+	const std::vector<uint32_t> CULLING_BENCHMARK_OBJECT_COUNTS = { 1u << 16, 1u << 18, 1u << 20, 1u << 22 };
+	const uint32_t CULLING_BENCHMARK_WARMUP_FRAMES = 30;
+	const uint32_t CULLING_BENCHMARK_FRAMES = 120;
+	const char* const CULLING_MODE_NAMES[] = { "none", "cpu", "gpu" };
+	const char* const VERTEX_FORMAT_NAMES[] = { "float", "snorm16", "half" };
+	const std::vector<SShaderSource> HOT_RELOAD_SHADERS = { { "shaders/helloTriangle.vert", "shaders/vert.spv" }, { "shaders/helloTriangle.frag", "shaders/frag.spv" } };
+	const std::string SHADER_CACHE_DIRECTORY = "shaders/spirv_cache";
+	const std::vector<std::string> PACKED_ASSETS = { "shaders/vert.spv", "shaders/frag.spv", "shaders/cullObjects.spv" };
+	//NOTE: only states every device supports with the single sample render pass, so any combination is a valid variant
+	const std::vector<VkPrimitiveTopology> PIPELINE_BENCHMARK_TOPOLOGIES = { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP, VK_PRIMITIVE_TOPOLOGY_LINE_LIST, VK_PRIMITIVE_TOPOLOGY_LINE_STRIP };
+	const std::vector<VkCullModeFlags> PIPELINE_BENCHMARK_CULL_MODES = { VK_CULL_MODE_NONE, VK_CULL_MODE_FRONT_BIT, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_AND_BACK };
+	const std::vector<VkFrontFace> PIPELINE_BENCHMARK_FRONT_FACES = { VK_FRONT_FACE_CLOCKWISE, VK_FRONT_FACE_COUNTER_CLOCKWISE };
+	const std::vector<EBlendMode> PIPELINE_BENCHMARK_BLEND_MODES = { EBlendMode::Opaque, EBlendMode::Alpha, EBlendMode::Additive };
+	const char* const PRESENT_MODE_POLICY_NAMES[] = { "mailbox", "fifo", "fifo-relaxed", "immediate" };
+	const char* const DRAW_SORT_ORDER_NAMES[] = { "none", "front-to-back", "back-to-front" };
+	//NOTE: no stencil is used, so pure depth formats come first; the spec guarantees D16_UNORM, so the search always succeeds on a conformant device
+	const std::vector<VkFormat> DEPTH_FORMAT_CANDIDATES = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D16_UNORM };
+	const uint32_t OVERDRAW_BENCHMARK_WARMUP_FRAMES = 30;
+	const uint32_t OVERDRAW_BENCHMARK_FRAMES = 120;
+	const double CAPTURE_FRAME_RATE = 60.0;
+
+	struct SOverdrawBenchmarkCase
+	{
+		const char*		pName;
+		bool			DepthTest;
+		EDrawSortOrder	SortOrder;
+	};
+	const SOverdrawBenchmarkCase OVERDRAW_BENCHMARK_CASES[] =
+	{
+		{ "no_depth_test", false, EDrawSortOrder::None },
+		{ "back_to_front", true, EDrawSortOrder::BackToFront },
+		{ "front_to_back", true, EDrawSortOrder::FrontToBack }
+	};
+
+	//NOTE: every policy ends up on fifo, the only present mode the spec guarantees
+	const std::vector<VkPresentModeKHR> PRESENT_MODE_PREFERENCES[] =
+	{
+		{ VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR },
+		{ VK_PRESENT_MODE_FIFO_KHR },
+		{ VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR },
+		{ VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR }
+	};
 	const std::vector<const char*> VALIDATION_LAYERS = { "VK_LAYER_LUNARG_standard_validation" };
 	const std::vector<const char*> DEVICE_EXTNESIONS = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
@@ -18,28 +74,44 @@ namespace
 	{
 		glm::vec2 Pos;
 		glm::vec3 Color;
+	};
+	//NOTE: the mesh is built and optimized in this layout, CVertexQuantizer reads it as five packed floats and writes the selected format
+	static_assert(sizeof(Vertex) == 5 * sizeof(float), "Vertex must stay five tightly packed floats");
 
-		static VkVertexInputBindingDescription getBindingDescription()
+	//NOTE: per-instance data is kept as one array per attribute, each bound as its own instance-rate stream
+	struct InstanceStreams
+	{
+		static std::array<VkVertexInputBindingDescription, 3> getBindingDescriptions()
 		{
-			VkVertexInputBindingDescription BindingDescription = {};
-			BindingDescription.binding = 0;
-			BindingDescription.stride = sizeof(Vertex);
-			BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-			return BindingDescription;
+			std::array<VkVertexInputBindingDescription, 3> BindingDescriptions = {};
+			BindingDescriptions[0].binding = 1;
+			BindingDescriptions[0].stride = sizeof(glm::vec3);
+			BindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+			BindingDescriptions[1].binding = 2;
+			BindingDescriptions[1].stride = sizeof(glm::vec3);
+			BindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+			BindingDescriptions[2].binding = 3;
+			BindingDescriptions[2].stride = sizeof(float);
+			BindingDescriptions[2].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+			return BindingDescriptions;
 		}
 
-		static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
+		static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
 		{
-			std::array<VkVertexInputAttributeDescription, 2> AttributeDescriptions = {};
-			AttributeDescriptions[0].binding = 0;
-			AttributeDescriptions[0].location = 0;
-			AttributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-			AttributeDescriptions[0].offset = offsetof(Vertex, Pos);
-			AttributeDescriptions[1].binding = 0;
-			AttributeDescriptions[1].location = 1;
+			std::array<VkVertexInputAttributeDescription, 3> AttributeDescriptions = {};
+			AttributeDescriptions[0].binding = 1;
+			AttributeDescriptions[0].location = 2;
+			AttributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+			AttributeDescriptions[0].offset = 0;
+			AttributeDescriptions[1].binding = 2;
+			AttributeDescriptions[1].location = 3;
 			AttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			AttributeDescriptions[1].offset = offsetof(Vertex, Color);
+			AttributeDescriptions[1].offset = 0;
+			AttributeDescriptions[2].binding = 3;
+			AttributeDescriptions[2].location = 4;
+			AttributeDescriptions[2].format = VK_FORMAT_R32_SFLOAT;
+			AttributeDescriptions[2].offset = 0;
 
 			return AttributeDescriptions;
 		}
@@ -51,15 +123,56 @@ namespace
 		{{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
 		{{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
 	};
+
+	const uint32_t MESH_ANALYSIS_CACHE_SIZE = 16;
+	const uint32_t MAX_MESH_DENSITY = 1024;
+
+	//NOTE: laid out to match the std140 FrameUniforms block of the vertex shader
+	struct SFrameUniforms
+	{
+		glm::vec4 ColorTint;
+		float Time;
+		float PulseAmplitude;
+		float Padding[2];
+	};
+
+	//NOTE: small enough for the 128 bytes of push constants every device guarantees
+	struct SDrawConstants
+	{
+		glm::vec4 Tint;
+	};
+
+	//NOTE: radius of the circle around the triangle, in units of the instance scale
+	const float TRIANGLE_BOUNDING_RADIUS = 0.7072f;
 }
 
 //******************************************************************************************
 //FUNCTION:
 void CHelloTriangleApplication::run()
 {
+	if (!m_Config.PackAssetsFile.empty())
+	{
+		CAssetLoader::packArchive(m_Config.PackAssetsFile, PACKED_ASSETS);
+		std::cerr << "packed " << PACKED_ASSETS.size() << " assets into " << m_Config.PackAssetsFile << std::endl;
+		return;
+	}
+
 	__init();
-	__mainLoop();
+	if (m_Config.RecordBenchmark)
+		__runRecordBenchmark();
+	else if (m_Config.StressTest)
+		__runStressTest();
+	else if (m_Config.CullingBenchmark)
+		__runCullingBenchmark();
+	else if (m_Config.PipelineBenchmark)
+		__runPipelineBenchmark();
+	else if (m_Config.OverdrawBenchmark)
+		__runOverdrawBenchmark();
+	else
+		__mainLoop();
 	__cleanup();
+
+	if (m_IsCaptureMismatched) throw std::runtime_error("captured frames differ from the reference frames!");
 }
 
 //******************************************************************************************
@@ -72,7 +185,16 @@ void CHelloTriangleApplication::__init()
 	m_EnableValidationLayers = false;
 #endif
 
-	__initWindow();
+	m_Config.FramesInFlight = std::min(std::max(m_Config.FramesInFlight, 1u), MAX_FRAMES_IN_FLIGHT);
+	m_StartTime = std::chrono::steady_clock::now();
+
+	//NOTE: the watcher rewrites the loose SPIR-V files, so the archive would hide every reload
+	if (!m_Config.AssetArchiveFile.empty() && m_Config.HotReloadShaders)
+		std::cerr << "ignoring asset archive " << m_Config.AssetArchiveFile << " while shaders are hot-reloaded" << std::endl;
+	else if (!m_Config.AssetArchiveFile.empty())
+		m_AssetLoader.openArchive(m_Config.AssetArchiveFile);
+
+	if (!m_Config.Headless) __initWindow();
 	__initVulkan();
 }
 
@@ -83,40 +205,72 @@ void CHelloTriangleApplication::__initWindow()
 	glfwInit();
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
-	m_pGLFWWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Vulkan", nullptr, nullptr);
+	m_pGLFWWindow = glfwCreateWindow(m_Config.Width, m_Config.Height, "Vulkan", nullptr, nullptr);
+	glfwSetWindowUserPointer(m_pGLFWWindow, this);
+	glfwSetFramebufferSizeCallback(m_pGLFWWindow, __framebufferResizeCallback);
+	glfwSetKeyCallback(m_pGLFWWindow, __keyCallback);
 }
 
 //******************************************************************************************
 //FUNCTION:
-static VKAPI_ATTR VkBool32 VKAPI_CALL __debugCallback(
-	VkDebugUtilsMessageSeverityFlagBitsEXT vMessageSeverity,
-	VkDebugUtilsMessageTypeFlagsEXT vMessageType,
-	const VkDebugUtilsMessengerCallbackDataEXT* vCallbackData,
-	void* vUserData)
+void CHelloTriangleApplication::__framebufferResizeCallback(GLFWwindow* vWindow, int vWidth, int vHeight)
 {
-	std::cerr << "validation layer: " << vCallbackData->pMessage << std::endl;
-	return VK_FALSE;
+	auto pApp = reinterpret_cast<CHelloTriangleApplication*>(glfwGetWindowUserPointer(vWindow));
+	pApp->m_IsFramebufferResized = true;
 }
 
 //******************************************************************************************
 //FUNCTION:
-static std::vector<char> __readFile(const std::string& vFilename) {
-	std::ifstream File(vFilename, std::ios::ate | std::ios::binary);
-
-	if (!File.is_open())
-		throw std::runtime_error("failed to open file!");
+void CHelloTriangleApplication::__keyCallback(GLFWwindow* vWindow, int vKey, int vScancode, int vAction, int vMods)
+{
+	//NOTE: the swap chain is rebuilt after the next present, never from inside event polling
+	if (vKey != GLFW_KEY_P || vAction != GLFW_PRESS) return;
 
-	size_t FileSize = (size_t)File.tellg();
-	std::vector<char> Buffer(FileSize);
+	auto pApp = reinterpret_cast<CHelloTriangleApplication*>(glfwGetWindowUserPointer(vWindow));
+	pApp->m_IsPresentModeChangeRequested = true;
+}
 
-	File.seekg(0);
-	File.read(Buffer.data(), FileSize);
+//******************************************************************************************
+//FUNCTION:
+static const char* __getPresentModeName(VkPresentModeKHR vPresentMode)
+{
+	switch (vPresentMode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+	case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo-relaxed";
+	default: return "unknown";
+	}
+}
 
-	File.close();
+//******************************************************************************************
+//FUNCTION:
+static const char* __getDepthFormatName(VkFormat vFormat)
+{
+	switch (vFormat)
+	{
+	case VK_FORMAT_D32_SFLOAT: return "d32_sfloat";
+	case VK_FORMAT_X8_D24_UNORM_PACK32: return "x8_d24_unorm";
+	case VK_FORMAT_D24_UNORM_S8_UINT: return "d24_unorm_s8_uint";
+	case VK_FORMAT_D32_SFLOAT_S8_UINT: return "d32_sfloat_s8_uint";
+	case VK_FORMAT_D16_UNORM: return "d16_unorm";
+	default: return "unknown";
+	}
+}
 
-	return Buffer;
+//******************************************************************************************
+//FUNCTION:
+static VKAPI_ATTR VkBool32 VKAPI_CALL __debugCallback(
+	VkDebugUtilsMessageSeverityFlagBitsEXT vMessageSeverity,
+	VkDebugUtilsMessageTypeFlagsEXT vMessageType,
+	const VkDebugUtilsMessengerCallbackDataEXT* vCallbackData,
+	void* vUserData)
+{
+	std::cerr << "validation layer: " << vCallbackData->pMessage << std::endl;
+	return VK_FALSE;
 }
 
 //******************************************************************************************
@@ -125,64 +279,348 @@ void CHelloTriangleApplication::__initVulkan()
 {
 	__createVulkanInstance();
 	__setupDebugCallback();
-	__createSurface();
+	if (!m_Config.Headless) __createSurface();
 	__pickPhysicalDevice();
 	__createLogicalDevice();
-	__createSwapChain();
+	__createMemoryAllocator();
+	if (m_Config.Headless)
+		__createOffscreenTargets();
+	else
+		__createSwapChain();
 	__createImageViews();
+	__createFrameCapture();
+	__selectDepthFormat();
 	__createRenderPass();
+	__createPipelineCache();
+	m_DescriptorLayoutCache.create(m_VkDevice);
+	m_DescriptorAllocator.create(m_VkDevice, m_Config.FramesInFlight);
+	__createDescriptorSetLayout();
+	__selectVertexFormat();
 	__createGraphicsPipeline();
-	__createFrameBuffers();
 	__createCommandPool();
-	__createVertexBuffer();
+	__createMesh();
+	__createGpuCuller();
+	__createStreamingUploader();
+	__createInstanceBuffer(std::max(m_Config.InstanceCount, m_Config.DrawCount));
+	__createDrawList();
+	m_RenderGraph.create(m_VkDevice, &m_GpuAllocator);
+	__buildRenderGraph();
+	__createFrameBuffers();
+	__createFrameUploadRing();
+	__createGpuProfiler();
 	__createCommandBuffers();
 	__createSyncObjects();
+
+	if (m_Config.HotReloadShaders) m_ShaderReloader.start(HOT_RELOAD_SHADERS, SHADER_CACHE_DIRECTORY);
 }
 
 //******************************************************************************************
 //FUNCTION:
 void CHelloTriangleApplication::__drawFrame()
 {
+	//NOTE: events were polled right before this frame, so this is the oldest input the frame can reflect
+	auto InputTime = std::chrono::steady_clock::now();
+	m_FrameStatistics.beginFrame();
+	__recordCompletedFrames();
+
 	vkWaitForFences(m_VkDevice, 1, &m_VkInFlightFences[m_CurrentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+	m_FrameStatistics.endPhase(EFramePhase::FenceWait);
+	__recordCompletedFrames();
+
+	std::vector<std::pair<std::string, double>> GpuScopeTimes;
+	if (m_GpuProfiler.fetchResults(static_cast<uint32_t>(m_CurrentFrame), GpuScopeTimes))
+	{
+		for (const auto& Scope : GpuScopeTimes) m_FrameStatistics.recordGpuScope(Scope.first, Scope.second);
+	}
+
+	//NOTE: overdraw is relative to the whole target, so uncovered pixels pull it below one
+	uint64_t FragmentCount = 0;
+	if (m_OverdrawCounter.fetchResult(static_cast<uint32_t>(m_CurrentFrame), FragmentCount))
+	{
+		m_FrameStatistics.recordCounter("fragments", static_cast<double>(FragmentCount));
+		m_FrameStatistics.recordCounter("overdraw", static_cast<double>(FragmentCount) / (static_cast<double>(m_VkSwapChainExtent.width) * m_VkSwapChainExtent.height));
+	}
+
+	if (m_FrameCapture.isCreated()) m_FrameCapture.collect(static_cast<uint32_t>(m_CurrentFrame));
+
+	if (m_ShaderReloader.isStarted()) __updateShaderReload();
+
+	//NOTE: in headless mode there is one offscreen target per frame in flight, so the fence above already guarantees the target is idle
+	uint32_t ImageIndex = static_cast<uint32_t>(m_CurrentFrame);
+	if (!m_Config.Headless)
+	{
+		VkResult Result = vkAcquireNextImageKHR(m_VkDevice, m_VkSwapChain, std::numeric_limits<uint64_t>::max(), m_VkImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
+
+		//NOTE: the fence is only reset once an image is acquired, otherwise the next wait on it would never return
+		if (Result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			__recreateSwapChain();
+			return;
+		}
+		else if (Result != VK_SUCCESS && Result != VK_SUBOPTIMAL_KHR)
+		{
+			throw std::runtime_error("failed to acquire swap chain image!");
+		}
+	}
+
+	//NOTE: with more images than frames in flight an acquired image can still be rendered by another slot
+	if (m_VkImagesInFlight[ImageIndex] != VK_NULL_HANDLE && m_VkImagesInFlight[ImageIndex] != m_VkInFlightFences[m_CurrentFrame])
+		vkWaitForFences(m_VkDevice, 1, &m_VkImagesInFlight[ImageIndex], VK_TRUE, std::numeric_limits<uint64_t>::max());
+	m_VkImagesInFlight[ImageIndex] = m_VkInFlightFences[m_CurrentFrame];
+	m_FrameStatistics.endPhase(EFramePhase::Acquire);
+
+	//NOTE: uploads are only submitted once the frame is certain to be submitted too, an unwaited semaphore could not be signaled again
+	VkSemaphore UploadSemaphore = VK_NULL_HANDLE;
+	VkPipelineStageFlags UploadWaitStage = 0;
+	if (m_StreamingUploader.isCreated())
+	{
+		m_StreamingUploader.beginFrame(static_cast<uint32_t>(m_CurrentFrame));
+		__streamInstanceColors(static_cast<uint32_t>(m_CurrentFrame));
+		UploadSemaphore = m_StreamingUploader.submit(UploadWaitStage);
+	}
+
 	vkResetFences(m_VkDevice, 1, &m_VkInFlightFences[m_CurrentFrame]);
 
-	uint32_t ImageIndex;
-	vkAcquireNextImageKHR(m_VkDevice, m_VkSwapChain, std::numeric_limits<uint64_t>::max(), m_VkImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
+	__recordCommandBuffer(static_cast<uint32_t>(m_CurrentFrame), ImageIndex);
+	m_FrameStatistics.endPhase(EFramePhase::Record);
 
 	VkSubmitInfo SubmitInfo = {};
 	SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	VkSemaphore WaitSemaphores[] = { m_VkImageAvailableSemaphores[m_CurrentFrame] };
-	VkPipelineStageFlags WaitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	SubmitInfo.waitSemaphoreCount = 1;
-	SubmitInfo.pWaitSemaphores = WaitSemaphores;
-	SubmitInfo.pWaitDstStageMask = WaitStages;
+	std::vector<VkSemaphore> WaitSemaphores;
+	std::vector<VkPipelineStageFlags> WaitStages;
+	VkSemaphore SignalSemaphores[] = { m_VkRenderFinishedSemaphores[m_CurrentFrame] };
 
-	SubmitInfo.commandBufferCount = 1;
-	SubmitInfo.pCommandBuffers = &m_VkCommandBuffers[ImageIndex];
+	if (!m_Config.Headless)
+	{
+		WaitSemaphores.push_back(m_VkImageAvailableSemaphores[m_CurrentFrame]);
+		WaitStages.push_back(m_RenderGraph.getFirstUseStages(m_ColorTargetResource));
+		SubmitInfo.signalSemaphoreCount = 1;
+		SubmitInfo.pSignalSemaphores = SignalSemaphores;
+	}
 
-	VkSemaphore SignalSemaphores[] = { m_VkRenderFinishedSemaphores[m_CurrentFrame] };
-	SubmitInfo.signalSemaphoreCount = 1;
-	SubmitInfo.pSignalSemaphores = SignalSemaphores;
+	if (UploadSemaphore != VK_NULL_HANDLE)
+	{
+		WaitSemaphores.push_back(UploadSemaphore);
+		WaitStages.push_back(UploadWaitStage);
+	}
+
+	SubmitInfo.waitSemaphoreCount = static_cast<uint32_t>(WaitSemaphores.size());
+	SubmitInfo.pWaitSemaphores = WaitSemaphores.data();
+	SubmitInfo.pWaitDstStageMask = WaitStages.data();
+
+	SubmitInfo.commandBufferCount = 1;
+	SubmitInfo.pCommandBuffers = &m_VkCommandBuffers[m_CurrentFrame];
 
 	if (vkQueueSubmit(m_VkGraphicsQueue, 1, &SubmitInfo, m_VkInFlightFences[m_CurrentFrame]) != VK_SUCCESS)
 		throw std::runtime_error("failed to submit draw command buffer!");
+	m_FrameInputTimes[m_CurrentFrame] = InputTime;
+	m_FrameStatistics.endPhase(EFramePhase::Submit);
+
+	if (!m_Config.Headless)
+	{
+		VkPresentInfoKHR PresentInfo = {};
+		PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+
+		PresentInfo.waitSemaphoreCount = 1;
+		PresentInfo.pWaitSemaphores = SignalSemaphores;
+
+		VkSwapchainKHR SwapChains[] = { m_VkSwapChain };
+		PresentInfo.swapchainCount = 1;
+		PresentInfo.pSwapchains = SwapChains;
+
+		PresentInfo.pImageIndices = &ImageIndex;
+		PresentInfo.pNext = m_PacingMonitor.preparePresent();
+
+		VkResult Result = vkQueuePresentKHR(m_VkPresentQueue, &PresentInfo);
+		if (Result != VK_SUCCESS && Result != VK_SUBOPTIMAL_KHR && Result != VK_ERROR_OUT_OF_DATE_KHR)
+			throw std::runtime_error("failed to present swap chain image!");
+		if (Result != VK_ERROR_OUT_OF_DATE_KHR) m_PacingMonitor.onPresented();
+
+		//NOTE: real failures are thrown above, so a pending mode switch or resize never hides a lost device or surface
+		if (m_IsPresentModeChangeRequested)
+		{
+			m_IsPresentModeChangeRequested = false;
+			m_IsFramebufferResized = false;
+			__switchPresentMode();
+		}
+		else if (Result == VK_ERROR_OUT_OF_DATE_KHR || Result == VK_SUBOPTIMAL_KHR || m_IsFramebufferResized)
+		{
+			m_IsFramebufferResized = false;
+			__recreateSwapChain();
+		}
+	}
+	m_FrameStatistics.endPhase(EFramePhase::Present);
+
+	m_CurrentFrame = (m_CurrentFrame + 1) % m_Config.FramesInFlight;
+	++m_FrameNumber;
+
+	m_FrameStatistics.endFrame();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__recreateSwapChain()
+{
+	int Width = 0, Height = 0;
+	glfwGetFramebufferSize(m_pGLFWWindow, &Width, &Height);
+	while (0 == Width || 0 == Height)
+	{
+		glfwGetFramebufferSize(m_pGLFWWindow, &Width, &Height);
+		glfwWaitEvents();
+	}
+
+	auto StartTime = std::chrono::steady_clock::now();
+
+	//NOTE: only the frames already submitted can still reference the objects torn down below, so waiting on their fences is enough
+	__waitForFramesInFlight();
+	__cleanupSwapChain();
+
+	VkFormat OldFormat = m_VkSwapChainImageFormat;
+	__createSwapChain();
+	__createImageViews();
+
+	if (m_FrameCapture.isCreated() && (!m_IsSwapChainCopyable || !m_FrameCapture.setTarget(m_VkSwapChainExtent, m_VkSwapChainImageFormat)))
+	{
+		std::cerr << "frame capture stopped, the new swap chain images cannot be captured" << std::endl;
+		m_FrameCapture.destroy();
+	}
+
+	if (m_VkSwapChainImageFormat != OldFormat)
+	{
+		__discardPendingPipeline();
+		m_pPipelineRegistry->destroy();
+		vkDestroyPipelineLayout(m_VkDevice, m_VkPipelineLayout, nullptr);
+		vkDestroyRenderPass(m_VkDevice, m_VkRenderPass, nullptr);
+
+		__createRenderPass();
+		__createGraphicsPipeline();
+	}
 
-	VkPresentInfoKHR PresentInfo = {};
-	PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	__buildRenderGraph();
+	__createFrameBuffers();
+	m_PacingMonitor.setSwapChain(m_VkSwapChain);
+
+	m_FrameStatistics.recordEvent("swapchain_recreate", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__updateShaderReload()
+{
+	//NOTE: called right after this frame's fence wait, so the GPU is done with whatever was recorded FramesInFlight frames ago
+	for (auto Iter = m_RetiredPipelineRegistries.begin(); Iter != m_RetiredPipelineRegistries.end();)
+	{
+		if (--Iter->first > 0) { ++Iter; continue; }
+
+		Iter->second->destroy();
+		Iter = m_RetiredPipelineRegistries.erase(Iter);
+	}
+
+	if (m_PendingPipelineBuild.valid())
+	{
+		if (m_PendingPipelineBuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+		try
+		{
+			m_PendingPipelineBuild.get();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "keeping the previous pipeline, the reloaded shaders failed: " << e.what() << std::endl;
+			__discardPendingPipeline();
+			return;
+		}
+
+		m_RetiredPipelineRegistries.emplace_back(m_Config.FramesInFlight, std::move(m_pPipelineRegistry));
+		m_pPipelineRegistry = std::move(m_pPendingPipelineRegistry);
+		m_VkGraphicsPipeline = m_pPipelineRegistry->getPipeline(SPipelineStateDesc());
+
+		m_FrameStatistics.recordEvent("shader_reload", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_ShaderChangeTime).count());
+		return;
+	}
+
+	if (!m_ShaderReloader.consumeUpdate(m_ShaderChangeTime)) return;
+
+	//NOTE: the pipeline is compiled off the render thread, frames keep using the old one until it is ready
+	try
+	{
+		m_pPendingPipelineRegistry = std::make_unique<CPipelineRegistry>();
+		m_pPendingPipelineRegistry->create(m_VkDevice, m_PipelineCache.getHandle(), __createPipelineProgram());
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "keeping the previous pipeline, the reloaded shaders failed: " << e.what() << std::endl;
+		__discardPendingPipeline();
+		return;
+	}
+
+	CPipelineRegistry* pRegistry = m_pPendingPipelineRegistry.get();
+	m_PendingPipelineBuild = std::async(std::launch::async, [pRegistry]() { pRegistry->getPipeline(SPipelineStateDesc()); });
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__discardPendingPipeline()
+{
+	if (m_PendingPipelineBuild.valid())
+	{
+		m_PendingPipelineBuild.wait();
+		m_PendingPipelineBuild = std::future<void>();
+	}
+
+	if (m_pPendingPipelineRegistry) m_pPendingPipelineRegistry->destroy();
+	m_pPendingPipelineRegistry.reset();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__switchPresentMode()
+{
+	std::cerr << "present mode " << __getPresentModeName(m_VkPresentMode) << ": ";
+	m_PacingMonitor.dumpJson(std::cerr);
+	std::cerr << std::endl;
 
-	PresentInfo.waitSemaphoreCount = 1;
-	PresentInfo.pWaitSemaphores = SignalSemaphores;
+	auto NextPolicy = (static_cast<int>(m_Config.PresentModePolicy) + 1) % static_cast<int>(EPresentModePolicy::Count);
+	m_Config.PresentModePolicy = static_cast<EPresentModePolicy>(NextPolicy);
+
+	__recreateSwapChain();
+	m_PacingMonitor.reset();
+
+	std::cerr << "present mode policy " << PRESENT_MODE_POLICY_NAMES[NextPolicy] << " selected " << __getPresentModeName(m_VkPresentMode) << std::endl;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__cleanupSwapChain()
+{
+	for (auto Framebuffer : m_VkSwapChainFramebuffers) vkDestroyFramebuffer(m_VkDevice, Framebuffer, nullptr);
+	m_VkSwapChainFramebuffers.clear();
 
-	VkSwapchainKHR SwapChains[] = { m_VkSwapChain };
-	PresentInfo.swapchainCount = 1;
-	PresentInfo.pSwapchains = SwapChains;
+	for (auto ImageView : m_VkSwapChainImageViews) vkDestroyImageView(m_VkDevice, ImageView, nullptr);
+	m_VkSwapChainImageViews.clear();
+}
 
-	PresentInfo.pImageIndices = &ImageIndex;
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__waitForFramesInFlight()
+{
+	vkWaitForFences(m_VkDevice, static_cast<uint32_t>(m_VkInFlightFences.size()), m_VkInFlightFences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+	__recordCompletedFrames();
+}
 
-	vkQueuePresentKHR(m_VkPresentQueue, &PresentInfo);
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__recordCompletedFrames()
+{
+	//NOTE: the latency ends when the fence is first seen signaled, i.e. when the GPU has finished the frame; polling every slot once per frame bounds the error by one frame time
+	for (size_t i = 0; i < m_FrameInputTimes.size(); ++i)
+	{
+		if (!m_FrameInputTimes[i].has_value() || vkGetFenceStatus(m_VkDevice, m_VkInFlightFences[i]) != VK_SUCCESS) continue;
 
-	m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		m_FrameStatistics.recordInputLatency(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_FrameInputTimes[i].value()).count());
+		m_FrameInputTimes[i].reset();
+	}
 }
 
 //******************************************************************************************
@@ -197,17 +635,31 @@ void CHelloTriangleApplication::__pickPhysicalDevice()
 	std::vector<VkPhysicalDevice> Devices(DeviceCount);
 	vkEnumeratePhysicalDevices(m_VkInstance, &DeviceCount, Devices.data());
 
-	std::multimap<int, VkPhysicalDevice> Candidates;
+	std::vector<SPhysicalDeviceInfo> Candidates;
 	for (const auto& Device : Devices)
 	{
-		if (__isDeviceSuitable(Device))
-		{
-			m_VkPhysicalDevice = Device;
-			break;
-		}
+		SPhysicalDeviceInfo Info = CDeviceSelector::queryDeviceInfo(Device);
+		Info.IsSuitable = __isDeviceSuitable(Device);
+		Candidates.push_back(Info);
+	}
+
+	if (m_Config.ListDevices) CDeviceSelector::dumpDeviceList(std::cerr, Candidates);
+
+	int Selected = -1;
+	if (!m_Config.DeviceOverride.empty())
+	{
+		Selected = CDeviceSelector::findOverride(Candidates, m_Config.DeviceOverride);
+		if (Selected < 0) throw std::runtime_error("failed to find the requested GPU!");
+		if (!Candidates[Selected].IsSuitable) throw std::runtime_error("the requested GPU is not suitable!");
+	}
+	else
+	{
+		Selected = CDeviceSelector::findBest(Candidates);
+		if (Selected < 0) throw std::runtime_error("failed to find a suitable GPU!");
 	}
 
-	if (m_VkPhysicalDevice == VK_NULL_HANDLE) throw std::runtime_error("failed to find a suitable GPU!");
+	m_VkPhysicalDevice = Candidates[Selected].Device;
+	if (m_Config.ListDevices) std::cerr << "selected [" << Selected << "] " << Candidates[Selected].Properties.deviceName << std::endl;
 }
 
 //******************************************************************************************
@@ -217,7 +669,7 @@ void CHelloTriangleApplication::__createLogicalDevice()
 	SQueueFamilyIndices Indices = __findQueueFamilies(m_VkPhysicalDevice);
 
 	std::vector<VkDeviceQueueCreateInfo> QueueCreateInfos;
-	std::set<uint32_t> UniqueQueueFamilies = { Indices.GraphicsFamily.value(), Indices.PresentFamily.value() };
+	std::set<uint32_t> UniqueQueueFamilies = { Indices.GraphicsFamily.value(), Indices.PresentFamily.value(), Indices.getUploadFamily() };
 
 	float QueuePriority = 1.0f;
 	for (uint32_t QueueFamily : UniqueQueueFamilies)
@@ -230,7 +682,19 @@ void CHelloTriangleApplication::__createLogicalDevice()
 		QueueCreateInfos.push_back(QueueCreateInfo);
 	}
 
+	VkPhysicalDeviceFeatures SupportedFeatures;
+	vkGetPhysicalDeviceFeatures(m_VkPhysicalDevice, &SupportedFeatures);
+
+	//NOTE: gpu culling emits one indirect command per visible object, each addressing its object through firstInstance
 	VkPhysicalDeviceFeatures DeviceFeatures = {};
+	DeviceFeatures.multiDrawIndirect = SupportedFeatures.multiDrawIndirect;
+	DeviceFeatures.drawIndirectFirstInstance = SupportedFeatures.drawIndirectFirstInstance;
+	m_IsGpuCullingSupported = SupportedFeatures.multiDrawIndirect && SupportedFeatures.drawIndirectFirstInstance;
+
+	//NOTE: the overdraw query stays active while the secondary command buffers execute, which also needs inherited queries
+	DeviceFeatures.pipelineStatisticsQuery = SupportedFeatures.pipelineStatisticsQuery;
+	DeviceFeatures.inheritedQueries = SupportedFeatures.inheritedQueries;
+	m_IsOverdrawQuerySupported = SupportedFeatures.pipelineStatisticsQuery && SupportedFeatures.inheritedQueries;
 
 	VkDeviceCreateInfo CreateInfo = {};
 	CreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -240,8 +704,13 @@ void CHelloTriangleApplication::__createLogicalDevice()
 
 	CreateInfo.pEnabledFeatures = &DeviceFeatures;
 
-	CreateInfo.enabledExtensionCount = static_cast<uint32_t>(DEVICE_EXTNESIONS.size());
-	CreateInfo.ppEnabledExtensionNames = DEVICE_EXTNESIONS.data();
+	auto DeviceExtensions = __getRequiredDeviceExtensions();
+	m_IsDrawIndirectCountSupported = __isDeviceExtensionAvailable(m_VkPhysicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	if (m_IsDrawIndirectCountSupported) DeviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	bool IsDisplayTimingSupported = !m_Config.Headless && __isDeviceExtensionAvailable(m_VkPhysicalDevice, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+	if (IsDisplayTimingSupported) DeviceExtensions.push_back(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+	CreateInfo.enabledExtensionCount = static_cast<uint32_t>(DeviceExtensions.size());
+	CreateInfo.ppEnabledExtensionNames = DeviceExtensions.data();
 
 	if (m_EnableValidationLayers)
 	{
@@ -258,6 +727,16 @@ void CHelloTriangleApplication::__createLogicalDevice()
 
 	vkGetDeviceQueue(m_VkDevice, Indices.GraphicsFamily.value(), 0, &m_VkGraphicsQueue);
 	vkGetDeviceQueue(m_VkDevice, Indices.PresentFamily.value(), 0, &m_VkPresentQueue);
+	vkGetDeviceQueue(m_VkDevice, Indices.getUploadFamily(), 0, &m_VkTransferQueue);
+
+	m_PacingMonitor.create(m_VkDevice, IsDisplayTimingSupported);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createMemoryAllocator()
+{
+	m_GpuAllocator.create(m_VkPhysicalDevice, m_VkDevice, static_cast<VkDeviceSize>(m_Config.GpuMemoryBlockSizeMB) * 1024 * 1024);
 }
 
 //******************************************************************************************
@@ -270,7 +749,8 @@ void CHelloTriangleApplication::__createSwapChain()
 	VkPresentModeKHR PresentMode = __chooseSwapPresentMode(SwapChainSupport.PresentModes);
 	VkExtent2D Extent = __chooseSwapExtent(SwapChainSupport.Capabilities);
 
-	uint32_t ImageCount = SwapChainSupport.Capabilities.minImageCount + 1;
+	uint32_t ImageCount = m_Config.SwapChainImageCount > 0 ? m_Config.SwapChainImageCount : SwapChainSupport.Capabilities.minImageCount + 1;
+	ImageCount = std::max(ImageCount, SwapChainSupport.Capabilities.minImageCount);
 	if (SwapChainSupport.Capabilities.maxImageCount > 0 && ImageCount > SwapChainSupport.Capabilities.maxImageCount)
 	{
 		ImageCount = SwapChainSupport.Capabilities.maxImageCount;
@@ -287,6 +767,10 @@ void CHelloTriangleApplication::__createSwapChain()
 	CreateInfo.imageArrayLayers = 1;
 	CreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+	//NOTE: captured frames are copied straight out of the swap chain images
+	m_IsSwapChainCopyable = (SwapChainSupport.Capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+	if (!m_Config.CaptureDirectory.empty() && m_IsSwapChainCopyable) CreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
 	SQueueFamilyIndices Indices = __findQueueFamilies(m_VkPhysicalDevice);
 	uint32_t QueueFamilyIndices[] = { Indices.GraphicsFamily.value(), Indices.PresentFamily.value() };
 
@@ -306,17 +790,54 @@ void CHelloTriangleApplication::__createSwapChain()
 	CreateInfo.presentMode = PresentMode;
 	CreateInfo.clipped = VK_TRUE;
 
-	CreateInfo.oldSwapchain = VK_NULL_HANDLE;
+	VkSwapchainKHR OldSwapChain = m_VkSwapChain;
+	CreateInfo.oldSwapchain = OldSwapChain;
 
 	if (vkCreateSwapchainKHR(m_VkDevice, &CreateInfo, nullptr, &m_VkSwapChain) != VK_SUCCESS)
 		throw std::runtime_error("failed to create swap chain!");
 
+	if (OldSwapChain != VK_NULL_HANDLE) vkDestroySwapchainKHR(m_VkDevice, OldSwapChain, nullptr);
+
 	vkGetSwapchainImagesKHR(m_VkDevice, m_VkSwapChain, &ImageCount, nullptr);
 	m_VkSwapChainImages.resize(ImageCount);
 	vkGetSwapchainImagesKHR(m_VkDevice, m_VkSwapChain, &ImageCount, m_VkSwapChainImages.data());
+	m_VkImagesInFlight.assign(ImageCount, VK_NULL_HANDLE);
 
 	m_VkSwapChainImageFormat = SurfaceFormat.format;
 	m_VkSwapChainExtent = Extent;
+	m_VkPresentMode = PresentMode;
+	m_PacingMonitor.setSwapChain(m_VkSwapChain);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createOffscreenTargets()
+{
+	m_VkSwapChainImageFormat = OFFSCREEN_IMAGE_FORMAT;
+	m_VkSwapChainExtent = { m_Config.Width, m_Config.Height };
+	m_IsSwapChainCopyable = true;
+
+	m_VkSwapChainImages.resize(m_Config.FramesInFlight);
+	m_OffscreenImageAllocations.resize(m_Config.FramesInFlight);
+	m_VkImagesInFlight.assign(m_VkSwapChainImages.size(), VK_NULL_HANDLE);
+
+	for (size_t i = 0; i < m_VkSwapChainImages.size(); ++i)
+	{
+		VkImageCreateInfo ImageInfo = {};
+		ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+		ImageInfo.format = m_VkSwapChainImageFormat;
+		ImageInfo.extent = { m_VkSwapChainExtent.width, m_VkSwapChainExtent.height, 1 };
+		ImageInfo.mipLevels = 1;
+		ImageInfo.arrayLayers = 1;
+		ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		ImageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		m_GpuAllocator.createImage(ImageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VkSwapChainImages[i], m_OffscreenImageAllocations[i]);
+	}
 }
 
 //******************************************************************************************
@@ -342,82 +863,845 @@ void CHelloTriangleApplication::__createImageViews()
 		CreateInfo.subresourceRange.baseArrayLayer = 0;
 		CreateInfo.subresourceRange.layerCount = 1;
 
-		if (vkCreateImageView(m_VkDevice, &CreateInfo, nullptr, &m_VkSwapChainImageViews[i]) != VK_SUCCESS)
-			throw std::runtime_error("failed to create image views!");
+		if (vkCreateImageView(m_VkDevice, &CreateInfo, nullptr, &m_VkSwapChainImageViews[i]) != VK_SUCCESS)
+			throw std::runtime_error("failed to create image views!");
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__selectDepthFormat()
+{
+	for (VkFormat Format : DEPTH_FORMAT_CANDIDATES)
+	{
+		VkFormatProperties FormatProperties;
+		vkGetPhysicalDeviceFormatProperties(m_VkPhysicalDevice, Format, &FormatProperties);
+		if (FormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+		{
+			m_VkDepthFormat = Format;
+			return;
+		}
+	}
+
+	throw std::runtime_error("failed to find a supported depth format!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createRenderPass()
+{
+	VkAttachmentDescription ColorAttachment = {};
+	ColorAttachment.format = m_VkSwapChainImageFormat;
+	ColorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	ColorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	ColorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	//NOTE: the render graph moves the attachments in and out of their attachment layouts, so the pass itself never changes them
+	ColorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	ColorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	//NOTE: depth is only needed inside the pass, so it is never loaded or stored
+	VkAttachmentDescription DepthAttachment = {};
+	DepthAttachment.format = m_VkDepthFormat;
+	DepthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	DepthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	DepthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	DepthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	DepthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference ColorAttachmentRef = {};
+	ColorAttachmentRef.attachment = 0;
+	ColorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference DepthAttachmentRef = {};
+	DepthAttachmentRef.attachment = 1;
+	DepthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription Subpass = {};
+	Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	Subpass.colorAttachmentCount = 1;
+	Subpass.pColorAttachments = &ColorAttachmentRef;
+	Subpass.pDepthStencilAttachment = &DepthAttachmentRef;
+
+	//NOTE: no external dependency, the barriers the render graph records around the pass already order it against earlier work
+
+	std::array<VkAttachmentDescription, 2> Attachments = { ColorAttachment, DepthAttachment };
+	VkRenderPassCreateInfo RenderPassInfo = {};
+	RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	RenderPassInfo.attachmentCount = static_cast<uint32_t>(Attachments.size());
+	RenderPassInfo.pAttachments = Attachments.data();
+	RenderPassInfo.subpassCount = 1;
+	RenderPassInfo.pSubpasses = &Subpass;
+
+	if (vkCreateRenderPass(m_VkDevice, &RenderPassInfo, nullptr, &m_VkRenderPass) != VK_SUCCESS)
+		throw std::runtime_error("failed to create render pass!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createPipelineCache()
+{
+	m_PipelineCache.create(m_VkPhysicalDevice, m_VkDevice, m_Config.PipelineCacheFile);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createDescriptorSetLayout()
+{
+	VkDescriptorSetLayoutBinding UniformBinding = {};
+	UniformBinding.binding = 0;
+	UniformBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	UniformBinding.descriptorCount = 1;
+	UniformBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	m_DescriptorSetBindings = { UniformBinding };
+	m_VkDescriptorSetLayout = m_DescriptorLayoutCache.getLayout(m_DescriptorSetBindings);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__selectVertexFormat()
+{
+	m_VertexFormat = m_Config.VertexFormat;
+	if (m_VertexFormat == EVertexFormat::Float32) return;
+
+	//NOTE: both packed layouts are in the spec's mandatory vertex format list, the query only guards against non-conformant drivers
+	for (VkFormat Format : { CVertexQuantizer::getPositionFormat(m_VertexFormat), CVertexQuantizer::getColorFormat(m_VertexFormat) })
+	{
+		VkFormatProperties FormatProperties;
+		vkGetPhysicalDeviceFormatProperties(m_VkPhysicalDevice, Format, &FormatProperties);
+		if (!(FormatProperties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT))
+		{
+			std::cerr << "vertex format " << VERTEX_FORMAT_NAMES[static_cast<int>(m_VertexFormat)] << " is not supported, falling back to float" << std::endl;
+			m_VertexFormat = EVertexFormat::Float32;
+			return;
+		}
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createGraphicsPipeline()
+{
+	auto StartTime = std::chrono::steady_clock::now();
+
+	VkPushConstantRange PushConstantRange = {};
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(SDrawConstants);
+
+	VkPipelineLayoutCreateInfo PipelineLayoutInfo = {};
+	PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	PipelineLayoutInfo.setLayoutCount = 1;
+	PipelineLayoutInfo.pSetLayouts = &m_VkDescriptorSetLayout;
+	PipelineLayoutInfo.pushConstantRangeCount = 1;
+	PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
+
+	if (vkCreatePipelineLayout(m_VkDevice, &PipelineLayoutInfo, nullptr, &m_VkPipelineLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline layout!");
+
+	m_pPipelineRegistry = std::make_unique<CPipelineRegistry>();
+	m_pPipelineRegistry->create(m_VkDevice, m_PipelineCache.getHandle(), __createPipelineProgram());
+	m_VkGraphicsPipeline = m_pPipelineRegistry->getPipeline(SPipelineStateDesc());
+
+	m_PipelineCreationTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+//******************************************************************************************
+//FUNCTION:
+SPipelineProgram CHelloTriangleApplication::__createPipelineProgram() const
+{
+	SPipelineProgram Program;
+	Program.VertShader = std::make_shared<CAsset>(m_AssetLoader.load("shaders/vert.spv"));
+	Program.FragShader = std::make_shared<CAsset>(m_AssetLoader.load("shaders/frag.spv"));
+
+	Program.BindingDescriptions = { CVertexQuantizer::getBindingDescription(m_VertexFormat, 0) };
+	auto InstanceBindingDescriptions = InstanceStreams::getBindingDescriptions();
+	Program.BindingDescriptions.insert(Program.BindingDescriptions.end(), InstanceBindingDescriptions.begin(), InstanceBindingDescriptions.end());
+
+	auto VertexAttributeDescriptions = CVertexQuantizer::getAttributeDescriptions(m_VertexFormat, 0, 0, 1);
+	auto InstanceAttributeDescriptions = InstanceStreams::getAttributeDescriptions();
+	Program.AttributeDescriptions.assign(VertexAttributeDescriptions.begin(), VertexAttributeDescriptions.end());
+	Program.AttributeDescriptions.insert(Program.AttributeDescriptions.end(), InstanceAttributeDescriptions.begin(), InstanceAttributeDescriptions.end());
+
+	Program.Layout = m_VkPipelineLayout;
+	Program.RenderPass = m_VkRenderPass;
+	Program.Subpass = 0;
+
+	return Program;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createFrameBuffers()
+{
+	m_VkSwapChainFramebuffers.resize(m_VkSwapChainImageViews.size());
+
+	for (size_t i = 0; i < m_VkSwapChainImageViews.size(); i++)
+	{
+		VkImageView attachments[] = { m_VkSwapChainImageViews[i], m_RenderGraph.getImageView(m_DepthTargetResource) };
+
+		VkFramebufferCreateInfo FramebufferInfo = {};
+		FramebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		FramebufferInfo.renderPass = m_VkRenderPass;
+		FramebufferInfo.attachmentCount = 2;
+		FramebufferInfo.pAttachments = attachments;
+		FramebufferInfo.width = m_VkSwapChainExtent.width;
+		FramebufferInfo.height = m_VkSwapChainExtent.height;
+		FramebufferInfo.layers = 1;
+
+		if (vkCreateFramebuffer(m_VkDevice, &FramebufferInfo, nullptr, &m_VkSwapChainFramebuffers[i]) != VK_SUCCESS)
+			throw std::runtime_error("failed to create framebuffer!");
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createCommandPool()
+{
+	SQueueFamilyIndices QueueFamilyIndices = __findQueueFamilies(m_VkPhysicalDevice);
+
+	VkCommandPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	PoolInfo.queueFamilyIndex = QueueFamilyIndices.GraphicsFamily.value();
+
+	if (vkCreateCommandPool(m_VkDevice, &PoolInfo, nullptr, &m_VkCommandPool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create command pool!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createMesh()
+{
+	//NOTE: the triangle is split into Density^2 smaller ones, emitted as a soup the way an unprocessed export would look
+	uint32_t Density = std::min(std::max(m_Config.MeshDensity, 1u), MAX_MESH_DENSITY);
+	auto makeVertex = [&](uint32_t vI, uint32_t vJ)
+	{
+		float WeightB = static_cast<float>(vI) / Density, WeightC = static_cast<float>(vJ) / Density, WeightA = static_cast<float>(Density - vI - vJ) / Density;
+		return Vertex{ WeightA * TRIANGLE_VERTICES[0].Pos + WeightB * TRIANGLE_VERTICES[1].Pos + WeightC * TRIANGLE_VERTICES[2].Pos,
+			WeightA * TRIANGLE_VERTICES[0].Color + WeightB * TRIANGLE_VERTICES[1].Color + WeightC * TRIANGLE_VERTICES[2].Color };
+	};
+
+	std::vector<std::array<Vertex, 3>> Triangles;
+	Triangles.reserve(static_cast<size_t>(Density) * Density);
+	for (uint32_t j = 0; j < Density; ++j)
+	{
+		for (uint32_t i = 0; i + j < Density; ++i)
+		{
+			Triangles.push_back({ { makeVertex(i, j), makeVertex(i + 1, j), makeVertex(i, j + 1) } });
+			if (i + j + 1 < Density) Triangles.push_back({ { makeVertex(i + 1, j), makeVertex(i + 1, j + 1), makeVertex(i, j + 1) } });
+		}
+	}
+
+	//NOTE: a fixed seed keeps the unoptimized order, and so the before statistics, reproducible between runs
+	std::shuffle(Triangles.begin(), Triangles.end(), std::mt19937(Density));
+
+	auto StartTime = std::chrono::steady_clock::now();
+
+	std::vector<char> Vertices(reinterpret_cast<const char*>(Triangles.data()), reinterpret_cast<const char*>(Triangles.data() + Triangles.size()));
+	std::vector<uint32_t> Indices;
+	CMeshOptimizer::generateIndexBuffer(Vertices, sizeof(Vertex), Indices);
+	m_MeshCacheStatisticsBefore = CMeshOptimizer::analyzeVertexCache(Indices, Vertices.size() / sizeof(Vertex), MESH_ANALYSIS_CACHE_SIZE);
+
+	if (m_Config.OptimizeMesh)
+	{
+		CMeshOptimizer::optimizeVertexCache(Indices, Vertices.size() / sizeof(Vertex));
+		CMeshOptimizer::optimizeVertexFetch(Vertices, sizeof(Vertex), Indices);
+	}
+	m_MeshCacheStatisticsAfter = CMeshOptimizer::analyzeVertexCache(Indices, Vertices.size() / sizeof(Vertex), MESH_ANALYSIS_CACHE_SIZE);
+
+	m_MeshOptimizeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	m_MeshVertexCount = static_cast<uint32_t>(Vertices.size() / sizeof(Vertex));
+	m_MeshIndexCount = static_cast<uint32_t>(Indices.size());
+
+	//NOTE: quantization runs last, so deduplication and reordering above never merge vertices that only became equal after rounding
+	StartTime = std::chrono::steady_clock::now();
+	std::vector<char> PackedVertices(static_cast<size_t>(m_MeshVertexCount) * CVertexQuantizer::getStride(m_VertexFormat));
+	CVertexQuantizer::quantize(m_VertexFormat, reinterpret_cast<const float*>(Vertices.data()), m_MeshVertexCount, PackedVertices.data());
+	m_MeshQuantizeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+
+	__createDeviceLocalBuffer(PackedVertices.data(), PackedVertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_VkVertexBuffer, m_VertexBufferAllocation);
+
+	//NOTE: 16-bit indices halve the index fetch bandwidth whenever the mesh is small enough to allow them
+	if (m_MeshVertexCount <= 0x10000)
+	{
+		std::vector<uint16_t> ShortIndices(Indices.begin(), Indices.end());
+		m_VkIndexType = VK_INDEX_TYPE_UINT16;
+		__createDeviceLocalBuffer(ShortIndices.data(), sizeof(uint16_t) * ShortIndices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_VkIndexBuffer, m_IndexBufferAllocation);
+	}
+	else
+	{
+		m_VkIndexType = VK_INDEX_TYPE_UINT32;
+		__createDeviceLocalBuffer(Indices.data(), sizeof(uint32_t) * Indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_VkIndexBuffer, m_IndexBufferAllocation);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createGpuCuller()
+{
+	if (!m_IsGpuCullingSupported)
+	{
+		if (m_Config.CullingMode == ECullingMode::Gpu)
+		{
+			std::cerr << "gpu culling needs multiDrawIndirect and drawIndirectFirstInstance, falling back to cpu culling" << std::endl;
+			m_Config.CullingMode = ECullingMode::Cpu;
+		}
+		return;
+	}
+
+	m_GpuCuller.create(m_VkPhysicalDevice, m_VkDevice, &m_GpuAllocator, &m_DescriptorLayoutCache, m_PipelineCache.getHandle(), m_AssetLoader.load("shaders/cullObjects.spv"), m_Config.FramesInFlight, m_IsDrawIndirectCountSupported);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__buildRenderGraph()
+{
+	m_RenderGraph.reset();
+
+	//NOTE: headless targets end the frame ready to be copied out instead of presented
+	m_ColorTargetResource = m_RenderGraph.importImage("color", m_VkSwapChainImages, VK_IMAGE_ASPECT_COLOR_BIT, m_Config.Headless ? ERenderResourceUsage::TransferRead : ERenderResourceUsage::Present);
+
+	bool HasStencil = m_VkDepthFormat == VK_FORMAT_D24_UNORM_S8_UINT || m_VkDepthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT;
+	STransientImageDesc DepthDesc;
+	DepthDesc.Format = m_VkDepthFormat;
+	DepthDesc.Extent = m_VkSwapChainExtent;
+	DepthDesc.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	DepthDesc.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT | (HasStencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+	m_DepthTargetResource = m_RenderGraph.createTransientImage("depth", DepthDesc);
+
+	//NOTE: the cull pass is declared whenever the culler exists, the graph drops it again unless the scene pass draws from its output
+	uint32_t IndirectResource = 0, CountResource = 0;
+	if (m_GpuCuller.isCreated())
+	{
+		std::vector<VkBuffer> IndirectBuffers, CountBuffers;
+		for (uint32_t i = 0; i < m_Config.FramesInFlight; ++i)
+		{
+			IndirectBuffers.push_back(m_GpuCuller.getIndirectBuffer(i));
+			CountBuffers.push_back(m_GpuCuller.getCountBuffer(i));
+		}
+		IndirectResource = m_RenderGraph.importBuffer("cull_commands", IndirectBuffers);
+		CountResource = m_RenderGraph.importBuffer("cull_count", CountBuffers);
+
+		uint32_t CullPass = m_RenderGraph.addPass("cull", [this](VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex) { __recordCullPass(vCommandBuffer, vFrame); });
+		m_RenderGraph.writeResource(CullPass, IndirectResource, ERenderResourceUsage::ComputeShaderWrite);
+		m_RenderGraph.writeResource(CullPass, CountResource, ERenderResourceUsage::ComputeShaderWrite);
+	}
+
+	uint32_t ScenePass = m_RenderGraph.addPass("scene", [this](VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex) { __recordScenePass(vCommandBuffer, vFrame, vImageIndex); });
+	m_RenderGraph.writeResource(ScenePass, m_ColorTargetResource, ERenderResourceUsage::ColorAttachmentWrite);
+	m_RenderGraph.writeResource(ScenePass, m_DepthTargetResource, ERenderResourceUsage::DepthAttachmentWrite);
+	if (m_Config.CullingMode == ECullingMode::Gpu && m_GpuCuller.isCreated())
+	{
+		m_RenderGraph.readResource(ScenePass, IndirectResource, ERenderResourceUsage::IndirectRead);
+		if (m_GpuCuller.isUsingDrawIndirectCount()) m_RenderGraph.readResource(ScenePass, CountResource, ERenderResourceUsage::IndirectRead);
+	}
+
+	//NOTE: nothing in the graph reads what the readback writes, so it has to be kept alive explicitly; frames that capture nothing leave the pass out and skip its layout transitions
+	m_IsReadbackPassDeclared = __isCaptureFrame();
+	if (m_IsReadbackPassDeclared)
+	{
+		uint32_t ReadbackPass = m_RenderGraph.addPass("readback", [this](VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex) { __recordReadbackPass(vCommandBuffer, vFrame, vImageIndex); });
+		m_RenderGraph.readResource(ReadbackPass, m_ColorTargetResource, ERenderResourceUsage::TransferRead);
+		m_RenderGraph.markPassAsOutput(ReadbackPass);
+	}
+
+	m_RenderGraph.compile();
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CHelloTriangleApplication::__isCaptureFrame() const
+{
+	return m_FrameCapture.isCreated() && m_FrameNumber % std::max(m_Config.CaptureInterval, 1u) == 0;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createFrameCapture()
+{
+	if (m_Config.CaptureDirectory.empty()) return;
+
+	if (!m_IsSwapChainCopyable)
+	{
+		std::cerr << "frame capture disabled, the swap chain images cannot be copied from" << std::endl;
+		return;
+	}
+
+	//NOTE: every encoder can hold a slot while every frame in flight still has its copy pending
+	uint32_t ThreadCount = m_Config.CaptureThreadCount > 0 ? m_Config.CaptureThreadCount : std::max(1u, std::thread::hardware_concurrency() / 2);
+	m_FrameCapture.create(m_VkDevice, &m_GpuAllocator, m_Config.CaptureDirectory, m_Config.CaptureFileFormat, m_Config.FramesInFlight + ThreadCount, ThreadCount, m_Config.CaptureBlocking);
+
+	if (!m_FrameCapture.setTarget(m_VkSwapChainExtent, m_VkSwapChainImageFormat))
+	{
+		std::cerr << "frame capture disabled, the swap chain format cannot be captured" << std::endl;
+		m_FrameCapture.destroy();
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createStreamingUploader()
+{
+	if (!m_Config.StreamInstanceColors) return;
+
+	//NOTE: the staging ring grows to the streamed data once the instance buffer is created
+	SQueueFamilyIndices Indices = __findQueueFamilies(m_VkPhysicalDevice);
+	m_StreamingUploader.create(m_VkDevice, &m_GpuAllocator, m_VkTransferQueue, Indices.getUploadFamily(), Indices.GraphicsFamily.value(), m_Config.FramesInFlight, MIN_STREAMING_STAGING_SIZE);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createInstanceBuffer(uint32_t vInstanceCount)
+{
+	//NOTE: the caller must make sure no submitted frame still reads the previous instance buffers
+	if (m_VkInstanceBuffer != VK_NULL_HANDLE) m_GpuAllocator.destroyBuffer(m_VkInstanceBuffer, m_InstanceBufferAllocation);
+	if (m_VkInstanceBoundsBuffer != VK_NULL_HANDLE) m_GpuAllocator.destroyBuffer(m_VkInstanceBoundsBuffer, m_InstanceBoundsAllocation);
+	if (m_VkInstanceDepthBuffer != VK_NULL_HANDLE) m_GpuAllocator.destroyBuffer(m_VkInstanceDepthBuffer, m_InstanceDepthAllocation);
+
+	m_InstanceCount = std::max(vInstanceCount, 1u);
+	if (m_GpuCuller.isCreated()) m_InstanceCount = std::min(m_InstanceCount, m_GpuCuller.getMaxObjectCount());
+
+	//NOTE: instances are laid out on a square grid spanning the scene extent, a single instance in a unit scene reproduces the original triangle
+	//NOTE: extra depth layers repeat the grid slightly shifted, layer 0 is the farthest so drawing in instance order goes back to front
+	uint32_t LayerCount = std::min(std::max(m_Config.DepthLayerCount, 1u), m_InstanceCount);
+	uint32_t LayerInstanceCount = (m_InstanceCount + LayerCount - 1) / LayerCount;
+	uint32_t GridSide = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(LayerInstanceCount))));
+	float CellSize = 2.0f * m_Config.SceneExtent / GridSide;
+
+	//NOTE: streamed colors get one slot per frame in flight, a frame only ever overwrites the slot its own previous use read from
+	uint32_t ColorSlotCount = m_StreamingUploader.isCreated() ? m_Config.FramesInFlight : 1;
+
+	std::vector<glm::vec3> InstanceData(static_cast<size_t>(m_InstanceCount) * (1 + ColorSlotCount));
+	glm::vec3* pTransforms = InstanceData.data();
+	glm::vec3* pColors = InstanceData.data() + m_InstanceCount;
+
+	m_InstanceBounds.resize(m_InstanceCount);
+	m_InstanceDepths.resize(m_InstanceCount);
+
+	for (uint32_t i = 0; i < m_InstanceCount; ++i)
+	{
+		uint32_t Layer = i / LayerInstanceCount, Cell = i % LayerInstanceCount;
+		float LayerShift = CellSize * 0.5f * Layer / LayerCount;
+		pTransforms[i] = glm::vec3(-m_Config.SceneExtent + CellSize * (Cell % GridSide + 0.5f) + LayerShift, -m_Config.SceneExtent + CellSize * (Cell / GridSide + 0.5f) + LayerShift, CellSize * 0.5f);
+		m_InstanceDepths[i] = 1.0f - (Layer + 0.5f) / LayerCount;
+		m_InstanceBounds[i] = glm::vec4(pTransforms[i].x, pTransforms[i].y, pTransforms[i].z * TRIANGLE_BOUNDING_RADIUS, 0.0f);
+
+		float Hash = static_cast<float>(i) * 0.618034f;
+		pColors[i] = glm::vec3(1.0f) - 0.6f * glm::vec3(Hash - std::floor(Hash), Hash * 1.3f - std::floor(Hash * 1.3f), Hash * 1.7f - std::floor(Hash * 1.7f));
+	}
+
+	m_InstanceColorOffset = sizeof(glm::vec3) * m_InstanceCount;
+	m_InstanceColorSlotSize = 0;
+	if (m_StreamingUploader.isCreated())
+	{
+		m_InstanceColors.assign(pColors, pColors + m_InstanceCount);
+		for (uint32_t i = 1; i < ColorSlotCount; ++i) std::copy(pColors, pColors + m_InstanceCount, pColors + static_cast<size_t>(i) * m_InstanceCount);
+
+		m_InstanceColorSlotSize = sizeof(glm::vec3) * m_InstanceCount;
+		m_StreamingUploader.ensureCapacity(m_InstanceColorSlotSize);
+	}
+	__createDeviceLocalBuffer(InstanceData.data(), sizeof(glm::vec3) * InstanceData.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_VkInstanceBuffer, m_InstanceBufferAllocation);
+	__createDeviceLocalBuffer(m_InstanceBounds.data(), sizeof(glm::vec4) * m_InstanceBounds.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, m_VkInstanceBoundsBuffer, m_InstanceBoundsAllocation);
+	__createDeviceLocalBuffer(m_InstanceDepths.data(), sizeof(float) * m_InstanceDepths.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_VkInstanceDepthBuffer, m_InstanceDepthAllocation);
+
+	if (m_GpuCuller.isCreated()) m_GpuCuller.setObjects(m_VkInstanceBoundsBuffer, m_InstanceCount);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__streamInstanceColors(uint32_t vFrame)
+{
+	//NOTE: stands in for continuous geometry streaming, the whole color stream is regenerated and uploaded every frame
+	float Phase = static_cast<float>(std::fmod(0.05 * static_cast<double>(m_StreamedFrameCount++), 2.0 * 3.14159265358979));
+
+	m_StreamedColors.resize(m_InstanceColors.size());
+	for (size_t i = 0; i < m_InstanceColors.size(); ++i)
+		m_StreamedColors[i] = m_InstanceColors[i] * (0.75f + 0.25f * std::sin(Phase + 0.01f * static_cast<float>(i % 1024)));
+
+	m_StreamingUploader.upload(m_VkInstanceBuffer, m_InstanceColorOffset + vFrame * m_InstanceColorSlotSize, m_StreamedColors.data(), m_InstanceColorSlotSize,
+		VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createDeviceLocalBuffer(const void* vData, VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkBuffer& voBuffer, SGpuAllocation& voAllocation)
+{
+	VkBuffer StagingBuffer;
+	SGpuAllocation StagingAllocation;
+	m_GpuAllocator.createBuffer(vSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingAllocation);
+
+	memcpy(StagingAllocation.pMappedData, vData, static_cast<size_t>(vSize));
+
+	m_GpuAllocator.createBuffer(vSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | vUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, voBuffer, voAllocation);
+
+	__copyBuffer(StagingBuffer, voBuffer, vSize);
+
+	m_GpuAllocator.destroyBuffer(StagingBuffer, StagingAllocation);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createDrawList()
+{
+	//NOTE: the instances are split evenly over the draw items, so one draw item means a single instanced call
+	uint32_t DrawCount = std::min(std::max(m_Config.DrawCount, 1u), m_InstanceCount);
+	m_DrawItems.resize(DrawCount);
+
+	for (uint32_t i = 0; i < DrawCount; ++i)
+	{
+		m_DrawItems[i].IndexCount = m_MeshIndexCount;
+		m_DrawItems[i].FirstIndex = 0;
+		m_DrawItems[i].VertexOffset = 0;
+		m_DrawItems[i].FirstInstance = static_cast<uint32_t>(static_cast<uint64_t>(i) * m_InstanceCount / DrawCount);
+		m_DrawItems[i].InstanceCount = static_cast<uint32_t>(static_cast<uint64_t>(i + 1) * m_InstanceCount / DrawCount) - m_DrawItems[i].FirstInstance;
+
+		auto FirstDepth = m_InstanceDepths.begin() + m_DrawItems[i].FirstInstance;
+		auto DepthRange = std::minmax_element(FirstDepth, FirstDepth + m_DrawItems[i].InstanceCount);
+		m_DrawItems[i].NearDepth = *DepthRange.first;
+		m_DrawItems[i].FarDepth = *DepthRange.second;
+	}
+
+	__sortDrawItems();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createFrameUploadRing()
+{
+	m_FrameUploadRing.create(m_VkPhysicalDevice, &m_GpuAllocator, m_Config.FramesInFlight, FRAME_UPLOAD_RING_BYTES_PER_FRAME);
+	m_FrameUniformOffsets.assign(m_Config.FramesInFlight, 0);
+	m_VkFrameDescriptorSets.assign(m_Config.FramesInFlight, VK_NULL_HANDLE);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__updateFrameUniforms(uint32_t vFrame)
+{
+	m_FrameUploadRing.beginFrame(vFrame);
+
+	//NOTE: the pulse only ever shrinks an instance, so it never leaves the bounds it is culled against
+	SFrameUniforms Uniforms = {};
+	Uniforms.ColorTint = glm::vec4(1.0f);
+	//NOTE: captures advance by a fixed step per frame, so a run renders the same frames however fast it goes
+	double Seconds = m_FrameCapture.isCreated() ? m_FrameNumber / CAPTURE_FRAME_RATE : std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+	Uniforms.Time = static_cast<float>(std::fmod(Seconds, 1000.0 * 3.14159265358979));
+	Uniforms.PulseAmplitude = std::min(std::max(m_Config.PulseAmplitude, 0.0f), 1.0f);
+
+	m_FrameUniformOffsets[vFrame] = m_FrameUploadRing.push(Uniforms);
+
+	//NOTE: per-frame sets are never freed one by one, the frame's pools are reset together once its fence has signaled
+	m_DescriptorAllocator.resetFrame(vFrame);
+	m_VkFrameDescriptorSets[vFrame] = m_DescriptorAllocator.allocate(vFrame, m_VkDescriptorSetLayout, m_DescriptorSetBindings);
+
+	VkDescriptorBufferInfo BufferInfo = {};
+	BufferInfo.buffer = m_FrameUploadRing.getBuffer();
+	BufferInfo.offset = 0;
+	BufferInfo.range = sizeof(SFrameUniforms);
+
+	VkWriteDescriptorSet DescriptorWrite = {};
+	DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	DescriptorWrite.dstSet = m_VkFrameDescriptorSets[vFrame];
+	DescriptorWrite.dstBinding = 0;
+	DescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	DescriptorWrite.descriptorCount = 1;
+	DescriptorWrite.pBufferInfo = &BufferInfo;
+
+	vkUpdateDescriptorSets(m_VkDevice, 1, &DescriptorWrite, 0, nullptr);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__cullObjectsOnCpu()
+{
+	//NOTE: the classic cpu path, one draw per visible object, whose recording cost grows with the object count
+	m_DrawItems.clear();
+
+	SDrawItem ObjectDraw;
+	ObjectDraw.IndexCount = m_MeshIndexCount;
+	ObjectDraw.InstanceCount = 1;
+
+	for (uint32_t i = 0; i < m_InstanceCount; ++i)
+	{
+		const glm::vec4& Bounds = m_InstanceBounds[i];
+		if (std::abs(Bounds.x) - Bounds.z > 1.0f || std::abs(Bounds.y) - Bounds.z > 1.0f) continue;
+
+		ObjectDraw.FirstInstance = i;
+		ObjectDraw.NearDepth = ObjectDraw.FarDepth = m_InstanceDepths[i];
+		m_DrawItems.push_back(ObjectDraw);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__sortDrawItems()
+{
+	if (m_Config.DrawSortOrder == EDrawSortOrder::None || m_DrawItems.size() < 2) return;
+
+	auto StartTime = std::chrono::steady_clock::now();
+
+	//NOTE: every draw shares one pipeline and one material for now, so only the depth bits differ; back to front negates the depth of the farthest instance
+	bool IsFrontToBack = m_Config.DrawSortOrder == EDrawSortOrder::FrontToBack;
+	m_DrawSortKeys.resize(m_DrawItems.size());
+	for (size_t i = 0; i < m_DrawItems.size(); ++i) m_DrawSortKeys[i] = CDrawSorter::makeSortKey(0, IsFrontToBack ? m_DrawItems[i].NearDepth : -m_DrawItems[i].FarDepth, 0);
+
+	m_DrawSorter.sort(m_DrawSortKeys);
+
+	const auto& Order = m_DrawSorter.getOrder();
+	m_SortedDrawItems.resize(m_DrawItems.size());
+	for (size_t i = 0; i < Order.size(); ++i) m_SortedDrawItems[i] = m_DrawItems[Order[i]];
+	m_DrawItems.swap(m_SortedDrawItems);
+
+	m_FrameStatistics.recordEvent("draw_sort", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__setCullingMode(ECullingMode vMode)
+{
+	if (vMode == ECullingMode::Gpu && !m_GpuCuller.isCreated()) vMode = ECullingMode::Cpu;
+
+	m_Config.CullingMode = vMode;
+	if (vMode == ECullingMode::None) __createDrawList();
+
+	//NOTE: the mode decides whether the cull pass survives, and a new instance buffer comes with new cull buffers to import
+	__buildRenderGraph();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__copyBuffer(VkBuffer vSrcBuffer, VkBuffer vDstBuffer, VkDeviceSize vSize)
+{
+	VkCommandBuffer CommandBuffer = __beginSingleTimeCommands();
+
+	VkBufferCopy CopyRegion = {};
+	CopyRegion.srcOffset = 0;
+	CopyRegion.dstOffset = 0;
+	CopyRegion.size = vSize;
+	vkCmdCopyBuffer(CommandBuffer, vSrcBuffer, vDstBuffer, 1, &CopyRegion);
+
+	__endSingleTimeCommands(CommandBuffer);
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkCommandBuffer CHelloTriangleApplication::__beginSingleTimeCommands()
+{
+	VkCommandBufferAllocateInfo AllocInfo = {};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	AllocInfo.commandPool = m_VkCommandPool;
+	AllocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer CommandBuffer;
+	if (vkAllocateCommandBuffers(m_VkDevice, &AllocInfo, &CommandBuffer) != VK_SUCCESS)
+		throw std::runtime_error("failed to allocate single time command buffer!");
+
+	VkCommandBufferBeginInfo BeginInfo = {};
+	BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+
+	return CommandBuffer;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__endSingleTimeCommands(VkCommandBuffer vCommandBuffer)
+{
+	vkEndCommandBuffer(vCommandBuffer);
+
+	VkSubmitInfo SubmitInfo = {};
+	SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	SubmitInfo.commandBufferCount = 1;
+	SubmitInfo.pCommandBuffers = &vCommandBuffer;
+
+	if (vkQueueSubmit(m_VkGraphicsQueue, 1, &SubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		throw std::runtime_error("failed to submit single time command buffer!");
+	vkQueueWaitIdle(m_VkGraphicsQueue);
+
+	vkFreeCommandBuffers(m_VkDevice, m_VkCommandPool, 1, &vCommandBuffer);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createGpuProfiler()
+{
+	SQueueFamilyIndices QueueFamilyIndices = __findQueueFamilies(m_VkPhysicalDevice);
+	m_GpuProfiler.create(m_VkPhysicalDevice, m_VkDevice, QueueFamilyIndices.GraphicsFamily.value(), m_Config.FramesInFlight, MAX_GPU_SCOPES_PER_FRAME);
+	m_OverdrawCounter.create(m_VkDevice, m_IsOverdrawQuerySupported, m_Config.FramesInFlight);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createCommandBuffers()
+{
+	SQueueFamilyIndices QueueFamilyIndices = __findQueueFamilies(m_VkPhysicalDevice);
+	m_CommandRecorder.create(m_VkDevice, QueueFamilyIndices.GraphicsFamily.value(), __getRecordThreadCount(), m_Config.FramesInFlight);
+
+	m_VkFrameCommandPools.resize(m_Config.FramesInFlight);
+	m_VkCommandBuffers.resize(m_Config.FramesInFlight);
+
+	//NOTE: every frame in flight owns a transient pool, so one vkResetCommandPool recycles all of its memory instead of resetting buffer by buffer
+	VkCommandPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	PoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	PoolInfo.queueFamilyIndex = QueueFamilyIndices.GraphicsFamily.value();
+
+	for (size_t i = 0; i < m_Config.FramesInFlight; ++i)
+	{
+		if (vkCreateCommandPool(m_VkDevice, &PoolInfo, nullptr, &m_VkFrameCommandPools[i]) != VK_SUCCESS)
+			throw std::runtime_error("failed to create frame command pool!");
+
+		VkCommandBufferAllocateInfo AllocInfo = {};
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = m_VkFrameCommandPools[i];
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		AllocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers(m_VkDevice, &AllocInfo, &m_VkCommandBuffers[i]) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate command buffers!");
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__recordCommandBuffer(uint32_t vFrame, uint32_t vImageIndex)
+{
+	//NOTE: only called once the frame's fence has signaled, so nothing recorded from these pools is still pending
+	vkResetCommandPool(m_VkDevice, m_VkFrameCommandPools[vFrame], 0);
+	m_CommandRecorder.resetFrame(vFrame);
+
+	VkCommandBuffer CommandBuffer = m_VkCommandBuffers[vFrame];
+
+	VkCommandBufferBeginInfo BeginInfo = {};
+	BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(CommandBuffer, &BeginInfo) != VK_SUCCESS)
+		throw std::runtime_error("failed to begin recording command buffer!");
+
+	m_GpuProfiler.resetSlot(CommandBuffer, vFrame);
+	m_OverdrawCounter.resetSlot(CommandBuffer, vFrame);
+	__updateFrameUniforms(vFrame);
+	if (m_StreamingUploader.isCreated()) m_StreamingUploader.recordAcquireBarriers(CommandBuffer, vFrame);
+
+	if (m_Config.CullingMode == ECullingMode::Cpu)
+	{
+		__cullObjectsOnCpu();
+		__sortDrawItems();
 	}
+
+	//NOTE: the readback pass comes after every transient use, so redeclaring it only rebuilds passes and barriers while the transient images stay as they are
+	if (__isCaptureFrame() != m_IsReadbackPassDeclared) __buildRenderGraph();
+	m_RenderGraph.execute(CommandBuffer, vFrame, vImageIndex);
+
+	if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
+		throw std::runtime_error("failed to record command buffer!");
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createRenderPass()
+void CHelloTriangleApplication::__recordCullPass(VkCommandBuffer vCommandBuffer, uint32_t vFrame)
 {
-	VkAttachmentDescription ColorAttachment = {};
-	ColorAttachment.format = m_VkSwapChainImageFormat;
-	ColorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	ColorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	ColorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	ColorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	ColorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	uint32_t CullScope = m_GpuProfiler.beginScope(vCommandBuffer, vFrame, "cull");
+	m_GpuCuller.recordCulling(vCommandBuffer, vFrame, m_MeshIndexCount);
+	m_GpuProfiler.endScope(vCommandBuffer, vFrame, CullScope);
+}
 
-	VkAttachmentReference ColorAttachmentRef = {};
-	ColorAttachmentRef.attachment = 0;
-	ColorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__recordScenePass(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex)
+{
+	uint32_t RenderPassScope = m_GpuProfiler.beginScope(vCommandBuffer, vFrame, "render_pass");
 
-	VkSubpassDescription Subpass = {};
-	Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	Subpass.colorAttachmentCount = 1;
-	Subpass.pColorAttachments = &ColorAttachmentRef;
+	VkRenderPassBeginInfo RenderPassInfo = {};
+	RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	RenderPassInfo.renderPass = m_VkRenderPass;
+	RenderPassInfo.framebuffer = m_VkSwapChainFramebuffers[vImageIndex];
+	RenderPassInfo.renderArea.offset = { 0, 0 };
+	RenderPassInfo.renderArea.extent = m_VkSwapChainExtent;
 
-	VkRenderPassCreateInfo RenderPassInfo = {};
-	RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	RenderPassInfo.attachmentCount = 1;
-	RenderPassInfo.pAttachments = &ColorAttachment;
-	RenderPassInfo.subpassCount = 1;
-	RenderPassInfo.pSubpasses = &Subpass;
+	std::array<VkClearValue, 2> ClearValues = {};
+	ClearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+	ClearValues[1].depthStencil = { 1.0f, 0 };
+	RenderPassInfo.clearValueCount = static_cast<uint32_t>(ClearValues.size());
+	RenderPassInfo.pClearValues = ClearValues.data();
 
-	if (vkCreateRenderPass(m_VkDevice, &RenderPassInfo, nullptr, &m_VkRenderPass) != VK_SUCCESS)
-		throw std::runtime_error("failed to create render pass!");
+	m_OverdrawCounter.begin(vCommandBuffer, vFrame);
+
+	//NOTE: with gpu culling the whole scene is a single indirect draw, which is not worth a secondary command buffer; it also stays in instance order, so it is never sorted
+	if (m_Config.CullingMode == ECullingMode::Gpu)
+	{
+		vkCmdBeginRenderPass(vCommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		__bindDrawState(vCommandBuffer, vFrame);
+		m_GpuCuller.recordDraw(vCommandBuffer, vFrame);
+	}
+	else
+	{
+		vkCmdBeginRenderPass(vCommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		VkCommandBufferInheritanceInfo InheritanceInfo = {};
+		InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		InheritanceInfo.renderPass = m_VkRenderPass;
+		InheritanceInfo.subpass = 0;
+		InheritanceInfo.framebuffer = m_VkSwapChainFramebuffers[vImageIndex];
+		InheritanceInfo.pipelineStatistics = m_OverdrawCounter.getStatisticFlags();
+
+		std::vector<VkCommandBuffer> SecondaryCommandBuffers;
+		m_CommandRecorder.record(vFrame, InheritanceInfo, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, m_DrawItems.size(),
+			[this, vFrame](VkCommandBuffer vSecondaryCommandBuffer, size_t vFirstItem, size_t vEndItem) { __recordDrawRange(vSecondaryCommandBuffer, vFrame, vFirstItem, vEndItem); }, SecondaryCommandBuffers);
+
+		vkCmdExecuteCommands(vCommandBuffer, static_cast<uint32_t>(SecondaryCommandBuffers.size()), SecondaryCommandBuffers.data());
+	}
+
+	vkCmdEndRenderPass(vCommandBuffer);
+
+	m_OverdrawCounter.end(vCommandBuffer, vFrame);
+	m_GpuProfiler.endScope(vCommandBuffer, vFrame, RenderPassScope);
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createGraphicsPipeline()
+void CHelloTriangleApplication::__recordReadbackPass(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex)
 {
-	auto VertShaderCode = __readFile("shaders/vert.spv");
-	auto FragShaderCode = __readFile("shaders/frag.spv");
-
-	VkShaderModule VertShaderModule = __createShaderModule(VertShaderCode);
-	VkShaderModule FragShaderModule = __createShaderModule(FragShaderCode);
+	uint32_t ReadbackScope = m_GpuProfiler.beginScope(vCommandBuffer, vFrame, "readback");
+	m_FrameCapture.recordReadback(vCommandBuffer, vFrame, m_VkSwapChainImages[vImageIndex], m_FrameNumber);
+	m_GpuProfiler.endScope(vCommandBuffer, vFrame, ReadbackScope);
+}
 
-	VkPipelineShaderStageCreateInfo VertShaderStageInfo = {};
-	VertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	VertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	VertShaderStageInfo.module = VertShaderModule;
-	VertShaderStageInfo.pName = "main";
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__recordDrawRange(VkCommandBuffer vCommandBuffer, uint32_t vFrame, size_t vFirstItem, size_t vEndItem) const
+{
+	//NOTE: secondary command buffers inherit no state from the primary, so every range sets up its own
+	__bindDrawState(vCommandBuffer, vFrame);
 
-	VkPipelineShaderStageCreateInfo FragShaderStageInfo = {};
-	FragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	FragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	FragShaderStageInfo.module = FragShaderModule;
-	FragShaderStageInfo.pName = "main";
+	for (size_t i = vFirstItem; i < vEndItem; ++i)
+	{
+		const SDrawItem& Item = m_DrawItems[i];
 
-	VkPipelineShaderStageCreateInfo ShaderStages[] = { VertShaderStageInfo, FragShaderStageInfo };
+		//NOTE: tinting every draw differently shows how culling and parallel recording split the scene
+		if (m_Config.TintDraws)
+		{
+			float Hash = static_cast<float>(i) * 0.618034f;
+			SDrawConstants DrawConstants = { glm::vec4(0.4f + 0.6f * (Hash - std::floor(Hash)), 0.4f + 0.6f * (Hash * 2.3f - std::floor(Hash * 2.3f)), 0.4f + 0.6f * (Hash * 3.7f - std::floor(Hash * 3.7f)), 1.0f) };
+			vkCmdPushConstants(vCommandBuffer, m_VkPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SDrawConstants), &DrawConstants);
+		}
 
-	auto BindingDescription = Vertex::getBindingDescription();
-	auto AttributeDescriptions = Vertex::getAttributeDescriptions();
-	VkPipelineVertexInputStateCreateInfo VertexInputInfo = {};
-	VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	VertexInputInfo.vertexBindingDescriptionCount = 1;
-	VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(AttributeDescriptions.size());
-	VertexInputInfo.pVertexBindingDescriptions = &BindingDescription;
-	VertexInputInfo.pVertexAttributeDescriptions = AttributeDescriptions.data();
+		vkCmdDrawIndexed(vCommandBuffer, Item.IndexCount, Item.InstanceCount, Item.FirstIndex, Item.VertexOffset, Item.FirstInstance);
+	}
+}
 
-	VkPipelineInputAssemblyStateCreateInfo InputAssembly = {};
-	InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	InputAssembly.primitiveRestartEnable = VK_FALSE;
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__bindDrawState(VkCommandBuffer vCommandBuffer, uint32_t vFrame) const
+{
+	vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_VkGraphicsPipeline);
 
 	VkViewport Viewport = {};
 	Viewport.x = 0.0f;
@@ -426,264 +1710,598 @@ void CHelloTriangleApplication::__createGraphicsPipeline()
 	Viewport.height = (float)m_VkSwapChainExtent.height;
 	Viewport.minDepth = 0.0f;
 	Viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(vCommandBuffer, 0, 1, &Viewport);
 
 	VkRect2D Scissor = {};
 	Scissor.offset = { 0, 0 };
 	Scissor.extent = m_VkSwapChainExtent;
+	vkCmdSetScissor(vCommandBuffer, 0, 1, &Scissor);
 
-	VkPipelineViewportStateCreateInfo ViewportState = {};
-	ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	ViewportState.viewportCount = 1;
-	ViewportState.pViewports = &Viewport;
-	ViewportState.scissorCount = 1;
-	ViewportState.pScissors = &Scissor;
-
-	VkPipelineRasterizationStateCreateInfo Rasterizer = {};
-	Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	Rasterizer.depthClampEnable = VK_FALSE;
-	Rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	Rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	Rasterizer.lineWidth = 1.0f;
-	Rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-	Rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-	Rasterizer.depthBiasEnable = VK_FALSE;
-
-	VkPipelineMultisampleStateCreateInfo Multisampling = {};
-	Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	Multisampling.sampleShadingEnable = VK_FALSE;
-	Multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-	VkPipelineColorBlendAttachmentState ColorBlendAttachment = {};
-	ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	ColorBlendAttachment.blendEnable = VK_FALSE;
-
-	VkPipelineColorBlendStateCreateInfo ColorBlending = {};
-	ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	ColorBlending.logicOpEnable = VK_FALSE;
-	ColorBlending.logicOp = VK_LOGIC_OP_COPY;
-	ColorBlending.attachmentCount = 1;
-	ColorBlending.pAttachments = &ColorBlendAttachment;
-	ColorBlending.blendConstants[0] = 0.0f;
-	ColorBlending.blendConstants[1] = 0.0f;
-	ColorBlending.blendConstants[2] = 0.0f;
-	ColorBlending.blendConstants[3] = 0.0f;
+	VkBuffer VertexBuffers[] = { m_VkVertexBuffer, m_VkInstanceBuffer, m_VkInstanceBuffer, m_VkInstanceDepthBuffer };
+	VkDeviceSize Offsets[] = { 0, 0, m_InstanceColorOffset + vFrame * m_InstanceColorSlotSize, 0 };
+	vkCmdBindVertexBuffers(vCommandBuffer, 0, 4, VertexBuffers, Offsets);
+	vkCmdBindIndexBuffer(vCommandBuffer, m_VkIndexBuffer, 0, m_VkIndexType);
+	vkCmdBindDescriptorSets(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_VkPipelineLayout, 0, 1, &m_VkFrameDescriptorSets[vFrame], 1, &m_FrameUniformOffsets[vFrame]);
 
-	VkPipelineLayoutCreateInfo PipelineLayoutInfo = {};
-	PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	PipelineLayoutInfo.setLayoutCount = 0;
-	PipelineLayoutInfo.pushConstantRangeCount = 0;
+	SDrawConstants DrawConstants = { glm::vec4(1.0f) };
+	vkCmdPushConstants(vCommandBuffer, m_VkPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SDrawConstants), &DrawConstants);
+}
 
-	if (vkCreatePipelineLayout(m_VkDevice, &PipelineLayoutInfo, nullptr, &m_VkPipelineLayout) != VK_SUCCESS)
-		throw std::runtime_error("failed to create pipeline layout!");
+//******************************************************************************************
+//FUNCTION:
+uint32_t CHelloTriangleApplication::__getRecordThreadCount() const
+{
+	if (m_Config.RecordThreadCount > 0) return m_Config.RecordThreadCount;
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__createSyncObjects()
+{
+	m_VkImageAvailableSemaphores.resize(m_Config.FramesInFlight);
+	m_VkRenderFinishedSemaphores.resize(m_Config.FramesInFlight);
+	m_VkInFlightFences.resize(m_Config.FramesInFlight);
+	m_FrameInputTimes.assign(m_Config.FramesInFlight, std::nullopt);
 
-	VkGraphicsPipelineCreateInfo pipelineInfo = {};
-	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = ShaderStages;
-	pipelineInfo.pVertexInputState = &VertexInputInfo;
-	pipelineInfo.pInputAssemblyState = &InputAssembly;
-	pipelineInfo.pViewportState = &ViewportState;
-	pipelineInfo.pRasterizationState = &Rasterizer;
-	pipelineInfo.pMultisampleState = &Multisampling;
-	pipelineInfo.pColorBlendState = &ColorBlending;
-	pipelineInfo.layout = m_VkPipelineLayout;
-	pipelineInfo.renderPass = m_VkRenderPass;
-	pipelineInfo.subpass = 0;
-	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	VkSemaphoreCreateInfo SemaphoreInfo = {};
+	SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	if (vkCreateGraphicsPipelines(m_VkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_VkGraphicsPipeline) != VK_SUCCESS)
-		throw std::runtime_error("failed to create graphics pipeline!");
+	VkFenceCreateInfo FenceInfo = {};
+	FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	FenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-	vkDestroyShaderModule(m_VkDevice, FragShaderModule, nullptr);
-	vkDestroyShaderModule(m_VkDevice, VertShaderModule, nullptr);
+	for (size_t i = 0; i < m_Config.FramesInFlight; i++)
+	{
+		if (vkCreateSemaphore(m_VkDevice, &SemaphoreInfo, nullptr, &m_VkImageAvailableSemaphores[i]) != VK_SUCCESS ||
+			vkCreateSemaphore(m_VkDevice, &SemaphoreInfo, nullptr, &m_VkRenderFinishedSemaphores[i]) != VK_SUCCESS ||
+			vkCreateFence(m_VkDevice, &FenceInfo, nullptr, &m_VkInFlightFences[i]) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create synchronization objects for a frame!");
+		}
+	}
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createFrameBuffers()
+void CHelloTriangleApplication::__mainLoop()
 {
-	m_VkSwapChainFramebuffers.resize(m_VkSwapChainImageViews.size());
+	const bool IsBenchmark = m_Config.BenchmarkFrames > 0;
 
-	for (size_t i = 0; i < m_VkSwapChainImageViews.size(); i++)
+	uint32_t FrameCount = m_Config.FrameCount;
+	if (IsBenchmark)
+		FrameCount = m_Config.BenchmarkWarmupFrames + m_Config.BenchmarkFrames;
+	else if (m_Config.Headless && 0 == FrameCount)
+		FrameCount = DEFAULT_HEADLESS_FRAME_COUNT;
+
+	for (uint32_t i = 0; 0 == FrameCount || i < FrameCount; ++i)
 	{
-		VkImageView attachments[] = { m_VkSwapChainImageViews[i] };
+		if (!m_Config.Headless)
+		{
+			if (glfwWindowShouldClose(m_pGLFWWindow)) break;
+			glfwPollEvents();
+		}
 
-		VkFramebufferCreateInfo FramebufferInfo = {};
-		FramebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		FramebufferInfo.renderPass = m_VkRenderPass;
-		FramebufferInfo.attachmentCount = 1;
-		FramebufferInfo.pAttachments = attachments;
-		FramebufferInfo.width = m_VkSwapChainExtent.width;
-		FramebufferInfo.height = m_VkSwapChainExtent.height;
-		FramebufferInfo.layers = 1;
+		if (IsBenchmark && i == m_Config.BenchmarkWarmupFrames)
+		{
+			m_FrameStatistics.reset();
+			m_PacingMonitor.reset();
+		}
 
-		if (vkCreateFramebuffer(m_VkDevice, &FramebufferInfo, nullptr, &m_VkSwapChainFramebuffers[i]) != VK_SUCCESS)
-			throw std::runtime_error("failed to create framebuffer!");
+		__drawFrame();
+	}
+
+	vkDeviceWaitIdle(m_VkDevice);
+
+	if (m_FrameCapture.isCreated())
+	{
+		m_FrameCapture.flush();
+		if (!m_Config.CaptureReferenceDirectory.empty()) m_IsCaptureMismatched = !m_FrameCapture.compareWithReference(m_Config.CaptureReferenceDirectory);
 	}
+
+	if (IsBenchmark) __reportBenchmark();
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createCommandPool()
+void CHelloTriangleApplication::__reportBenchmark()
 {
-	SQueueFamilyIndices QueueFamilyIndices = __findQueueFamilies(m_VkPhysicalDevice);
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
 
-	VkCommandPoolCreateInfo PoolInfo = {};
-	PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	PoolInfo.queueFamilyIndex = QueueFamilyIndices.GraphicsFamily.value();
+	m_FrameStatistics.setMetadata("device", Properties.deviceName);
+	m_FrameStatistics.setMetadata("mode", m_Config.Headless ? "headless" : "windowed");
+	m_FrameStatistics.setMetadata("extent", std::to_string(m_VkSwapChainExtent.width) + "x" + std::to_string(m_VkSwapChainExtent.height));
+	m_FrameStatistics.setMetadata("warmup_frames", std::to_string(m_Config.BenchmarkWarmupFrames));
+	m_FrameStatistics.setMetadataJson("frames_in_flight", std::to_string(m_Config.FramesInFlight));
+	m_FrameStatistics.setMetadataJson("swapchain_images", std::to_string(m_VkSwapChainImages.size()));
 
-	if (vkCreateCommandPool(m_VkDevice, &PoolInfo, nullptr, &m_VkCommandPool) != VK_SUCCESS)
-		throw std::runtime_error("failed to create command pool!");
+	if (!m_Config.Headless)
+	{
+		m_FrameStatistics.setMetadata("present_mode", __getPresentModeName(m_VkPresentMode));
+
+		std::ostringstream PresentPacing;
+		m_PacingMonitor.dumpJson(PresentPacing);
+		m_FrameStatistics.setMetadataJson("present_pacing", PresentPacing.str());
+	}
+
+	m_FrameStatistics.setMetadataJson("pipeline_create_ms", std::to_string(m_PipelineCreationTime));
+	m_FrameStatistics.setMetadataJson("pipeline_cache_loaded", m_PipelineCache.isLoadedFromDisk() ? "true" : "false");
+
+	std::ostringstream AssetStatistics;
+	m_AssetLoader.dumpStatisticsJson(AssetStatistics);
+	m_FrameStatistics.setMetadataJson("assets", AssetStatistics.str());
+
+	std::ostringstream PipelineStatistics;
+	m_pPipelineRegistry->dumpStatisticsJson(PipelineStatistics);
+	m_FrameStatistics.setMetadataJson("pipeline_registry", PipelineStatistics.str());
+
+	std::ostringstream RenderGraphStatistics;
+	m_RenderGraph.dumpStatisticsJson(RenderGraphStatistics);
+	m_FrameStatistics.setMetadataJson("render_graph", RenderGraphStatistics.str());
+
+	if (m_FrameCapture.isCreated())
+	{
+		std::ostringstream CaptureStatistics;
+		m_FrameCapture.dumpStatisticsJson(CaptureStatistics);
+		m_FrameStatistics.setMetadataJson("capture", CaptureStatistics.str());
+	}
+
+	if (m_ShaderReloader.isStarted())
+	{
+		std::ostringstream ShaderReloadStatistics;
+		m_ShaderReloader.dumpStatisticsJson(ShaderReloadStatistics);
+		m_FrameStatistics.setMetadataJson("shader_hot_reload", ShaderReloadStatistics.str());
+	}
+
+	m_FrameStatistics.setMetadataJson("record_threads", std::to_string(m_CommandRecorder.getThreadCount()));
+	m_FrameStatistics.setMetadataJson("draw_count", std::to_string(m_DrawItems.size()));
+	m_FrameStatistics.setMetadataJson("instance_count", std::to_string(m_InstanceCount));
+
+	std::ostringstream MeshStatistics;
+	MeshStatistics << "{ \"vertices\": " << m_MeshVertexCount << ", \"triangles\": " << m_MeshIndexCount / 3 << ", \"index_bits\": " << (m_VkIndexType == VK_INDEX_TYPE_UINT16 ? 16 : 32)
+		<< ", \"optimized\": " << (m_Config.OptimizeMesh ? "true" : "false") << ", \"optimize_ms\": " << m_MeshOptimizeTime
+		<< ", \"acmr_before\": " << m_MeshCacheStatisticsBefore.Acmr << ", \"acmr_after\": " << m_MeshCacheStatisticsAfter.Acmr
+		<< ", \"atvr_before\": " << m_MeshCacheStatisticsBefore.Atvr << ", \"atvr_after\": " << m_MeshCacheStatisticsAfter.Atvr
+		<< ", \"vertex_format\": \"" << VERTEX_FORMAT_NAMES[static_cast<int>(m_VertexFormat)] << "\", \"vertex_bytes\": " << CVertexQuantizer::getStride(m_VertexFormat)
+		<< ", \"quantize_ms\": " << m_MeshQuantizeTime << ", \"quantize_simd\": \"" << CVertexQuantizer::getSimdPathName() << "\" }";
+	m_FrameStatistics.setMetadataJson("mesh", MeshStatistics.str());
+	m_FrameStatistics.setMetadata("culling", CULLING_MODE_NAMES[static_cast<int>(m_Config.CullingMode)]);
+
+	std::ostringstream DepthStatistics;
+	DepthStatistics << "{ \"format\": \"" << __getDepthFormatName(m_VkDepthFormat) << "\", \"layers\": " << std::min(std::max(m_Config.DepthLayerCount, 1u), m_InstanceCount)
+		<< ", \"draw_sort\": \"" << DRAW_SORT_ORDER_NAMES[static_cast<int>(m_Config.DrawSortOrder)] << "\", \"overdraw_query\": " << (m_OverdrawCounter.isSupported() ? "true" : "false") << " }";
+	m_FrameStatistics.setMetadataJson("depth", DepthStatistics.str());
+
+	if (m_StreamingUploader.isCreated())
+	{
+		SQueueFamilyIndices Indices = __findQueueFamilies(m_VkPhysicalDevice);
+		m_FrameStatistics.setMetadata("upload_queue", Indices.TransferFamily.has_value() ? "transfer" : (Indices.ComputeFamily.has_value() ? "compute" : "graphics"));
+		m_FrameStatistics.setMetadataJson("streamed_bytes_per_frame", std::to_string(m_InstanceColorSlotSize));
+	}
+
+	std::ostringstream MemoryStatistics;
+	m_GpuAllocator.dumpStatisticsJson(MemoryStatistics);
+	m_FrameStatistics.setMetadataJson("gpu_memory", MemoryStatistics.str());
+
+	std::ostringstream UploadRingStatistics;
+	m_FrameUploadRing.dumpStatisticsJson(UploadRingStatistics);
+	m_FrameStatistics.setMetadataJson("frame_upload_ring", UploadRingStatistics.str());
+
+	std::ostringstream DescriptorStatistics;
+	DescriptorStatistics << "{ \"layout_cache\": ";
+	m_DescriptorLayoutCache.dumpStatisticsJson(DescriptorStatistics);
+	DescriptorStatistics << ", \"allocator\": ";
+	m_DescriptorAllocator.dumpStatisticsJson(DescriptorStatistics);
+	DescriptorStatistics << " }";
+	m_FrameStatistics.setMetadataJson("descriptors", DescriptorStatistics.str());
+
+	std::ostringstream Json;
+	m_FrameStatistics.dumpJson(Json);
+	__writeBenchmarkOutput(Json.str());
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createVertexBuffer()
+void CHelloTriangleApplication::__runRecordBenchmark()
 {
-	VkBufferCreateInfo BufferInfo = {};
-	BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	BufferInfo.size = sizeof(TRIANGLE_VERTICES[0]) * TRIANGLE_VERTICES.size();
-	BufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-	BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
+
+	std::vector<uint32_t> ThreadCounts;
+	uint32_t MaxThreadCount = __getRecordThreadCount();
+	for (uint32_t ThreadCount = 1; ThreadCount < MaxThreadCount; ThreadCount *= 2) ThreadCounts.push_back(ThreadCount);
+	ThreadCounts.push_back(MaxThreadCount);
+
+	SQueueFamilyIndices QueueFamilyIndices = __findQueueFamilies(m_VkPhysicalDevice);
+	std::vector<CParallelCommandRecorder> Recorders(ThreadCounts.size());
+	for (size_t i = 0; i < ThreadCounts.size(); ++i)
+		Recorders[i].create(m_VkDevice, QueueFamilyIndices.GraphicsFamily.value(), ThreadCounts[i], 1);
+
+	//NOTE: a null framebuffer is allowed in the inheritance info, it only loses the driver a chance to specialize
+	VkCommandBufferInheritanceInfo InheritanceInfo = {};
+	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	InheritanceInfo.renderPass = m_VkRenderPass;
+	InheritanceInfo.subpass = 0;
+	InheritanceInfo.framebuffer = VK_NULL_HANDLE;
+
+	//NOTE: nothing is submitted, but the recorded draws still bind frame 0's uniform offset and descriptor set
+	__updateFrameUniforms(0);
+	auto RecordRange = [this](VkCommandBuffer vCommandBuffer, size_t vFirstItem, size_t vEndItem) { __recordDrawRange(vCommandBuffer, 0, vFirstItem, vEndItem); };
+
+	std::ostringstream Json;
+	Json << "{\n  \"device\": " << CFrameStatistics::escapeJson(Properties.deviceName) << ",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+		<< ",\n  \"iterations\": " << RECORD_BENCHMARK_ITERATIONS << ",\n  \"results\": [";
+
+	std::vector<SDrawItem> SceneDrawItems = m_DrawItems;
+	for (size_t DrawCountIndex = 0; DrawCountIndex < RECORD_BENCHMARK_DRAW_COUNTS.size(); ++DrawCountIndex)
+	{
+		m_DrawItems.assign(RECORD_BENCHMARK_DRAW_COUNTS[DrawCountIndex], SceneDrawItems.front());
+
+		double SingleThreadTime = 0.0;
+		for (size_t i = 0; i < Recorders.size(); ++i)
+		{
+			std::vector<VkCommandBuffer> SecondaryCommandBuffers;
+			std::vector<double> RecordTimes;
+
+			//NOTE: the first pass only grows the worker pools, so it is not sampled
+			for (uint32_t Iteration = 0; Iteration <= RECORD_BENCHMARK_ITERATIONS; ++Iteration)
+			{
+				Recorders[i].resetFrame(0);
+
+				auto StartTime = std::chrono::steady_clock::now();
+				Recorders[i].record(0, InheritanceInfo, 0, m_DrawItems.size(), RecordRange, SecondaryCommandBuffers);
+				double RecordTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+
+				if (Iteration > 0) RecordTimes.push_back(RecordTime);
+			}
 
-	if (vkCreateBuffer(m_VkDevice, &BufferInfo, nullptr, &m_VkVertexBuffer) != VK_SUCCESS)
-		throw std::runtime_error("failed to create vertex buffer!");
+			SStatisticSummary Summary = CFrameStatistics::computeSummary(RecordTimes);
+			if (0 == i) SingleThreadTime = Summary.P50;
+
+			Json << ((DrawCountIndex > 0 || i > 0) ? ",\n    { " : "\n    { ") << "\"draws\": " << m_DrawItems.size() << ", \"threads\": " << ThreadCounts[i]
+				<< ", \"secondaries\": " << SecondaryCommandBuffers.size() << ", \"speedup\": " << (Summary.P50 > 0.0 ? SingleThreadTime / Summary.P50 : 0.0) << ", \"record_ms\": ";
+			CFrameStatistics::dumpSummaryJson(Json, Summary);
+			Json << " }";
+		}
+	}
+	Json << "\n  ]\n}\n";
+
+	m_DrawItems = SceneDrawItems;
+	for (auto& Recorder : Recorders) Recorder.destroy();
+
+	__writeBenchmarkOutput(Json.str());
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createCommandBuffers()
+void CHelloTriangleApplication::__runStressTest()
 {
-	m_VkCommandBuffers.resize(m_VkSwapChainFramebuffers.size());
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
 
-	VkCommandBufferAllocateInfo AllocInfo = {};
-	AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	AllocInfo.commandPool = m_VkCommandPool;
-	AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	AllocInfo.commandBufferCount = (uint32_t)m_VkCommandBuffers.size();
+	std::ostringstream Json;
+	Json << "{\n  \"device\": " << CFrameStatistics::escapeJson(Properties.deviceName) << ",\n  \"extent\": \"" << m_VkSwapChainExtent.width << "x" << m_VkSwapChainExtent.height
+		<< "\",\n  \"frames_per_step\": " << STRESS_FRAMES_PER_STEP << ",\n  \"frame_budget_ms\": " << STRESS_FRAME_BUDGET_MS << ",\n  \"steps\": [";
+
+	//NOTE: the instance count doubles every step until the median frame no longer fits the budget, the last step marks the throughput ceiling
+	uint32_t InstanceCount = std::min(STRESS_START_INSTANCES, m_Config.StressMaxInstances);
+	for (size_t Step = 0; ; ++Step)
+	{
+		vkDeviceWaitIdle(m_VkDevice);
+		__createInstanceBuffer(InstanceCount);
+		__setCullingMode(m_Config.CullingMode);
 
-	if (vkAllocateCommandBuffers(m_VkDevice, &AllocInfo, m_VkCommandBuffers.data()) != VK_SUCCESS)
-		throw std::runtime_error("failed to allocate command buffers!");
+		if (!__measureFrames(STRESS_WARMUP_FRAMES_PER_STEP, STRESS_FRAMES_PER_STEP)) break;
 
-	for (size_t i = 0; i < m_VkCommandBuffers.size(); i++) {
-		VkCommandBufferBeginInfo BeginInfo = {};
-		BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+		SStatisticSummary FrameTime = m_FrameStatistics.getFrameTimeSummary();
+		SStatisticSummary GpuTime;
+		bool HasGpuTime = m_FrameStatistics.getGpuScopeSummary("render_pass", GpuTime);
 
-		if (vkBeginCommandBuffer(m_VkCommandBuffers[i], &BeginInfo) != VK_SUCCESS)
-			throw std::runtime_error("failed to begin recording command buffer!");
+		Json << (Step > 0 ? ",\n    { " : "\n    { ") << "\"instances\": " << m_InstanceCount << ", \"draws\": " << m_DrawItems.size()
+			<< ", \"instances_per_second\": " << (FrameTime.P50 > 0.0 ? m_InstanceCount * 1000.0 / FrameTime.P50 : 0.0) << ", \"frame_ms\": ";
+		CFrameStatistics::dumpSummaryJson(Json, FrameTime);
+		if (HasGpuTime)
+		{
+			Json << ", \"gpu_render_pass_ms\": ";
+			CFrameStatistics::dumpSummaryJson(Json, GpuTime);
+		}
+		Json << " }";
+
+		if (FrameTime.P50 > STRESS_FRAME_BUDGET_MS || InstanceCount >= m_Config.StressMaxInstances) break;
+		InstanceCount = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(InstanceCount) * 2, m_Config.StressMaxInstances));
+	}
+	Json << "\n  ]\n}\n";
 
-		VkRenderPassBeginInfo RenderPassInfo = {};
-		RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		RenderPassInfo.renderPass = m_VkRenderPass;
-		RenderPassInfo.framebuffer = m_VkSwapChainFramebuffers[i];
-		RenderPassInfo.renderArea.offset = { 0, 0 };
-		RenderPassInfo.renderArea.extent = m_VkSwapChainExtent;
+	vkDeviceWaitIdle(m_VkDevice);
 
-		VkClearValue ClearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-		RenderPassInfo.clearValueCount = 1;
-		RenderPassInfo.pClearValues = &ClearColor;
+	__writeBenchmarkOutput(Json.str());
+}
 
-		vkCmdBeginRenderPass(m_VkCommandBuffers[i], &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__runCullingBenchmark()
+{
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
 
-		vkCmdBindPipeline(m_VkCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_VkGraphicsPipeline);
+	std::vector<ECullingMode> Modes = { ECullingMode::Cpu };
+	if (m_GpuCuller.isCreated()) Modes.push_back(ECullingMode::Gpu);
 
-		vkCmdDraw(m_VkCommandBuffers[i], 3, 1, 0, 0);
+	std::ostringstream Json;
+	Json << "{\n  \"device\": " << CFrameStatistics::escapeJson(Properties.deviceName) << ",\n  \"scene_extent\": " << m_Config.SceneExtent
+		<< ",\n  \"draw_indirect_count\": " << (m_GpuCuller.isUsingDrawIndirectCount() ? "true" : "false") << ",\n  \"results\": [";
 
-		vkCmdEndRenderPass(m_VkCommandBuffers[i]);
+	bool IsFirstResult = true, IsWindowClosed = false;
+	for (uint32_t ObjectCount : CULLING_BENCHMARK_OBJECT_COUNTS)
+	{
+		vkDeviceWaitIdle(m_VkDevice);
+		__createInstanceBuffer(ObjectCount);
 
-		if (vkEndCommandBuffer(m_VkCommandBuffers[i]) != VK_SUCCESS)
-			throw std::runtime_error("failed to record command buffer!");
+		for (ECullingMode Mode : Modes)
+		{
+			__setCullingMode(Mode);
+			if (!__measureFrames(CULLING_BENCHMARK_WARMUP_FRAMES, CULLING_BENCHMARK_FRAMES)) { IsWindowClosed = true; break; }
+
+			Json << (IsFirstResult ? "\n    { " : ",\n    { ") << "\"objects\": " << m_InstanceCount << ", \"culling\": \"" << CULLING_MODE_NAMES[static_cast<int>(Mode)] << "\", \"frame_ms\": ";
+			CFrameStatistics::dumpSummaryJson(Json, m_FrameStatistics.getFrameTimeSummary());
+			Json << ", \"record_ms\": ";
+			CFrameStatistics::dumpSummaryJson(Json, m_FrameStatistics.getPhaseSummary(EFramePhase::Record));
+
+			for (const char* pScopeName : { "cull", "render_pass" })
+			{
+				SStatisticSummary GpuTime;
+				if (!m_FrameStatistics.getGpuScopeSummary(pScopeName, GpuTime)) continue;
+
+				Json << ", \"gpu_" << pScopeName << "_ms\": ";
+				CFrameStatistics::dumpSummaryJson(Json, GpuTime);
+			}
+			Json << " }";
+			IsFirstResult = false;
+		}
+		if (IsWindowClosed) break;
 	}
+	Json << "\n  ]\n}\n";
+
+	vkDeviceWaitIdle(m_VkDevice);
+
+	__writeBenchmarkOutput(Json.str());
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__createSyncObjects()
+void CHelloTriangleApplication::__runPipelineBenchmark()
 {
-	m_VkImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	m_VkRenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	m_VkInFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
 
-	VkSemaphoreCreateInfo SemaphoreInfo = {};
-	SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	size_t CombinationCount = PIPELINE_BENCHMARK_TOPOLOGIES.size() * PIPELINE_BENCHMARK_CULL_MODES.size() * PIPELINE_BENCHMARK_FRONT_FACES.size() * PIPELINE_BENCHMARK_BLEND_MODES.size() * 2;
+	size_t VariantCount = std::min<size_t>(std::max(m_Config.PipelineBenchmarkVariants, 1u), CombinationCount);
+	if (VariantCount < m_Config.PipelineBenchmarkVariants)
+		std::cerr << "only " << CombinationCount << " distinct pipeline variants exist, benchmarking all of them" << std::endl;
 
-	VkFenceCreateInfo FenceInfo = {};
-	FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	FenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	std::vector<SPipelineStateDesc> Variants(VariantCount);
+	for (size_t i = 0; i < VariantCount; ++i)
+	{
+		size_t Index = i;
+		Variants[i].Topology = PIPELINE_BENCHMARK_TOPOLOGIES[Index % PIPELINE_BENCHMARK_TOPOLOGIES.size()]; Index /= PIPELINE_BENCHMARK_TOPOLOGIES.size();
+		Variants[i].CullMode = PIPELINE_BENCHMARK_CULL_MODES[Index % PIPELINE_BENCHMARK_CULL_MODES.size()]; Index /= PIPELINE_BENCHMARK_CULL_MODES.size();
+		Variants[i].FrontFace = PIPELINE_BENCHMARK_FRONT_FACES[Index % PIPELINE_BENCHMARK_FRONT_FACES.size()]; Index /= PIPELINE_BENCHMARK_FRONT_FACES.size();
+		Variants[i].BlendMode = PIPELINE_BENCHMARK_BLEND_MODES[Index % PIPELINE_BENCHMARK_BLEND_MODES.size()]; Index /= PIPELINE_BENCHMARK_BLEND_MODES.size();
+		Variants[i].AlphaToCoverage = (Index % 2) != 0;
+	}
+
+	SPipelineProgram Program = __createPipelineProgram();
+	CThreadPool ThreadPool(__getRecordThreadCount());
+
+	//NOTE: neither pass gets a pipeline cache, otherwise the parallel pass would mostly measure cache hits from the serial one
+	CPipelineRegistry SerialRegistry;
+	SerialRegistry.create(m_VkDevice, VK_NULL_HANDLE, Program);
+	auto StartTime = std::chrono::steady_clock::now();
+	for (const auto& Variant : Variants) SerialRegistry.getPipeline(Variant);
+	double SerialTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	SerialRegistry.destroy();
+
+	CPipelineRegistry ParallelRegistry;
+	ParallelRegistry.create(m_VkDevice, VK_NULL_HANDLE, Program);
+	StartTime = std::chrono::steady_clock::now();
+	ParallelRegistry.compileVariants(Variants, ThreadPool);
+	double ParallelTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+
+	StartTime = std::chrono::steady_clock::now();
+	for (const auto& Variant : Variants) ParallelRegistry.getPipeline(Variant);
+	double LookupTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - StartTime).count();
+	ParallelRegistry.destroy();
+
+	std::ostringstream Json;
+	Json << "{\n  \"device\": " << CFrameStatistics::escapeJson(Properties.deviceName) << ",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+		<< ",\n  \"threads\": " << ThreadPool.getThreadCount() << ",\n  \"variants\": " << VariantCount
+		<< ",\n  \"startup_pipeline_create_ms\": " << m_PipelineCreationTime
+		<< ",\n  \"serial_ms\": " << SerialTime << ",\n  \"parallel_ms\": " << ParallelTime
+		<< ",\n  \"speedup\": " << (ParallelTime > 0.0 ? SerialTime / ParallelTime : 0.0)
+		<< ",\n  \"serial_ms_per_variant\": " << SerialTime / VariantCount << ",\n  \"parallel_ms_per_variant\": " << ParallelTime / VariantCount
+		<< ",\n  \"lookup_us_per_variant\": " << LookupTime / VariantCount << "\n}\n";
+
+	__writeBenchmarkOutput(Json.str());
+}
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+//******************************************************************************************
+//FUNCTION:
+void CHelloTriangleApplication::__runOverdrawBenchmark()
+{
+	VkPhysicalDeviceProperties Properties;
+	vkGetPhysicalDeviceProperties(m_VkPhysicalDevice, &Properties);
+
+	if (!m_OverdrawCounter.isSupported())
+		std::cerr << "pipeline statistics queries are not supported, reporting gpu times only" << std::endl;
+
+	//NOTE: gpu culling draws in instance order, so the benchmark falls back to the unculled draw list
+	ECullingMode CullingMode = m_Config.CullingMode == ECullingMode::Gpu ? ECullingMode::None : m_Config.CullingMode;
+	__setCullingMode(CullingMode);
+	if (m_DrawItems.size() < std::min(std::max(m_Config.DepthLayerCount, 1u), m_InstanceCount))
+		std::cerr << "fewer draws than depth layers, sorting can only reorder whole draws" << std::endl;
+
+	std::ostringstream Json;
+	Json << "{\n  \"device\": " << CFrameStatistics::escapeJson(Properties.deviceName) << ",\n  \"extent\": \"" << m_VkSwapChainExtent.width << "x" << m_VkSwapChainExtent.height
+		<< "\",\n  \"depth_format\": \"" << __getDepthFormatName(m_VkDepthFormat) << "\",\n  \"instances\": " << m_InstanceCount
+		<< ",\n  \"depth_layers\": " << std::min(std::max(m_Config.DepthLayerCount, 1u), m_InstanceCount) << ",\n  \"culling\": \"" << CULLING_MODE_NAMES[static_cast<int>(CullingMode)]
+		<< "\",\n  \"results\": [";
+
+	VkPipeline DefaultPipeline = m_VkGraphicsPipeline;
+	EDrawSortOrder DefaultSortOrder = m_Config.DrawSortOrder;
+	double BaselineFragmentCount = 0.0;
+
+	bool IsFirstResult = true;
+	for (const auto& Case : OVERDRAW_BENCHMARK_CASES)
 	{
-		if (vkCreateSemaphore(m_VkDevice, &SemaphoreInfo, nullptr, &m_VkImageAvailableSemaphores[i]) != VK_SUCCESS ||
-			vkCreateSemaphore(m_VkDevice, &SemaphoreInfo, nullptr, &m_VkRenderFinishedSemaphores[i]) != VK_SUCCESS ||
-			vkCreateFence(m_VkDevice, &FenceInfo, nullptr, &m_VkInFlightFences[i]) != VK_SUCCESS)
+		SPipelineStateDesc State;
+		State.DepthTest = Case.DepthTest;
+		State.DepthWrite = Case.DepthTest;
+		m_VkGraphicsPipeline = m_pPipelineRegistry->getPipeline(State);
+		m_Config.DrawSortOrder = Case.SortOrder;
+		__setCullingMode(CullingMode);
+
+		if (!__measureFrames(OVERDRAW_BENCHMARK_WARMUP_FRAMES, OVERDRAW_BENCHMARK_FRAMES)) break;
+
+		Json << (IsFirstResult ? "\n    { " : ",\n    { ") << "\"case\": \"" << Case.pName << "\", \"draws\": " << m_DrawItems.size() << ", \"frame_ms\": ";
+		CFrameStatistics::dumpSummaryJson(Json, m_FrameStatistics.getFrameTimeSummary());
+
+		SStatisticSummary Summary;
+		if (m_FrameStatistics.getGpuScopeSummary("render_pass", Summary))
 		{
-			throw std::runtime_error("failed to create synchronization objects for a frame!");
+			Json << ", \"gpu_render_pass_ms\": ";
+			CFrameStatistics::dumpSummaryJson(Json, Summary);
+		}
+		if (m_FrameStatistics.getCounterSummary("overdraw", Summary))
+		{
+			Json << ", \"overdraw\": ";
+			CFrameStatistics::dumpSummaryJson(Json, Summary);
+		}
+		if (m_FrameStatistics.getCounterSummary("fragments", Summary))
+		{
+			//NOTE: the first case shades every rasterized fragment, so it is the reference for the work the depth test saves
+			if (IsFirstResult) BaselineFragmentCount = Summary.P50;
+			Json << ", \"fragments_p50\": " << Summary.P50 << ", \"fragments_saved\": " << (BaselineFragmentCount > 0.0 ? 1.0 - Summary.P50 / BaselineFragmentCount : 0.0);
 		}
+		Json << " }";
+		IsFirstResult = false;
 	}
+	Json << "\n  ]\n}\n";
+
+	vkDeviceWaitIdle(m_VkDevice);
+	m_VkGraphicsPipeline = DefaultPipeline;
+	m_Config.DrawSortOrder = DefaultSortOrder;
+
+	__writeBenchmarkOutput(Json.str());
 }
 
 //******************************************************************************************
 //FUNCTION:
-VkShaderModule CHelloTriangleApplication::__createShaderModule(const std::vector<char>& vCode)
+bool CHelloTriangleApplication::__measureFrames(uint32_t vWarmupFrames, uint32_t vFrames)
 {
-	VkShaderModuleCreateInfo CreateInfo = {};
-	CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	CreateInfo.codeSize = vCode.size();
-	CreateInfo.pCode = reinterpret_cast<const uint32_t*>(vCode.data());
+	for (uint32_t i = 0; i < vWarmupFrames + vFrames; ++i)
+	{
+		if (!m_Config.Headless)
+		{
+			if (glfwWindowShouldClose(m_pGLFWWindow)) return false;
+			glfwPollEvents();
+		}
+
+		if (i == vWarmupFrames)
+		{
+			m_FrameStatistics.reset();
+			m_PacingMonitor.reset();
+		}
 
-	VkShaderModule ShaderModule;
-	if (vkCreateShaderModule(m_VkDevice, &CreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
-		throw std::runtime_error("failed to create shader module!");
+		__drawFrame();
+	}
 
-	return ShaderModule;
+	return true;
 }
 
 //******************************************************************************************
 //FUNCTION:
-void CHelloTriangleApplication::__mainLoop()
+void CHelloTriangleApplication::__writeBenchmarkOutput(const std::string& vJson) const
 {
-	while (!glfwWindowShouldClose(m_pGLFWWindow))
+	if (m_Config.BenchmarkOutputFile.empty())
 	{
-		glfwPollEvents();
-		__drawFrame();
+		std::cout << vJson;
+		return;
 	}
 
-	vkDeviceWaitIdle(m_VkDevice);
+	std::ofstream File(m_Config.BenchmarkOutputFile);
+	if (!File.is_open())
+		throw std::runtime_error("failed to open benchmark output file!");
+
+	File << vJson;
 }
 
 //******************************************************************************************
 //FUNCTION:
 void CHelloTriangleApplication::__cleanup()
 {
-	for (auto i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+	for (size_t i = 0; i < m_VkInFlightFences.size(); ++i)
 	{
 		vkDestroySemaphore(m_VkDevice, m_VkRenderFinishedSemaphores[i], nullptr);
 		vkDestroySemaphore(m_VkDevice, m_VkImageAvailableSemaphores[i], nullptr);
 		vkDestroyFence(m_VkDevice, m_VkInFlightFences[i], nullptr);
 	}
 
-	vkDestroyBuffer(m_VkDevice, m_VkVertexBuffer, nullptr);
+	__cleanupSwapChain();
+
+	for (auto CommandPool : m_VkFrameCommandPools) vkDestroyCommandPool(m_VkDevice, CommandPool, nullptr);
+	m_VkCommandBuffers.clear();
+	m_CommandRecorder.destroy();
+	m_GpuProfiler.destroy();
+	m_OverdrawCounter.destroy();
+
+	m_RenderGraph.destroy();
+	m_FrameCapture.destroy();
+	m_GpuCuller.destroy();
+	m_StreamingUploader.destroy();
+	m_FrameUploadRing.destroy();
+	m_DescriptorAllocator.destroy();
+	m_GpuAllocator.destroyBuffer(m_VkInstanceDepthBuffer, m_InstanceDepthAllocation);
+	m_GpuAllocator.destroyBuffer(m_VkInstanceBoundsBuffer, m_InstanceBoundsAllocation);
+	m_GpuAllocator.destroyBuffer(m_VkInstanceBuffer, m_InstanceBufferAllocation);
+	m_GpuAllocator.destroyBuffer(m_VkIndexBuffer, m_IndexBufferAllocation);
+	m_GpuAllocator.destroyBuffer(m_VkVertexBuffer, m_VertexBufferAllocation);
 	vkDestroyCommandPool(m_VkDevice, m_VkCommandPool, nullptr);
 
-	for (auto Framebuffer : m_VkSwapChainFramebuffers) vkDestroyFramebuffer(m_VkDevice, Framebuffer, nullptr);
-
-	vkDestroyPipeline(m_VkDevice, m_VkGraphicsPipeline, nullptr);
+	m_ShaderReloader.stop();
+	__discardPendingPipeline();
+	for (auto& RetiredRegistry : m_RetiredPipelineRegistries) RetiredRegistry.second->destroy();
+	m_RetiredPipelineRegistries.clear();
+	m_pPipelineRegistry->destroy();
+	m_PipelineCache.save();
+	m_PipelineCache.destroy();
+	m_AssetLoader.closeArchive();
 	vkDestroyPipelineLayout(m_VkDevice, m_VkPipelineLayout, nullptr);
+	m_DescriptorLayoutCache.destroy();
 	vkDestroyRenderPass(m_VkDevice, m_VkRenderPass, nullptr);
 
-	for (auto ImageView : m_VkSwapChainImageViews) vkDestroyImageView(m_VkDevice, ImageView, nullptr);
+	if (m_Config.Headless)
+	{
+		for (size_t i = 0; i < m_VkSwapChainImages.size(); ++i) m_GpuAllocator.destroyImage(m_VkSwapChainImages[i], m_OffscreenImageAllocations[i]);
+	}
+	else
+	{
+		vkDestroySwapchainKHR(m_VkDevice, m_VkSwapChain, nullptr);
+	}
 
-	vkDestroySwapchainKHR(m_VkDevice, m_VkSwapChain, nullptr);
+	m_GpuAllocator.destroy();
 	vkDestroyDevice(m_VkDevice, nullptr);
-	vkDestroySurfaceKHR(m_VkInstance, m_VkSurface, nullptr);
+	if (!m_Config.Headless) vkDestroySurfaceKHR(m_VkInstance, m_VkSurface, nullptr);
 
 	if (m_EnableValidationLayers) __destroyDebugUtilsMessengerEXT(m_VkInstance, m_VkDebugCallback, nullptr);
 
 	vkDestroyInstance(m_VkInstance, nullptr);
 
-	glfwDestroyWindow(m_pGLFWWindow);
-	glfwTerminate();
+	if (!m_Config.Headless)
+	{
+		glfwDestroyWindow(m_pGLFWWindow);
+		glfwTerminate();
+	}
 }
 
 //******************************************************************************************
@@ -756,7 +2374,8 @@ bool CHelloTriangleApplication::__checkDeviceExtensionSupport(VkPhysicalDevice v
 	std::vector<VkExtensionProperties> AvailableExtensions(ExtensionCount);
 	vkEnumerateDeviceExtensionProperties(vDevice, nullptr, &ExtensionCount, AvailableExtensions.data());
 
-	std::set<std::string> RequiredExtensions(DEVICE_EXTNESIONS.begin(), DEVICE_EXTNESIONS.end());
+	auto DeviceExtensions = __getRequiredDeviceExtensions();
+	std::set<std::string> RequiredExtensions(DeviceExtensions.begin(), DeviceExtensions.end());
 
 	for (const auto& Extension : AvailableExtensions)
 		RequiredExtensions.erase(Extension.extensionName);
@@ -764,6 +2383,22 @@ bool CHelloTriangleApplication::__checkDeviceExtensionSupport(VkPhysicalDevice v
 	return RequiredExtensions.empty();
 }
 
+//******************************************************************************************
+//FUNCTION:
+bool CHelloTriangleApplication::__isDeviceExtensionAvailable(VkPhysicalDevice vDevice, const char* vExtensionName) const
+{
+	uint32_t ExtensionCount;
+	vkEnumerateDeviceExtensionProperties(vDevice, nullptr, &ExtensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> AvailableExtensions(ExtensionCount);
+	vkEnumerateDeviceExtensionProperties(vDevice, nullptr, &ExtensionCount, AvailableExtensions.data());
+
+	for (const auto& Extension : AvailableExtensions)
+		if (strcmp(Extension.extensionName, vExtensionName) == 0) return true;
+
+	return false;
+}
+
 //******************************************************************************************
 //FUNCTION:
 void CHelloTriangleApplication::__setupDebugCallback()
@@ -797,6 +2432,8 @@ bool CHelloTriangleApplication::__isDeviceSuitable(VkPhysicalDevice vDevice) con
 
 	bool ExtensionsSupported = __checkDeviceExtensionSupport(vDevice);
 
+	if (m_Config.Headless) return Indices.isComplete() && ExtensionsSupported;
+
 	bool SwapChainAdequate = false;
 	if (ExtensionsSupported)
 	{
@@ -811,10 +2448,14 @@ bool CHelloTriangleApplication::__isDeviceSuitable(VkPhysicalDevice vDevice) con
 //FUNCTION:
 std::vector<const char*> CHelloTriangleApplication::__getRequiredExtensions() const
 {
-	uint32_t GLFWExtensionCount = 0;
-	const char** pGLFWExtensions = glfwGetRequiredInstanceExtensions(&GLFWExtensionCount);
+	std::vector<const char*> Extensions;
 
-	std::vector<const char*> Extensions(pGLFWExtensions, pGLFWExtensions + GLFWExtensionCount);
+	if (!m_Config.Headless)
+	{
+		uint32_t GLFWExtensionCount = 0;
+		const char** pGLFWExtensions = glfwGetRequiredInstanceExtensions(&GLFWExtensionCount);
+		Extensions.assign(pGLFWExtensions, pGLFWExtensions + GLFWExtensionCount);
+	}
 
 	if (m_EnableValidationLayers)
 		Extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -822,6 +2463,15 @@ std::vector<const char*> CHelloTriangleApplication::__getRequiredExtensions() co
 	return Extensions;
 }
 
+//******************************************************************************************
+//FUNCTION:
+std::vector<const char*> CHelloTriangleApplication::__getRequiredDeviceExtensions() const
+{
+	if (m_Config.Headless) return {};
+
+	return DEVICE_EXTNESIONS;
+}
+
 //******************************************************************************************
 //FUNCTION:
 SQueueFamilyIndices CHelloTriangleApplication::__findQueueFamilies(VkPhysicalDevice vDevice) const
@@ -834,19 +2484,32 @@ SQueueFamilyIndices CHelloTriangleApplication::__findQueueFamilies(VkPhysicalDev
 	std::vector<VkQueueFamilyProperties> QueueFamilies(QueueFamilyCount);
 	vkGetPhysicalDeviceQueueFamilyProperties(vDevice, &QueueFamilyCount, QueueFamilies.data());
 
-	int Index = 0;
-	for (const auto& QueueFamily : QueueFamilies)
+	for (uint32_t Index = 0; Index < QueueFamilyCount; ++Index)
 	{
-		if ((QueueFamily.queueCount > 0) && (QueueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) QueueFamilyIndices.GraphicsFamily = Index;
+		const auto& QueueFamily = QueueFamilies[Index];
+		if (0 == QueueFamily.queueCount) continue;
 
-		VkBool32 PresentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(vDevice, Index, m_VkSurface, &PresentSupport);
+		//NOTE: families without graphics usually map to separate hardware engines, which is what lets uploads overlap rendering
+		if (!(QueueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			if (!QueueFamilyIndices.ComputeFamily.has_value() && (QueueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)) QueueFamilyIndices.ComputeFamily = Index;
+			if (!QueueFamilyIndices.TransferFamily.has_value() && (QueueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(QueueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)) QueueFamilyIndices.TransferFamily = Index;
+		}
 
-		if (QueueFamily.queueCount > 0 && PresentSupport) QueueFamilyIndices.PresentFamily = Index;
+		if (QueueFamilyIndices.isComplete()) continue;
 
-		if (QueueFamilyIndices.isComplete()) break;
+		if (QueueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) QueueFamilyIndices.GraphicsFamily = Index;
 
-		Index++;
+		if (m_Config.Headless)
+		{
+			QueueFamilyIndices.PresentFamily = QueueFamilyIndices.GraphicsFamily;
+			continue;
+		}
+
+		VkBool32 PresentSupport = false;
+		vkGetPhysicalDeviceSurfaceSupportKHR(vDevice, Index, m_VkSurface, &PresentSupport);
+
+		if (PresentSupport) QueueFamilyIndices.PresentFamily = Index;
 	}
 
 	return QueueFamilyIndices;
@@ -901,17 +2564,13 @@ VkSurfaceFormatKHR CHelloTriangleApplication::__chooseSwapSurfaceFormat(const st
 //FUNCTION:
 VkPresentModeKHR CHelloTriangleApplication::__chooseSwapPresentMode(const std::vector<VkPresentModeKHR> vAvailablePresentModes) const
 {
-	VkPresentModeKHR BestMode = VK_PRESENT_MODE_FIFO_KHR;
-
-	for (const auto& AvailablePresentMode : vAvailablePresentModes)
+	for (VkPresentModeKHR PreferredMode : PRESENT_MODE_PREFERENCES[static_cast<int>(m_Config.PresentModePolicy)])
 	{
-		if (AvailablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-			return AvailablePresentMode;
-		else if (AvailablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-			BestMode = AvailablePresentMode;
+		if (std::find(vAvailablePresentModes.begin(), vAvailablePresentModes.end(), PreferredMode) != vAvailablePresentModes.end())
+			return PreferredMode;
 	}
 
-	return BestMode;
+	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
 //******************************************************************************************
@@ -924,7 +2583,10 @@ VkExtent2D CHelloTriangleApplication::__chooseSwapExtent(const VkSurfaceCapabili
 	}
 	else
 	{
-		VkExtent2D ActualExtent = { WINDOW_WIDTH, WINDOW_HEIGHT };
+		int Width = 0, Height = 0;
+		glfwGetFramebufferSize(m_pGLFWWindow, &Width, &Height);
+
+		VkExtent2D ActualExtent = { static_cast<uint32_t>(Width), static_cast<uint32_t>(Height) };
 
 		ActualExtent.width = std::max(vCapabilities.minImageExtent.width, std::min(vCapabilities.maxImageExtent.width, ActualExtent.width));
 		ActualExtent.height = std::max(vCapabilities.minImageExtent.height, std::min(vCapabilities.maxImageExtent.height, ActualExtent.height));
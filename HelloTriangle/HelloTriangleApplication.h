@@ -4,6 +4,32 @@
 #include <cstdlib>
 #include <vector>
 #include <optional>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <future>
+#include "FrameStatistics.h"
+#include "GpuTimestampProfiler.h"
+#include "GpuMemoryAllocator.h"
+#include "PipelineCache.h"
+#include "PipelineRegistry.h"
+#include "AssetLoader.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantizer.h"
+#include "DrawSorter.h"
+#include "OverdrawCounter.h"
+#include "ShaderHotReloader.h"
+#include "ParallelCommandRecorder.h"
+#include "GpuCuller.h"
+#include "RenderGraph.h"
+#include "FrameCapture.h"
+#include "FramePacingMonitor.h"
+#include "DeviceSelector.h"
+#include "StreamingUploader.h"
+#include "FrameUploadRing.h"
+#include "DescriptorLayoutCache.h"
+#include "DescriptorAllocator.h"
+#include <glm/glm.hpp>
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
@@ -11,8 +37,94 @@ struct SQueueFamilyIndices
 {
 	std::optional<uint32_t> GraphicsFamily;
 	std::optional<uint32_t> PresentFamily;
+	std::optional<uint32_t> TransferFamily;		//transfer without graphics or compute
+	std::optional<uint32_t> ComputeFamily;		//compute without graphics
 
 	bool isComplete() { return GraphicsFamily.has_value() && PresentFamily.has_value(); }
+	uint32_t getUploadFamily() const { return TransferFamily.value_or(ComputeFamily.value_or(GraphicsFamily.value())); }
+};
+
+struct SDrawItem
+{
+	uint32_t IndexCount = 0;
+	uint32_t FirstIndex = 0;
+	int32_t  VertexOffset = 0;
+	uint32_t InstanceCount = 1;
+	uint32_t FirstInstance = 0;
+	float	 NearDepth = 0.0f;	//of the nearest instance, the front to back sort key
+	float	 FarDepth = 0.0f;	//of the farthest instance, the back to front sort key
+};
+
+enum class EDrawSortOrder
+{
+	None = 0,
+	FrontToBack,
+	BackToFront,
+	Count
+};
+
+enum class ECullingMode
+{
+	None = 0,
+	Cpu,
+	Gpu
+};
+
+enum class EPresentModePolicy
+{
+	Mailbox = 0,
+	Fifo,
+	FifoRelaxed,
+	Immediate,
+	Count
+};
+
+struct SApplicationConfig
+{
+	bool		Headless = false;
+	uint32_t	Width = 800;
+	uint32_t	Height = 600;
+	uint32_t	FrameCount = 0;
+	uint32_t	FramesInFlight = 2;
+	uint32_t	SwapChainImageCount = 0;
+	EPresentModePolicy PresentModePolicy = EPresentModePolicy::Mailbox;
+	uint32_t	GpuMemoryBlockSizeMB = 64;
+	std::string	DeviceOverride;
+	bool		ListDevices = false;
+	std::string	PipelineCacheFile = "pipeline_cache.bin";
+	std::string	AssetArchiveFile;
+	std::string	PackAssetsFile;
+	uint32_t	MeshDensity = 1;
+	bool		OptimizeMesh = true;
+	EVertexFormat VertexFormat = EVertexFormat::Float32;
+	uint32_t	DrawCount = 1;
+	uint32_t	InstanceCount = 1;
+	float		SceneExtent = 1.0f;
+	uint32_t	DepthLayerCount = 1;
+	EDrawSortOrder DrawSortOrder = EDrawSortOrder::FrontToBack;
+	ECullingMode CullingMode = ECullingMode::None;
+	bool		StreamInstanceColors = false;
+	float		PulseAmplitude = 0.0f;
+	bool		TintDraws = false;
+	bool		HotReloadShaders = false;
+	uint32_t	RecordThreadCount = 0;
+	std::string	CaptureDirectory;		//frames are only captured when set
+	ECaptureFileFormat CaptureFileFormat = ECaptureFileFormat::Png;
+	uint32_t	CaptureInterval = 1;
+	uint32_t	CaptureThreadCount = 0;
+	bool		CaptureBlocking = false;
+	std::string	CaptureReferenceDirectory;
+
+	uint32_t	BenchmarkWarmupFrames = 60;
+	uint32_t	BenchmarkFrames = 0;
+	std::string	BenchmarkOutputFile;
+	bool		RecordBenchmark = false;
+	bool		StressTest = false;
+	uint32_t	StressMaxInstances = 1u << 22;
+	bool		CullingBenchmark = false;
+	bool		PipelineBenchmark = false;
+	uint32_t	PipelineBenchmarkVariants = 64;
+	bool		OverdrawBenchmark = false;
 };
 
 struct SSwapChainSupportDetails
@@ -25,9 +137,13 @@ struct SSwapChainSupportDetails
 class CHelloTriangleApplication
 {
 public:
+	CHelloTriangleApplication(const SApplicationConfig& vConfig = SApplicationConfig()) : m_Config(vConfig) {}
+
 	void run();
 
 private:
+	SApplicationConfig m_Config;
+
 	GLFWwindow* m_pGLFWWindow = nullptr;
 
 	VkInstance					m_VkInstance = VK_NULL_HANDLE;
@@ -37,15 +153,20 @@ private:
 	VkDevice					m_VkDevice = VK_NULL_HANDLE;
 	VkQueue						m_VkGraphicsQueue = VK_NULL_HANDLE;
 	VkQueue						m_VkPresentQueue = VK_NULL_HANDLE;
+	VkQueue						m_VkTransferQueue = VK_NULL_HANDLE;
 	VkSwapchainKHR				m_VkSwapChain = VK_NULL_HANDLE;
+	VkDescriptorSetLayout		m_VkDescriptorSetLayout = VK_NULL_HANDLE;
 	VkPipelineLayout			m_VkPipelineLayout = VK_NULL_HANDLE;
 	VkRenderPass				m_VkRenderPass = VK_NULL_HANDLE;
-	VkPipeline					m_VkGraphicsPipeline = VK_NULL_HANDLE;
+	VkPipeline					m_VkGraphicsPipeline = VK_NULL_HANDLE;		//owned by the pipeline registry
 	VkCommandPool				m_VkCommandPool = VK_NULL_HANDLE;
 	VkBuffer					m_VkVertexBuffer = VK_NULL_HANDLE;
 	VkFormat					m_VkSwapChainImageFormat;
+	VkPresentModeKHR			m_VkPresentMode = VK_PRESENT_MODE_FIFO_KHR;
 	VkExtent2D					m_VkSwapChainExtent;
+	VkFormat					m_VkDepthFormat = VK_FORMAT_UNDEFINED;
 
+	std::vector<VkCommandPool>		m_VkFrameCommandPools;
 	std::vector<VkCommandBuffer>	m_VkCommandBuffers;
 	std::vector<VkImage>			m_VkSwapChainImages;
 	std::vector<VkImageView>		m_VkSwapChainImageViews;
@@ -53,9 +174,86 @@ private:
 	std::vector<VkSemaphore>		m_VkImageAvailableSemaphores;
 	std::vector<VkSemaphore>		m_VkRenderFinishedSemaphores;
 	std::vector<VkFence>			m_VkInFlightFences;
+	std::vector<VkFence>			m_VkImagesInFlight;
+	std::vector<SGpuAllocation>		m_OffscreenImageAllocations;
+
+	CGpuMemoryAllocator	m_GpuAllocator;
+	CAssetLoader		m_AssetLoader;
+	CPipelineCache		m_PipelineCache;
+	std::unique_ptr<CPipelineRegistry>	m_pPipelineRegistry;
+	std::unique_ptr<CPipelineRegistry>	m_pPendingPipelineRegistry;
+	std::future<void>	m_PendingPipelineBuild;
+	std::vector<std::pair<uint32_t, std::unique_ptr<CPipelineRegistry>>> m_RetiredPipelineRegistries;	//frames left until the GPU is done with them
+	CShaderHotReloader	m_ShaderReloader;
+	std::chrono::steady_clock::time_point m_ShaderChangeTime;
+	double				m_PipelineCreationTime = 0.0;
+	SGpuAllocation		m_VertexBufferAllocation;
+	VkBuffer			m_VkIndexBuffer = VK_NULL_HANDLE;
+	VkIndexType			m_VkIndexType = VK_INDEX_TYPE_UINT16;
+	uint32_t			m_MeshIndexCount = 0;
+	uint32_t			m_MeshVertexCount = 0;
+	SVertexCacheStatistics	m_MeshCacheStatisticsBefore;
+	SVertexCacheStatistics	m_MeshCacheStatisticsAfter;
+	double				m_MeshOptimizeTime = 0.0;
+	EVertexFormat		m_VertexFormat = EVertexFormat::Float32;
+	double				m_MeshQuantizeTime = 0.0;
+	SGpuAllocation		m_IndexBufferAllocation;
+	VkBuffer			m_VkInstanceBuffer = VK_NULL_HANDLE;
+	SGpuAllocation		m_InstanceBufferAllocation;
+	VkBuffer			m_VkInstanceBoundsBuffer = VK_NULL_HANDLE;
+	SGpuAllocation		m_InstanceBoundsAllocation;
+	VkBuffer			m_VkInstanceDepthBuffer = VK_NULL_HANDLE;
+	SGpuAllocation		m_InstanceDepthAllocation;
+	VkDeviceSize		m_InstanceColorOffset = 0;
+	VkDeviceSize		m_InstanceColorSlotSize = 0;
+	uint32_t			m_InstanceCount = 0;
+	std::vector<glm::vec4>	m_InstanceBounds;
+	std::vector<float>		m_InstanceDepths;
+	std::vector<glm::vec3>	m_InstanceColors;
+	std::vector<glm::vec3>	m_StreamedColors;
+	uint64_t				m_StreamedFrameCount = 0;
+
+	CStreamingUploader	m_StreamingUploader;
+	CFrameUploadRing	m_FrameUploadRing;
+	std::vector<uint32_t>	m_FrameUniformOffsets;
+	std::vector<VkDescriptorSet>	m_VkFrameDescriptorSets;
+	std::vector<VkDescriptorSetLayoutBinding>	m_DescriptorSetBindings;
+	CDescriptorLayoutCache	m_DescriptorLayoutCache;
+	CDescriptorAllocator	m_DescriptorAllocator;
+	std::chrono::steady_clock::time_point m_StartTime;
+
+	CGpuCuller	m_GpuCuller;
+	bool		m_IsGpuCullingSupported = false;
+	bool		m_IsDrawIndirectCountSupported = false;
+
+	CRenderGraph	m_RenderGraph;
+	uint32_t		m_ColorTargetResource = 0;
+	uint32_t		m_DepthTargetResource = 0;		//transient, owned by the render graph
+	bool			m_IsReadbackPassDeclared = false;
+
+	CFrameCapture	m_FrameCapture;
+	bool			m_IsSwapChainCopyable = false;
+	bool			m_IsCaptureMismatched = false;
+
+	CFrameStatistics		m_FrameStatistics;
+	CGpuTimestampProfiler	m_GpuProfiler;
+	COverdrawCounter		m_OverdrawCounter;
+	bool					m_IsOverdrawQuerySupported = false;
+	CFramePacingMonitor		m_PacingMonitor;
+
+	CParallelCommandRecorder	m_CommandRecorder;
+	std::vector<SDrawItem>		m_DrawItems;
+	std::vector<SDrawItem>		m_SortedDrawItems;
+	std::vector<uint64_t>		m_DrawSortKeys;
+	CDrawSorter					m_DrawSorter;
+
+	std::vector<std::optional<std::chrono::steady_clock::time_point>> m_FrameInputTimes;
 
 	size_t	m_CurrentFrame = 0;
+	uint64_t	m_FrameNumber = 0;
 	bool	m_EnableValidationLayers = false;
+	bool	m_IsFramebufferResized = false;
+	bool	m_IsPresentModeChangeRequested = false;
 
 	void __init();
 	void __mainLoop();
@@ -65,29 +263,78 @@ private:
 	void __initVulkan();
 
 	void __drawFrame();
+	void __recreateSwapChain();
+	void __cleanupSwapChain();
+	void __waitForFramesInFlight();
+	void __recordCompletedFrames();
+	void __switchPresentMode();
+	void __updateShaderReload();
+	void __discardPendingPipeline();
+	void __reportBenchmark();
+	void __runRecordBenchmark();
+	void __runStressTest();
+	void __runCullingBenchmark();
+	void __runPipelineBenchmark();
+	void __runOverdrawBenchmark();
+	bool __measureFrames(uint32_t vWarmupFrames, uint32_t vFrames);
+	void __writeBenchmarkOutput(const std::string& vJson) const;
 
 	void __createVulkanInstance();
 	void __setupDebugCallback();
 	void __createSurface();
 	void __pickPhysicalDevice();
 	void __createLogicalDevice();
+	void __createMemoryAllocator();
 	void __createSwapChain();
+	void __createOffscreenTargets();
 	void __createImageViews();
+	void __selectDepthFormat();
+	void __buildRenderGraph();
+	bool __isCaptureFrame() const;
+	void __createFrameCapture();
 	void __createRenderPass();
+	void __createPipelineCache();
+	void __createDescriptorSetLayout();
+	void __selectVertexFormat();
 	void __createGraphicsPipeline();
+	SPipelineProgram __createPipelineProgram() const;
 	void __createFrameBuffers();
 	void __createCommandPool();
-	void __createVertexBuffer();
+	void __createMesh();
+	void __createGpuCuller();
+	void __createStreamingUploader();
+	void __createInstanceBuffer(uint32_t vInstanceCount);
+	void __streamInstanceColors(uint32_t vFrame);
+	void __createDrawList();
+	void __createFrameUploadRing();
+	void __updateFrameUniforms(uint32_t vFrame);
+	void __cullObjectsOnCpu();
+	void __sortDrawItems();
+	void __setCullingMode(ECullingMode vMode);
+	void __createGpuProfiler();
 	void __createCommandBuffers();
+	void __recordCommandBuffer(uint32_t vFrame, uint32_t vImageIndex);
+	void __recordCullPass(VkCommandBuffer vCommandBuffer, uint32_t vFrame);
+	void __recordScenePass(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex);
+	void __recordReadbackPass(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex);
 	void __createSyncObjects();
 
-	VkShaderModule __createShaderModule(const std::vector<char>& vCode);
+	void __recordDrawRange(VkCommandBuffer vCommandBuffer, uint32_t vFrame, size_t vFirstItem, size_t vEndItem) const;
+	void __bindDrawState(VkCommandBuffer vCommandBuffer, uint32_t vFrame) const;
+	uint32_t __getRecordThreadCount() const;
+
+	void __createDeviceLocalBuffer(const void* vData, VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkBuffer& voBuffer, SGpuAllocation& voAllocation);
+	void __copyBuffer(VkBuffer vSrcBuffer, VkBuffer vDstBuffer, VkDeviceSize vSize);
+	VkCommandBuffer __beginSingleTimeCommands();
+	void __endSingleTimeCommands(VkCommandBuffer vCommandBuffer);
 
 	bool __checkValidationLayerSupport() const;
 	bool __checkDeviceExtensionSupport(VkPhysicalDevice vDevice) const;
+	bool __isDeviceExtensionAvailable(VkPhysicalDevice vDevice, const char* vExtensionName) const;
 	bool __isDeviceSuitable(VkPhysicalDevice vDevice) const;
 
 	std::vector<const char*> __getRequiredExtensions() const;
+	std::vector<const char*> __getRequiredDeviceExtensions() const;
 	SQueueFamilyIndices __findQueueFamilies(VkPhysicalDevice vDevice) const;
 	SSwapChainSupportDetails __querySwapChainSupport(VkPhysicalDevice vDevice) const;
 
@@ -95,6 +342,9 @@ private:
 	VkPresentModeKHR __chooseSwapPresentMode(const std::vector<VkPresentModeKHR> vAvailablePresentModes) const;
 	VkExtent2D __chooseSwapExtent(const VkSurfaceCapabilitiesKHR& vCapabilities) const;
 
+	static void __framebufferResizeCallback(GLFWwindow* vWindow, int vWidth, int vHeight);
+	static void __keyCallback(GLFWwindow* vWindow, int vKey, int vScancode, int vAction, int vMods);
+
 	VkResult __createDebugUtilsMessengerEXT(VkInstance, const VkDebugUtilsMessengerCreateInfoEXT*, const VkAllocationCallbacks*, VkDebugUtilsMessengerEXT*);
 	void __destroyDebugUtilsMessengerEXT(VkInstance, VkDebugUtilsMessengerEXT, const VkAllocationCallbacks*);
 };
\ No newline at end of file
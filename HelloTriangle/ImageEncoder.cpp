@@ -0,0 +1,254 @@
+#include "ImageEncoder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	const uint32_t HASH_BITS = 15;
+	const uint32_t WINDOW_SIZE = 32768;
+	const uint32_t MIN_MATCH_LENGTH = 3;
+	const uint32_t MAX_MATCH_LENGTH = 258;
+
+	const uint16_t LENGTH_BASES[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA_BITS[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASES[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA_BITS[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	class CBitWriter
+	{
+	public:
+		CBitWriter(std::vector<uint8_t>& vioOutput) : m_Output(vioOutput) {}
+
+		void writeBits(uint32_t vValue, uint32_t vCount)
+		{
+			m_Buffer |= static_cast<uint64_t>(vValue) << m_BitCount;
+			m_BitCount += vCount;
+			while (m_BitCount >= 8)
+			{
+				m_Output.push_back(static_cast<uint8_t>(m_Buffer));
+				m_Buffer >>= 8;
+				m_BitCount -= 8;
+			}
+		}
+
+		//NOTE: huffman codes go out most significant bit first, everything else least significant bit first
+		void writeCode(uint32_t vCode, uint32_t vLength)
+		{
+			uint32_t Reversed = 0;
+			for (uint32_t i = 0; i < vLength; ++i) Reversed |= ((vCode >> i) & 1u) << (vLength - 1 - i);
+			writeBits(Reversed, vLength);
+		}
+
+		void flush()
+		{
+			if (m_BitCount > 0) m_Output.push_back(static_cast<uint8_t>(m_Buffer));
+			m_Buffer = 0;
+			m_BitCount = 0;
+		}
+
+	private:
+		std::vector<uint8_t>& m_Output;
+		uint64_t m_Buffer = 0;
+		uint32_t m_BitCount = 0;
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CImageEncoder::updateCrc32(uint32_t vCrc, const uint8_t* vData, size_t vSize)
+{
+	static const auto Table = []()
+	{
+		std::vector<uint32_t> Result(256);
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t Value = i;
+			for (int k = 0; k < 8; ++k) Value = (Value & 1u) ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+			Result[i] = Value;
+		}
+		return Result;
+	}();
+
+	uint32_t Crc = ~vCrc;
+	for (size_t i = 0; i < vSize; ++i) Crc = Table[(Crc ^ vData[i]) & 0xFFu] ^ (Crc >> 8);
+	return ~Crc;
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CImageEncoder::computeAdler32(const uint8_t* vData, size_t vSize)
+{
+	//NOTE: 5552 bytes is the longest run the sums can take before they have to be reduced
+	uint32_t A = 1, B = 0;
+	while (vSize > 0)
+	{
+		size_t BlockSize = std::min<size_t>(vSize, 5552);
+		for (size_t i = 0; i < BlockSize; ++i)
+		{
+			A += vData[i];
+			B += A;
+		}
+		A %= 65521u;
+		B %= 65521u;
+		vData += BlockSize;
+		vSize -= BlockSize;
+	}
+	return (B << 16) | A;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static void __writeLiteral(CBitWriter& vioWriter, uint32_t vSymbol)
+{
+	if (vSymbol < 144) vioWriter.writeCode(0x30 + vSymbol, 8);
+	else if (vSymbol < 256) vioWriter.writeCode(0x190 + vSymbol - 144, 9);
+	else if (vSymbol < 280) vioWriter.writeCode(vSymbol - 256, 7);
+	else vioWriter.writeCode(0xC0 + vSymbol - 280, 8);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static void __writeMatch(CBitWriter& vioWriter, uint32_t vLength, uint32_t vDistance)
+{
+	uint32_t LengthIndex = static_cast<uint32_t>(std::upper_bound(std::begin(LENGTH_BASES), std::end(LENGTH_BASES), vLength) - std::begin(LENGTH_BASES)) - 1;
+	__writeLiteral(vioWriter, 257 + LengthIndex);
+	vioWriter.writeBits(vLength - LENGTH_BASES[LengthIndex], LENGTH_EXTRA_BITS[LengthIndex]);
+
+	uint32_t DistanceIndex = static_cast<uint32_t>(std::upper_bound(std::begin(DISTANCE_BASES), std::end(DISTANCE_BASES), vDistance) - std::begin(DISTANCE_BASES)) - 1;
+	vioWriter.writeCode(DistanceIndex, 5);
+	vioWriter.writeBits(vDistance - DISTANCE_BASES[DistanceIndex], DISTANCE_EXTRA_BITS[DistanceIndex]);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static void __deflate(const std::vector<uint8_t>& vData, std::vector<uint8_t>& voStream)
+{
+	//NOTE: one block with the fixed huffman tables and a single probe per position, rendered frames are mostly long runs that this already catches
+	voStream.push_back(0x78);
+	voStream.push_back(0x01);
+
+	CBitWriter Writer(voStream);
+	Writer.writeBits(1, 1);
+	Writer.writeBits(1, 2);
+
+	const uint32_t Size = static_cast<uint32_t>(vData.size());
+	std::vector<int32_t> HashHeads(size_t(1) << HASH_BITS, -1);
+	auto hashAt = [&vData](uint32_t vPosition) { return ((vData[vPosition] << 16 | vData[vPosition + 1] << 8 | vData[vPosition + 2]) * 2654435761u) >> (32 - HASH_BITS); };
+
+	uint32_t Position = 0;
+	while (Position < Size)
+	{
+		uint32_t MatchLength = 0, MatchDistance = 0;
+		if (Position + MIN_MATCH_LENGTH <= Size)
+		{
+			uint32_t Hash = hashAt(Position);
+			int32_t Candidate = HashHeads[Hash];
+			HashHeads[Hash] = static_cast<int32_t>(Position);
+
+			if (Candidate >= 0 && Position - Candidate <= WINDOW_SIZE)
+			{
+				uint32_t MaxLength = std::min(MAX_MATCH_LENGTH, Size - Position);
+				const uint8_t* pCurrent = vData.data() + Position;
+				const uint8_t* pCandidate = vData.data() + Candidate;
+				while (MatchLength < MaxLength && pCurrent[MatchLength] == pCandidate[MatchLength]) ++MatchLength;
+				MatchDistance = Position - Candidate;
+			}
+		}
+
+		if (MatchLength >= MIN_MATCH_LENGTH)
+		{
+			__writeMatch(Writer, MatchLength, MatchDistance);
+			for (uint32_t i = 1; i < MatchLength && Position + i + MIN_MATCH_LENGTH <= Size; ++i) HashHeads[hashAt(Position + i)] = static_cast<int32_t>(Position + i);
+			Position += MatchLength;
+		}
+		else
+		{
+			__writeLiteral(Writer, vData[Position]);
+			++Position;
+		}
+	}
+	__writeLiteral(Writer, 256);
+	Writer.flush();
+
+	uint32_t Adler = CImageEncoder::computeAdler32(vData.data(), vData.size());
+	for (int Shift = 24; Shift >= 0; Shift -= 8) voStream.push_back(static_cast<uint8_t>(Adler >> Shift));
+}
+
+//******************************************************************************************
+//FUNCTION:
+static void __filterRows(const uint8_t* vPixels, uint32_t vWidth, uint32_t vHeight, std::vector<uint8_t>& voFiltered)
+{
+	//NOTE: each row takes the filter with the smallest sum of absolute residuals, the usual heuristic from the png specification
+	const size_t RowSize = size_t(vWidth) * 4;
+	voFiltered.resize((RowSize + 1) * vHeight);
+	std::vector<uint8_t> Candidates[5];
+	for (auto& Candidate : Candidates) Candidate.resize(RowSize);
+
+	for (uint32_t y = 0; y < vHeight; ++y)
+	{
+		const uint8_t* pRow = vPixels + RowSize * y;
+		const uint8_t* pPrior = y > 0 ? pRow - RowSize : nullptr;
+
+		uint64_t Costs[5] = {};
+		for (size_t i = 0; i < RowSize; ++i)
+		{
+			int Left = i >= 4 ? pRow[i - 4] : 0;
+			int Up = pPrior ? pPrior[i] : 0;
+			int UpLeft = (pPrior && i >= 4) ? pPrior[i - 4] : 0;
+
+			int Estimate = Left + Up - UpLeft;
+			int DistanceLeft = std::abs(Estimate - Left), DistanceUp = std::abs(Estimate - Up), DistanceUpLeft = std::abs(Estimate - UpLeft);
+			int Paeth = (DistanceLeft <= DistanceUp && DistanceLeft <= DistanceUpLeft) ? Left : (DistanceUp <= DistanceUpLeft ? Up : UpLeft);
+
+			const int Predictions[5] = { 0, Left, Up, (Left + Up) / 2, Paeth };
+			for (int k = 0; k < 5; ++k)
+			{
+				uint8_t Residual = static_cast<uint8_t>(pRow[i] - Predictions[k]);
+				Candidates[k][i] = Residual;
+				Costs[k] += std::abs(static_cast<int8_t>(Residual));
+			}
+		}
+
+		int Best = static_cast<int>(std::min_element(std::begin(Costs), std::end(Costs)) - std::begin(Costs));
+		uint8_t* pOutput = voFiltered.data() + (RowSize + 1) * y;
+		pOutput[0] = static_cast<uint8_t>(Best);
+		memcpy(pOutput + 1, Candidates[Best].data(), RowSize);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+static void __appendChunk(std::vector<uint8_t>& vioPng, const char* vType, const std::vector<uint8_t>& vData)
+{
+	uint32_t Size = static_cast<uint32_t>(vData.size());
+	for (int Shift = 24; Shift >= 0; Shift -= 8) vioPng.push_back(static_cast<uint8_t>(Size >> Shift));
+
+	size_t TypeOffset = vioPng.size();
+	vioPng.insert(vioPng.end(), vType, vType + 4);
+	vioPng.insert(vioPng.end(), vData.begin(), vData.end());
+
+	uint32_t Crc = CImageEncoder::updateCrc32(0, vioPng.data() + TypeOffset, vioPng.size() - TypeOffset);
+	for (int Shift = 24; Shift >= 0; Shift -= 8) vioPng.push_back(static_cast<uint8_t>(Crc >> Shift));
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CImageEncoder::encodePng(const uint8_t* vPixels, uint32_t vWidth, uint32_t vHeight, std::vector<uint8_t>& voPng)
+{
+	static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	voPng.assign(std::begin(Signature), std::end(Signature));
+
+	std::vector<uint8_t> Header;
+	for (uint32_t Value : { vWidth, vHeight })
+		for (int Shift = 24; Shift >= 0; Shift -= 8) Header.push_back(static_cast<uint8_t>(Value >> Shift));
+	Header.insert(Header.end(), { 8, 6, 0, 0, 0 });		//8-bit RGBA, deflate, adaptive filtering, no interlace
+	__appendChunk(voPng, "IHDR", Header);
+
+	std::vector<uint8_t> Filtered, Compressed;
+	__filterRows(vPixels, vWidth, vHeight, Filtered);
+	__deflate(Filtered, Compressed);
+	__appendChunk(voPng, "IDAT", Compressed);
+
+	__appendChunk(voPng, "IEND", {});
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class CImageEncoder
+{
+public:
+	//NOTE: 8-bit RGBA rows without padding; the output only depends on the pixels, so identical frames always give identical files
+	static void encodePng(const uint8_t* vPixels, uint32_t vWidth, uint32_t vHeight, std::vector<uint8_t>& voPng);
+
+	//NOTE: the checksums of png chunks and of the zlib stream, vCrc continues a previous crc and starts at 0
+	static uint32_t updateCrc32(uint32_t vCrc, const uint8_t* vData, size_t vSize);
+	static uint32_t computeAdler32(const uint8_t* vData, size_t vSize);
+};
@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//******************************************************************************************
+//FUNCTION:
+CMappedFile::CMappedFile(CMappedFile&& vOther) noexcept
+	: m_pData(std::exchange(vOther.m_pData, nullptr)), m_Size(std::exchange(vOther.m_Size, 0)), m_IsOpen(std::exchange(vOther.m_IsOpen, false))
+{
+}
+
+//******************************************************************************************
+//FUNCTION:
+CMappedFile& CMappedFile::operator=(CMappedFile&& vOther) noexcept
+{
+	if (this != &vOther)
+	{
+		close();
+		m_pData = std::exchange(vOther.m_pData, nullptr);
+		m_Size = std::exchange(vOther.m_Size, 0);
+		m_IsOpen = std::exchange(vOther.m_IsOpen, false);
+	}
+	return *this;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CMappedFile::open(const std::string& vFilename)
+{
+	close();
+
+	//NOTE: the file handles are closed as soon as the view exists, the view alone keeps the mapping alive
+#ifdef _WIN32
+	HANDLE File = CreateFileA(vFilename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (File == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize))
+	{
+		CloseHandle(File);
+		return false;
+	}
+
+	//NOTE: an empty file cannot be mapped, it is still a valid asset
+	if (FileSize.QuadPart > 0)
+	{
+		HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (Mapping != nullptr)
+		{
+			m_pData = static_cast<const char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+			CloseHandle(Mapping);
+		}
+		if (m_pData == nullptr)
+		{
+			CloseHandle(File);
+			return false;
+		}
+	}
+	CloseHandle(File);
+	m_Size = static_cast<size_t>(FileSize.QuadPart);
+#else
+	int File = ::open(vFilename.c_str(), O_RDONLY);
+	if (File < 0) return false;
+
+	struct stat FileStatus;
+	if (fstat(File, &FileStatus) != 0)
+	{
+		::close(File);
+		return false;
+	}
+
+	//NOTE: an empty file cannot be mapped, it is still a valid asset
+	if (FileStatus.st_size > 0)
+	{
+		void* pData = mmap(nullptr, static_cast<size_t>(FileStatus.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+		if (pData == MAP_FAILED)
+		{
+			::close(File);
+			return false;
+		}
+		m_pData = static_cast<const char*>(pData);
+	}
+	::close(File);
+	m_Size = static_cast<size_t>(FileStatus.st_size);
+#endif
+
+	m_IsOpen = true;
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CMappedFile::close()
+{
+	if (m_pData != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+	}
+
+	m_pData = nullptr;
+	m_Size = 0;
+	m_IsOpen = false;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+
+//NOTE: a read-only view of a whole file, the base address is page aligned so it can be handed to Vulkan as SPIR-V directly
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	~CMappedFile() { close(); }
+
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile& operator=(const CMappedFile&) = delete;
+	CMappedFile(CMappedFile&& vOther) noexcept;
+	CMappedFile& operator=(CMappedFile&& vOther) noexcept;
+
+	bool open(const std::string& vFilename);
+	void close();
+
+	bool isOpen() const { return m_IsOpen; }
+	const char* getData() const { return m_pData; }
+	size_t getSize() const { return m_Size; }
+
+private:
+	const char*	m_pData = nullptr;
+	size_t		m_Size = 0;
+	bool		m_IsOpen = false;
+};
@@ -0,0 +1,218 @@
+#include "MeshOptimizer.h"
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+namespace
+{
+	//NOTE: the scoring constants of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	const int FORSYTH_CACHE_SIZE = 32;
+	const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+	const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+	const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+	const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static float __computeVertexScore(int vCachePosition, uint32_t vRemainingValence)
+{
+	if (0 == vRemainingValence) return -1.0f;
+
+	float Score = 0.0f;
+	if (vCachePosition >= 0)
+	{
+		//NOTE: the three vertices of the triangle just added get a fixed score, so the next triangle does not simply reuse the same edge
+		if (vCachePosition < 3)
+			Score = FORSYTH_LAST_TRIANGLE_SCORE;
+		else
+			Score = std::pow(1.0f - static_cast<float>(vCachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+	}
+
+	return Score + FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(vRemainingValence), -FORSYTH_VALENCE_BOOST_POWER);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CMeshOptimizer::generateIndexBuffer(std::vector<char>& vioVertices, size_t vStride, std::vector<uint32_t>& voIndices)
+{
+	size_t VertexCount = vioVertices.size() / vStride;
+
+	auto hashVertex = [&](uint32_t vIndex)
+	{
+		//NOTE: FNV-1a over the raw bytes, padding inside a vertex must therefore be zeroed by the caller
+		const char* pVertex = vioVertices.data() + vIndex * vStride;
+		size_t Hash = 14695981039346656037ull;
+		for (size_t i = 0; i < vStride; ++i) Hash = (Hash ^ static_cast<uint8_t>(pVertex[i])) * 1099511628211ull;
+		return Hash;
+	};
+	auto isSameVertex = [&](uint32_t vLhs, uint32_t vRhs) { return memcmp(vioVertices.data() + vLhs * vStride, vioVertices.data() + vRhs * vStride, vStride) == 0; };
+
+	std::unordered_map<uint32_t, uint32_t, decltype(hashVertex), decltype(isSameVertex)> UniqueVertices(VertexCount, hashVertex, isSameVertex);
+
+	std::vector<char> Vertices;
+	Vertices.reserve(vioVertices.size());
+	voIndices.resize(VertexCount);
+
+	for (uint32_t i = 0; i < VertexCount; ++i)
+	{
+		auto Result = UniqueVertices.emplace(i, static_cast<uint32_t>(Vertices.size() / vStride));
+		if (Result.second) Vertices.insert(Vertices.end(), vioVertices.begin() + i * vStride, vioVertices.begin() + (i + 1) * vStride);
+		voIndices[i] = Result.first->second;
+	}
+
+	vioVertices.swap(Vertices);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CMeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& vioIndices, size_t vVertexCount)
+{
+	size_t TriangleCount = vioIndices.size() / 3;
+	if (0 == TriangleCount) return;
+
+	//NOTE: every vertex keeps the list of triangles still waiting to be emitted, packed into one array
+	std::vector<uint32_t> RemainingValences(vVertexCount, 0);
+	for (uint32_t Index : vioIndices) ++RemainingValences[Index];
+
+	std::vector<uint32_t> AdjacencyOffsets(vVertexCount + 1, 0);
+	for (size_t i = 0; i < vVertexCount; ++i) AdjacencyOffsets[i + 1] = AdjacencyOffsets[i] + RemainingValences[i];
+
+	std::vector<uint32_t> AdjacentTriangles(vioIndices.size());
+	std::vector<uint32_t> AdjacencyCursors(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+	for (uint32_t i = 0; i < TriangleCount; ++i)
+	{
+		for (int k = 0; k < 3; ++k) AdjacentTriangles[AdjacencyCursors[vioIndices[i * 3 + k]]++] = i;
+	}
+
+	std::vector<int> CachePositions(vVertexCount, -1);
+	std::vector<float> VertexScores(vVertexCount);
+	for (size_t i = 0; i < vVertexCount; ++i) VertexScores[i] = __computeVertexScore(-1, RemainingValences[i]);
+
+	std::vector<float> TriangleScores(TriangleCount);
+	std::vector<bool> IsEmitted(TriangleCount, false);
+	for (size_t i = 0; i < TriangleCount; ++i)
+		TriangleScores[i] = VertexScores[vioIndices[i * 3]] + VertexScores[vioIndices[i * 3 + 1]] + VertexScores[vioIndices[i * 3 + 2]];
+
+	std::vector<uint32_t> Output;
+	Output.reserve(vioIndices.size());
+
+	std::vector<uint32_t> Cache, NewCache;
+	Cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	NewCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	size_t NextUnemitted = 0;
+	int64_t BestTriangle = std::max_element(TriangleScores.begin(), TriangleScores.end()) - TriangleScores.begin();
+
+	while (BestTriangle >= 0)
+	{
+		const uint32_t* pTriangle = &vioIndices[BestTriangle * 3];
+		IsEmitted[BestTriangle] = true;
+		Output.insert(Output.end(), pTriangle, pTriangle + 3);
+
+		for (int k = 0; k < 3; ++k)
+		{
+			uint32_t Vertex = pTriangle[k];
+			uint32_t* pBegin = &AdjacentTriangles[AdjacencyOffsets[Vertex]];
+			uint32_t* pEnd = pBegin + RemainingValences[Vertex];
+			std::swap(*std::find(pBegin, pEnd, static_cast<uint32_t>(BestTriangle)), *(pEnd - 1));
+			--RemainingValences[Vertex];
+		}
+
+		//NOTE: simulated LRU cache, the emitted triangle moves to the front and everything past the cache size falls out
+		NewCache.assign(pTriangle, pTriangle + 3);
+		for (uint32_t Vertex : Cache)
+		{
+			if (Vertex != pTriangle[0] && Vertex != pTriangle[1] && Vertex != pTriangle[2]) NewCache.push_back(Vertex);
+		}
+		for (size_t i = FORSYTH_CACHE_SIZE; i < NewCache.size(); ++i)
+		{
+			CachePositions[NewCache[i]] = -1;
+			VertexScores[NewCache[i]] = __computeVertexScore(-1, RemainingValences[NewCache[i]]);
+		}
+		if (NewCache.size() > FORSYTH_CACHE_SIZE) NewCache.resize(FORSYTH_CACHE_SIZE);
+		Cache.swap(NewCache);
+
+		for (size_t i = 0; i < Cache.size(); ++i)
+		{
+			CachePositions[Cache[i]] = static_cast<int>(i);
+			VertexScores[Cache[i]] = __computeVertexScore(static_cast<int>(i), RemainingValences[Cache[i]]);
+		}
+
+		//NOTE: only triangles touching the cache change score, so the best candidate is searched among them
+		BestTriangle = -1;
+		float BestScore = -1.0f;
+		for (uint32_t Vertex : Cache)
+		{
+			for (uint32_t i = 0; i < RemainingValences[Vertex]; ++i)
+			{
+				uint32_t Triangle = AdjacentTriangles[AdjacencyOffsets[Vertex] + i];
+				float Score = VertexScores[vioIndices[Triangle * 3]] + VertexScores[vioIndices[Triangle * 3 + 1]] + VertexScores[vioIndices[Triangle * 3 + 2]];
+				TriangleScores[Triangle] = Score;
+				if (Score > BestScore)
+				{
+					BestScore = Score;
+					BestTriangle = Triangle;
+				}
+			}
+		}
+
+		//NOTE: the cache ran dry, restart from the first triangle not emitted yet instead of rescanning everything
+		if (BestTriangle < 0)
+		{
+			while (NextUnemitted < TriangleCount && IsEmitted[NextUnemitted]) ++NextUnemitted;
+			if (NextUnemitted < TriangleCount) BestTriangle = static_cast<int64_t>(NextUnemitted);
+		}
+	}
+
+	vioIndices.swap(Output);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CMeshOptimizer::optimizeVertexFetch(std::vector<char>& vioVertices, size_t vStride, std::vector<uint32_t>& vioIndices)
+{
+	//NOTE: vertices are laid out in the order the indices first reference them, unreferenced vertices are dropped
+	const uint32_t UNASSIGNED = ~0u;
+	std::vector<uint32_t> Remap(vioVertices.size() / vStride, UNASSIGNED);
+
+	std::vector<char> Vertices;
+	Vertices.reserve(vioVertices.size());
+
+	for (uint32_t& Index : vioIndices)
+	{
+		if (Remap[Index] == UNASSIGNED)
+		{
+			Remap[Index] = static_cast<uint32_t>(Vertices.size() / vStride);
+			Vertices.insert(Vertices.end(), vioVertices.begin() + Index * vStride, vioVertices.begin() + (Index + 1) * vStride);
+		}
+		Index = Remap[Index];
+	}
+
+	vioVertices.swap(Vertices);
+}
+
+//******************************************************************************************
+//FUNCTION:
+SVertexCacheStatistics CMeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& vIndices, size_t vVertexCount, uint32_t vCacheSize)
+{
+	//NOTE: a FIFO cache, which is closer to how post-transform caches behave in hardware than the LRU used for scoring
+	std::vector<uint64_t> CacheTimestamps(vVertexCount, 0);
+	uint64_t Timestamp = vCacheSize + 1;
+	size_t MissCount = 0;
+
+	for (uint32_t Index : vIndices)
+	{
+		if (Timestamp - CacheTimestamps[Index] > vCacheSize)
+		{
+			CacheTimestamps[Index] = Timestamp++;
+			++MissCount;
+		}
+	}
+
+	SVertexCacheStatistics Statistics;
+	if (!vIndices.empty()) Statistics.Acmr = static_cast<double>(MissCount) / (vIndices.size() / 3);
+	if (vVertexCount > 0) Statistics.Atvr = static_cast<double>(MissCount) / vVertexCount;
+	return Statistics;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct SVertexCacheStatistics
+{
+	double Acmr = 0.0;		//transformed vertices per triangle, 0.5 is the ideal for a large regular grid and 3.0 the worst case
+	double Atvr = 0.0;		//transformed vertices per unique vertex, 1.0 is the ideal
+};
+
+//NOTE: vertices are opaque blobs of vStride bytes, so the optimizer works for any vertex layout
+class CMeshOptimizer
+{
+public:
+	//NOTE: turns a triangle soup into unique vertices plus indices, vertices are merged only when all of their bytes match
+	static void generateIndexBuffer(std::vector<char>& vioVertices, size_t vStride, std::vector<uint32_t>& voIndices);
+
+	static void optimizeVertexCache(std::vector<uint32_t>& vioIndices, size_t vVertexCount);
+	static void optimizeVertexFetch(std::vector<char>& vioVertices, size_t vStride, std::vector<uint32_t>& vioIndices);
+
+	static SVertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& vIndices, size_t vVertexCount, uint32_t vCacheSize);
+};
@@ -0,0 +1,74 @@
+#include "OverdrawCounter.h"
+#include <stdexcept>
+
+//******************************************************************************************
+//FUNCTION:
+void COverdrawCounter::create(VkDevice vDevice, bool vIsSupported, uint32_t vSlotCount)
+{
+	m_VkDevice = vDevice;
+	m_IsSlotRecorded.assign(vSlotCount, false);
+	if (!vIsSupported) return;
+
+	VkQueryPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	PoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	PoolInfo.queryCount = vSlotCount;
+	PoolInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+	if (vkCreateQueryPool(m_VkDevice, &PoolInfo, nullptr, &m_VkQueryPool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline statistics query pool!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void COverdrawCounter::destroy()
+{
+	if (m_VkQueryPool != VK_NULL_HANDLE) vkDestroyQueryPool(m_VkDevice, m_VkQueryPool, nullptr);
+	m_VkQueryPool = VK_NULL_HANDLE;
+	m_IsSlotRecorded.clear();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void COverdrawCounter::resetSlot(VkCommandBuffer vCommandBuffer, uint32_t vSlot)
+{
+	if (!isSupported()) return;
+
+	m_IsSlotRecorded[vSlot] = false;
+	vkCmdResetQueryPool(vCommandBuffer, m_VkQueryPool, vSlot, 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void COverdrawCounter::begin(VkCommandBuffer vCommandBuffer, uint32_t vSlot)
+{
+	if (!isSupported()) return;
+
+	vkCmdBeginQuery(vCommandBuffer, m_VkQueryPool, vSlot, 0);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void COverdrawCounter::end(VkCommandBuffer vCommandBuffer, uint32_t vSlot)
+{
+	if (!isSupported()) return;
+
+	vkCmdEndQuery(vCommandBuffer, m_VkQueryPool, vSlot);
+	m_IsSlotRecorded[vSlot] = true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool COverdrawCounter::fetchResult(uint32_t vSlot, uint64_t& voFragmentCount)
+{
+	if (!isSupported() || !m_IsSlotRecorded[vSlot]) return false;
+
+	//NOTE: callers only ask after the slot's fence has signaled, the availability word just guards against a frame that was never submitted
+	uint64_t Result[2] = {};
+	VkResult QueryResult = vkGetQueryPoolResults(m_VkDevice, m_VkQueryPool, vSlot, 1, sizeof(Result), Result, sizeof(Result), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (QueryResult != VK_SUCCESS || 0 == Result[1]) return false;
+	m_IsSlotRecorded[vSlot] = false;
+
+	voFragmentCount = Result[0];
+	return true;
+}
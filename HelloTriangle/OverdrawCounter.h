@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan.h>
+
+//NOTE: counts fragment shader invocations with a pipeline statistics query, fragments rejected by early depth testing are not counted
+class COverdrawCounter
+{
+public:
+	void create(VkDevice vDevice, bool vIsSupported, uint32_t vSlotCount);
+	void destroy();
+
+	bool isSupported() const { return m_VkQueryPool != VK_NULL_HANDLE; }
+	VkQueryPipelineStatisticFlags getStatisticFlags() const { return isSupported() ? VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT : 0; }
+
+	//NOTE: all three must be recorded outside of a render pass, secondaries executed in between need inheritance of the statistics
+	void resetSlot(VkCommandBuffer vCommandBuffer, uint32_t vSlot);
+	void begin(VkCommandBuffer vCommandBuffer, uint32_t vSlot);
+	void end(VkCommandBuffer vCommandBuffer, uint32_t vSlot);
+
+	//NOTE: like the timestamp profiler, a slot's result is handed out once until the slot is recorded again
+	bool fetchResult(uint32_t vSlot, uint64_t& voFragmentCount);
+
+private:
+	VkDevice	m_VkDevice = VK_NULL_HANDLE;
+	VkQueryPool	m_VkQueryPool = VK_NULL_HANDLE;
+
+	std::vector<bool> m_IsSlotRecorded;
+};
@@ -0,0 +1,115 @@
+#include "ParallelCommandRecorder.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace
+{
+	const size_t MIN_ITEMS_PER_SLICE = 256;
+	const size_t SLICES_PER_THREAD = 2;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CParallelCommandRecorder::create(VkDevice vDevice, uint32_t vQueueFamilyIndex, uint32_t vThreadCount, uint32_t vFrameCount)
+{
+	m_VkDevice = vDevice;
+	m_FrameCount = vFrameCount;
+	m_pThreadPool = std::make_unique<CThreadPool>(vThreadCount);
+	m_WorkerFrames.resize(static_cast<size_t>(vFrameCount) * getThreadCount());
+
+	//NOTE: a command pool must only be used from one thread at a time, so every worker owns one pool per frame
+	VkCommandPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	PoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	PoolInfo.queueFamilyIndex = vQueueFamilyIndex;
+
+	for (auto& WorkerFrame : m_WorkerFrames)
+	{
+		if (vkCreateCommandPool(m_VkDevice, &PoolInfo, nullptr, &WorkerFrame.CommandPool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create worker command pool!");
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CParallelCommandRecorder::destroy()
+{
+	for (auto& WorkerFrame : m_WorkerFrames)
+	{
+		if (WorkerFrame.CommandPool != VK_NULL_HANDLE) vkDestroyCommandPool(m_VkDevice, WorkerFrame.CommandPool, nullptr);
+	}
+	m_WorkerFrames.clear();
+	m_pThreadPool.reset();
+	m_FrameCount = 0;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CParallelCommandRecorder::resetFrame(uint32_t vFrame)
+{
+	for (uint32_t i = 0; i < getThreadCount(); ++i)
+	{
+		SWorkerFrame& WorkerFrame = __getWorkerFrame(vFrame, i);
+		vkResetCommandPool(m_VkDevice, WorkerFrame.CommandPool, 0);
+		WorkerFrame.UsedCount = 0;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CParallelCommandRecorder::record(uint32_t vFrame, const VkCommandBufferInheritanceInfo& vInheritanceInfo, VkCommandBufferUsageFlags vUsageFlags, size_t vItemCount,
+	const std::function<void(VkCommandBuffer vCommandBuffer, size_t vFirstItem, size_t vEndItem)>& vRecordRange, std::vector<VkCommandBuffer>& voCommandBuffers)
+{
+	if (vFrame >= m_FrameCount) throw std::runtime_error("command recorder frame out of range!");
+
+	//NOTE: a few more slices than threads evens out the load, but every slice costs one secondary command buffer and its state setup
+	size_t SliceCount = std::min((vItemCount + MIN_ITEMS_PER_SLICE - 1) / MIN_ITEMS_PER_SLICE, getThreadCount() * SLICES_PER_THREAD);
+	SliceCount = std::max<size_t>(SliceCount, 1);
+	size_t ItemsPerSlice = (vItemCount + SliceCount - 1) / SliceCount;
+
+	voCommandBuffers.assign(SliceCount, VK_NULL_HANDLE);
+
+	VkCommandBufferBeginInfo BeginInfo = {};
+	BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	BeginInfo.flags = vUsageFlags | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	BeginInfo.pInheritanceInfo = &vInheritanceInfo;
+
+	m_pThreadPool->parallelFor(SliceCount, [&](uint32_t vThreadIndex, size_t vSlice)
+	{
+		VkCommandBuffer CommandBuffer = __acquireCommandBuffer(__getWorkerFrame(vFrame, vThreadIndex));
+
+		if (vkBeginCommandBuffer(CommandBuffer, &BeginInfo) != VK_SUCCESS)
+			throw std::runtime_error("failed to begin recording secondary command buffer!");
+
+		size_t FirstItem = std::min(vSlice * ItemsPerSlice, vItemCount);
+		vRecordRange(CommandBuffer, FirstItem, std::min(FirstItem + ItemsPerSlice, vItemCount));
+
+		if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to record secondary command buffer!");
+
+		voCommandBuffers[vSlice] = CommandBuffer;
+	});
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkCommandBuffer CParallelCommandRecorder::__acquireCommandBuffer(SWorkerFrame& vioWorkerFrame)
+{
+	//NOTE: resetting the pool resets its command buffers as well, so they are recycled instead of freed
+	if (vioWorkerFrame.UsedCount == vioWorkerFrame.CommandBuffers.size())
+	{
+		VkCommandBufferAllocateInfo AllocInfo = {};
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = vioWorkerFrame.CommandPool;
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		AllocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer CommandBuffer;
+		if (vkAllocateCommandBuffers(m_VkDevice, &AllocInfo, &CommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate secondary command buffer!");
+
+		vioWorkerFrame.CommandBuffers.push_back(CommandBuffer);
+	}
+
+	return vioWorkerFrame.CommandBuffers[vioWorkerFrame.UsedCount++];
+}
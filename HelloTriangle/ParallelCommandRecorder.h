@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <functional>
+#include <vulkan/vulkan.h>
+#include "ThreadPool.h"
+
+class CParallelCommandRecorder
+{
+public:
+	void create(VkDevice vDevice, uint32_t vQueueFamilyIndex, uint32_t vThreadCount, uint32_t vFrameCount);
+	void destroy();
+
+	uint32_t getThreadCount() const { return m_pThreadPool ? m_pThreadPool->getThreadCount() : 0; }
+
+	//NOTE: the caller must guarantee the GPU has finished every secondary command buffer previously recorded for this frame
+	void resetFrame(uint32_t vFrame);
+	void record(uint32_t vFrame, const VkCommandBufferInheritanceInfo& vInheritanceInfo, VkCommandBufferUsageFlags vUsageFlags, size_t vItemCount,
+		const std::function<void(VkCommandBuffer vCommandBuffer, size_t vFirstItem, size_t vEndItem)>& vRecordRange, std::vector<VkCommandBuffer>& voCommandBuffers);
+
+private:
+	struct SWorkerFrame
+	{
+		VkCommandPool					CommandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer>	CommandBuffers;
+		size_t							UsedCount = 0;
+	};
+
+	VkDevice					m_VkDevice = VK_NULL_HANDLE;
+	uint32_t					m_FrameCount = 0;
+	std::unique_ptr<CThreadPool>	m_pThreadPool;
+	std::vector<SWorkerFrame>	m_WorkerFrames;
+
+	SWorkerFrame& __getWorkerFrame(uint32_t vFrame, uint32_t vThreadIndex) { return m_WorkerFrames[vFrame * getThreadCount() + vThreadIndex]; }
+	VkCommandBuffer __acquireCommandBuffer(SWorkerFrame& vioWorkerFrame);
+};
@@ -0,0 +1,125 @@
+#include "PipelineCache.h"
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+	//NOTE: layout of the header every VkPipelineCache blob starts with (VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+	struct SPipelineCacheHeader
+	{
+		uint32_t	HeaderLength;
+		uint32_t	HeaderVersion;
+		uint32_t	VendorID;
+		uint32_t	DeviceID;
+		uint8_t		PipelineCacheUUID[VK_UUID_SIZE];
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineCache::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, const std::string& vFilePath)
+{
+	m_VkDevice = vDevice;
+	m_FilePath = vFilePath;
+	vkGetPhysicalDeviceProperties(vPhysicalDevice, &m_VkDeviceProperties);
+
+	std::vector<char> InitialData = __loadValidatedData();
+	m_IsLoadedFromDisk = !InitialData.empty();
+
+	VkPipelineCacheCreateInfo CreateInfo = {};
+	CreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	CreateInfo.initialDataSize = InitialData.size();
+	CreateInfo.pInitialData = InitialData.empty() ? nullptr : InitialData.data();
+
+	if (vkCreatePipelineCache(m_VkDevice, &CreateInfo, nullptr, &m_VkPipelineCache) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline cache!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineCache::destroy()
+{
+	if (m_VkPipelineCache != VK_NULL_HANDLE) vkDestroyPipelineCache(m_VkDevice, m_VkPipelineCache, nullptr);
+	m_VkPipelineCache = VK_NULL_HANDLE;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineCache::save() const
+{
+	if (m_FilePath.empty() || m_VkPipelineCache == VK_NULL_HANDLE) return;
+
+	size_t DataSize = 0;
+	if (vkGetPipelineCacheData(m_VkDevice, m_VkPipelineCache, &DataSize, nullptr) != VK_SUCCESS || 0 == DataSize) return;
+
+	std::vector<char> Data(DataSize);
+	if (vkGetPipelineCacheData(m_VkDevice, m_VkPipelineCache, &DataSize, Data.data()) != VK_SUCCESS) return;
+
+	//NOTE: write next to the target and rename over it, so a crash mid-write never leaves a truncated cache behind
+	std::string TempFilePath = m_FilePath + ".tmp";
+	{
+		std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+		if (!File.is_open())
+		{
+			std::cerr << "failed to write pipeline cache: " << TempFilePath << std::endl;
+			return;
+		}
+
+		File.write(Data.data(), DataSize);
+		File.flush();
+		if (!File.good())
+		{
+			std::cerr << "failed to write pipeline cache: " << TempFilePath << std::endl;
+			return;
+		}
+	}
+
+	std::error_code ErrorCode;
+	std::filesystem::rename(TempFilePath, m_FilePath, ErrorCode);
+	if (ErrorCode) std::cerr << "failed to replace pipeline cache " << m_FilePath << ": " << ErrorCode.message() << std::endl;
+}
+
+//******************************************************************************************
+//FUNCTION:
+std::vector<char> CPipelineCache::__loadValidatedData() const
+{
+	if (m_FilePath.empty()) return {};
+
+	std::ifstream File(m_FilePath, std::ios::ate | std::ios::binary);
+	if (!File.is_open()) return {};
+
+	size_t FileSize = (size_t)File.tellg();
+	std::vector<char> Data(FileSize);
+
+	File.seekg(0);
+	File.read(Data.data(), FileSize);
+	if (!File.good()) return {};
+
+	if (!__isHeaderCompatible(Data))
+	{
+		std::cerr << "ignoring pipeline cache " << m_FilePath << ": it was created by a different device or driver" << std::endl;
+		return {};
+	}
+
+	return Data;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CPipelineCache::__isHeaderCompatible(const std::vector<char>& vData) const
+{
+	if (vData.size() < sizeof(SPipelineCacheHeader)) return false;
+
+	SPipelineCacheHeader Header;
+	memcpy(&Header, vData.data(), sizeof(Header));
+
+	return Header.HeaderLength >= sizeof(SPipelineCacheHeader)
+		&& Header.HeaderLength <= vData.size()
+		&& Header.HeaderVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& Header.VendorID == m_VkDeviceProperties.vendorID
+		&& Header.DeviceID == m_VkDeviceProperties.deviceID
+		&& memcmp(Header.PipelineCacheUUID, m_VkDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
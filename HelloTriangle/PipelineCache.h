@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class CPipelineCache
+{
+public:
+	void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, const std::string& vFilePath);
+	void destroy();
+
+	void save() const;
+
+	VkPipelineCache getHandle() const { return m_VkPipelineCache; }
+	bool isLoadedFromDisk() const { return m_IsLoadedFromDisk; }
+
+private:
+	VkDevice					m_VkDevice = VK_NULL_HANDLE;
+	VkPipelineCache				m_VkPipelineCache = VK_NULL_HANDLE;
+	VkPhysicalDeviceProperties	m_VkDeviceProperties = {};
+	std::string					m_FilePath;
+	bool						m_IsLoadedFromDisk = false;
+
+	std::vector<char> __loadValidatedData() const;
+	bool __isHeaderCompatible(const std::vector<char>& vData) const;
+};
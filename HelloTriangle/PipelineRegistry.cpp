@@ -0,0 +1,294 @@
+#include "PipelineRegistry.h"
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
+//******************************************************************************************
+//FUNCTION:
+bool SPipelineStateDesc::operator==(const SPipelineStateDesc& vOther) const
+{
+	return Topology == vOther.Topology && PolygonMode == vOther.PolygonMode && CullMode == vOther.CullMode && FrontFace == vOther.FrontFace
+		&& BlendMode == vOther.BlendMode && RasterizationSamples == vOther.RasterizationSamples && AlphaToCoverage == vOther.AlphaToCoverage
+		&& DepthTest == vOther.DepthTest && DepthWrite == vOther.DepthWrite && DepthCompareOp == vOther.DepthCompareOp;
+}
+
+//******************************************************************************************
+//FUNCTION:
+size_t SPipelineStateDesc::hash() const
+{
+	size_t Hash = 0;
+	auto combine = [&Hash](size_t vValue) { Hash ^= std::hash<size_t>()(vValue) + 0x9e3779b9 + (Hash << 6) + (Hash >> 2); };
+
+	combine(static_cast<size_t>(Topology));
+	combine(static_cast<size_t>(PolygonMode));
+	combine(CullMode);
+	combine(static_cast<size_t>(FrontFace));
+	combine(static_cast<size_t>(BlendMode));
+	combine(static_cast<size_t>(RasterizationSamples));
+	combine(AlphaToCoverage ? 1 : 0);
+	combine(DepthTest ? 1 : 0);
+	combine(DepthWrite ? 1 : 0);
+	combine(static_cast<size_t>(DepthCompareOp));
+
+	return Hash;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineRegistry::create(VkDevice vDevice, VkPipelineCache vPipelineCache, const SPipelineProgram& vProgram)
+{
+	m_VkDevice = vDevice;
+	m_VkPipelineCache = vPipelineCache;
+	m_Program = vProgram;
+
+	m_VkVertShaderModule = __createShaderModule(*m_Program.VertShader);
+	m_VkFragShaderModule = __createShaderModule(*m_Program.FragShader);
+	m_Program.VertShader.reset();
+	m_Program.FragShader.reset();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineRegistry::destroy()
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	for (auto& Entry : m_Pipelines) vkDestroyPipeline(m_VkDevice, Entry.second, nullptr);
+	m_Pipelines.clear();
+
+	if (m_VkFragShaderModule != VK_NULL_HANDLE) vkDestroyShaderModule(m_VkDevice, m_VkFragShaderModule, nullptr);
+	if (m_VkVertShaderModule != VK_NULL_HANDLE) vkDestroyShaderModule(m_VkDevice, m_VkVertShaderModule, nullptr);
+	m_VkFragShaderModule = VK_NULL_HANDLE;
+	m_VkVertShaderModule = VK_NULL_HANDLE;
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkPipeline CPipelineRegistry::getPipeline(const SPipelineStateDesc& vState)
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	auto Iter = m_Pipelines.find(vState);
+	if (Iter != m_Pipelines.end())
+	{
+		++m_HitCount;
+		return Iter->second;
+	}
+
+	VkPipeline Pipeline;
+	__createPipelines(&vState, 1, &Pipeline);
+
+	++m_MissCount;
+	++m_BatchCount;
+	m_Pipelines.emplace(vState, Pipeline);
+
+	return Pipeline;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineRegistry::compileVariants(const std::vector<SPipelineStateDesc>& vStates, CThreadPool& vThreadPool)
+{
+	std::vector<SPipelineStateDesc> PendingStates;
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+
+		std::unordered_set<SPipelineStateDesc, SStateHasher> SeenStates;
+		for (const auto& State : vStates)
+		{
+			if (m_Pipelines.count(State) > 0 || !SeenStates.insert(State).second) continue;
+			PendingStates.push_back(State);
+		}
+	}
+	if (PendingStates.empty()) return;
+
+	size_t BatchCount = std::min<size_t>(vThreadPool.getThreadCount(), PendingStates.size());
+	size_t StatesPerBatch = (PendingStates.size() + BatchCount - 1) / BatchCount;
+	BatchCount = (PendingStates.size() + StatesPerBatch - 1) / StatesPerBatch;
+
+	//NOTE: the pipeline cache is internally synchronized, so the workers can share it without a lock
+	std::vector<VkPipeline> Pipelines(PendingStates.size(), VK_NULL_HANDLE);
+	std::exception_ptr pException;
+	try
+	{
+		vThreadPool.parallelFor(BatchCount, [&](uint32_t vThreadIndex, size_t vBatch)
+		{
+			size_t FirstState = vBatch * StatesPerBatch;
+			size_t StateCount = std::min(StatesPerBatch, PendingStates.size() - FirstState);
+			__createPipelines(PendingStates.data() + FirstState, StateCount, Pipelines.data() + FirstState);
+		});
+	}
+	catch (...)
+	{
+		pException = std::current_exception();
+	}
+
+	//NOTE: a failed batch may still have created some of its pipelines, they are kept so destroy() releases them
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	for (size_t i = 0; i < PendingStates.size(); ++i)
+	{
+		if (Pipelines[i] == VK_NULL_HANDLE) continue;
+
+		++m_MissCount;
+		m_Pipelines.emplace(PendingStates[i], Pipelines[i]);
+	}
+	m_BatchCount += BatchCount;
+
+	if (pException) std::rethrow_exception(pException);
+}
+
+//******************************************************************************************
+//FUNCTION:
+size_t CPipelineRegistry::getPipelineCount() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return m_Pipelines.size();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineRegistry::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	vOutput << "{ \"pipelines\": " << m_Pipelines.size() << ", \"hits\": " << m_HitCount << ", \"misses\": " << m_MissCount << ", \"create_calls\": " << m_BatchCount << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkShaderModule CPipelineRegistry::__createShaderModule(const CAsset& vCode) const
+{
+	//NOTE: assets are mapped straight from disk, their alignment is what makes this cast legal
+	VkShaderModuleCreateInfo CreateInfo = {};
+	CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	CreateInfo.codeSize = vCode.getSize();
+	CreateInfo.pCode = reinterpret_cast<const uint32_t*>(vCode.getData());
+
+	VkShaderModule ShaderModule;
+	if (vkCreateShaderModule(m_VkDevice, &CreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
+		throw std::runtime_error("failed to create shader module!");
+
+	return ShaderModule;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CPipelineRegistry::__createPipelines(const SPipelineStateDesc* vStates, size_t vCount, VkPipeline* voPipelines) const
+{
+	VkPipelineShaderStageCreateInfo ShaderStages[2] = {};
+	ShaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	ShaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	ShaderStages[0].module = m_VkVertShaderModule;
+	ShaderStages[0].pName = "main";
+	ShaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	ShaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	ShaderStages[1].module = m_VkFragShaderModule;
+	ShaderStages[1].pName = "main";
+
+	VkPipelineVertexInputStateCreateInfo VertexInputInfo = {};
+	VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	VertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(m_Program.BindingDescriptions.size());
+	VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(m_Program.AttributeDescriptions.size());
+	VertexInputInfo.pVertexBindingDescriptions = m_Program.BindingDescriptions.data();
+	VertexInputInfo.pVertexAttributeDescriptions = m_Program.AttributeDescriptions.data();
+
+	//NOTE: viewport and scissor are dynamic so the pipelines survive swap chain resizes
+	VkPipelineViewportStateCreateInfo ViewportState = {};
+	ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	ViewportState.viewportCount = 1;
+	ViewportState.scissorCount = 1;
+
+	VkDynamicState DynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo DynamicState = {};
+	DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	DynamicState.dynamicStateCount = 2;
+	DynamicState.pDynamicStates = DynamicStates;
+
+	std::vector<VkPipelineInputAssemblyStateCreateInfo> InputAssemblies(vCount);
+	std::vector<VkPipelineRasterizationStateCreateInfo> Rasterizers(vCount);
+	std::vector<VkPipelineMultisampleStateCreateInfo> Multisamplings(vCount);
+	std::vector<VkPipelineDepthStencilStateCreateInfo> DepthStencils(vCount);
+	std::vector<VkPipelineColorBlendAttachmentState> ColorBlendAttachments(vCount);
+	std::vector<VkPipelineColorBlendStateCreateInfo> ColorBlendings(vCount);
+	std::vector<VkGraphicsPipelineCreateInfo> PipelineInfos(vCount);
+
+	for (size_t i = 0; i < vCount; ++i)
+	{
+		const SPipelineStateDesc& State = vStates[i];
+
+		VkPipelineInputAssemblyStateCreateInfo& InputAssembly = InputAssemblies[i];
+		InputAssembly = {};
+		InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		InputAssembly.topology = State.Topology;
+		InputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkPipelineRasterizationStateCreateInfo& Rasterizer = Rasterizers[i];
+		Rasterizer = {};
+		Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		Rasterizer.depthClampEnable = VK_FALSE;
+		Rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		Rasterizer.polygonMode = State.PolygonMode;
+		Rasterizer.lineWidth = 1.0f;
+		Rasterizer.cullMode = State.CullMode;
+		Rasterizer.frontFace = State.FrontFace;
+		Rasterizer.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo& Multisampling = Multisamplings[i];
+		Multisampling = {};
+		Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		Multisampling.sampleShadingEnable = VK_FALSE;
+		Multisampling.rasterizationSamples = State.RasterizationSamples;
+		Multisampling.alphaToCoverageEnable = State.AlphaToCoverage ? VK_TRUE : VK_FALSE;
+
+		VkPipelineDepthStencilStateCreateInfo& DepthStencil = DepthStencils[i];
+		DepthStencil = {};
+		DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		DepthStencil.depthTestEnable = State.DepthTest ? VK_TRUE : VK_FALSE;
+		DepthStencil.depthWriteEnable = State.DepthWrite ? VK_TRUE : VK_FALSE;
+		DepthStencil.depthCompareOp = State.DepthCompareOp;
+		DepthStencil.depthBoundsTestEnable = VK_FALSE;
+		DepthStencil.stencilTestEnable = VK_FALSE;
+
+		VkPipelineColorBlendAttachmentState& ColorBlendAttachment = ColorBlendAttachments[i];
+		ColorBlendAttachment = {};
+		ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		ColorBlendAttachment.blendEnable = State.BlendMode == EBlendMode::Opaque ? VK_FALSE : VK_TRUE;
+		ColorBlendAttachment.srcColorBlendFactor = State.BlendMode == EBlendMode::Alpha ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.dstColorBlendFactor = State.BlendMode == EBlendMode::Alpha ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.dstAlphaBlendFactor = State.BlendMode == EBlendMode::Alpha ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo& ColorBlending = ColorBlendings[i];
+		ColorBlending = {};
+		ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		ColorBlending.logicOpEnable = VK_FALSE;
+		ColorBlending.logicOp = VK_LOGIC_OP_COPY;
+		ColorBlending.attachmentCount = 1;
+		ColorBlending.pAttachments = &ColorBlendAttachment;
+
+		VkGraphicsPipelineCreateInfo& PipelineInfo = PipelineInfos[i];
+		PipelineInfo = {};
+		PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		PipelineInfo.stageCount = 2;
+		PipelineInfo.pStages = ShaderStages;
+		PipelineInfo.pVertexInputState = &VertexInputInfo;
+		PipelineInfo.pInputAssemblyState = &InputAssembly;
+		PipelineInfo.pViewportState = &ViewportState;
+		PipelineInfo.pRasterizationState = &Rasterizer;
+		PipelineInfo.pMultisampleState = &Multisampling;
+		PipelineInfo.pDepthStencilState = &DepthStencil;
+		PipelineInfo.pColorBlendState = &ColorBlending;
+		PipelineInfo.pDynamicState = &DynamicState;
+		PipelineInfo.layout = m_Program.Layout;
+		PipelineInfo.renderPass = m_Program.RenderPass;
+		PipelineInfo.subpass = m_Program.Subpass;
+		PipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		PipelineInfo.basePipelineIndex = -1;
+	}
+
+	if (vkCreateGraphicsPipelines(m_VkDevice, m_VkPipelineCache, static_cast<uint32_t>(vCount), PipelineInfos.data(), nullptr, voPipelines) != VK_SUCCESS)
+		throw std::runtime_error("failed to create graphics pipeline!");
+}
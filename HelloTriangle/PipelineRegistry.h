@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <ostream>
+#include <vulkan/vulkan.h>
+#include "ThreadPool.h"
+#include "AssetLoader.h"
+
+enum class EBlendMode
+{
+	Opaque = 0,
+	Alpha,
+	Additive
+};
+
+//NOTE: the fixed-function state that varies between pipelines, everything else comes from the registry's program
+struct SPipelineStateDesc
+{
+	VkPrimitiveTopology		Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	VkPolygonMode			PolygonMode = VK_POLYGON_MODE_FILL;
+	VkCullModeFlags			CullMode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace				FrontFace = VK_FRONT_FACE_CLOCKWISE;
+	EBlendMode				BlendMode = EBlendMode::Opaque;
+	VkSampleCountFlagBits	RasterizationSamples = VK_SAMPLE_COUNT_1_BIT;	//must match the render pass attachments
+	bool					AlphaToCoverage = false;
+	bool					DepthTest = true;		//the render pass always has a depth attachment, so turning the test off only skips it
+	bool					DepthWrite = true;
+	VkCompareOp				DepthCompareOp = VK_COMPARE_OP_LESS;
+
+	bool operator==(const SPipelineStateDesc& vOther) const;
+	size_t hash() const;
+};
+
+//NOTE: the state shared by every variant of a registry, the shader assets are released once their modules exist
+struct SPipelineProgram
+{
+	std::shared_ptr<const CAsset> VertShader;
+	std::shared_ptr<const CAsset> FragShader;
+	std::vector<VkVertexInputBindingDescription>	BindingDescriptions;
+	std::vector<VkVertexInputAttributeDescription>	AttributeDescriptions;
+	VkPipelineLayout	Layout = VK_NULL_HANDLE;
+	VkRenderPass		RenderPass = VK_NULL_HANDLE;
+	uint32_t			Subpass = 0;
+};
+
+class CPipelineRegistry
+{
+public:
+	void create(VkDevice vDevice, VkPipelineCache vPipelineCache, const SPipelineProgram& vProgram);
+	void destroy();
+
+	//NOTE: pipelines are owned by the registry, identical states always map to the same pipeline
+	VkPipeline getPipeline(const SPipelineStateDesc& vState);
+
+	//NOTE: creates the missing variants up front, every worker thread passes its whole batch to one vkCreateGraphicsPipelines call
+	void compileVariants(const std::vector<SPipelineStateDesc>& vStates, CThreadPool& vThreadPool);
+
+	size_t getPipelineCount() const;
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	struct SStateHasher
+	{
+		size_t operator()(const SPipelineStateDesc& vState) const { return vState.hash(); }
+	};
+
+	VkDevice			m_VkDevice = VK_NULL_HANDLE;
+	VkPipelineCache		m_VkPipelineCache = VK_NULL_HANDLE;
+	VkShaderModule		m_VkVertShaderModule = VK_NULL_HANDLE;
+	VkShaderModule		m_VkFragShaderModule = VK_NULL_HANDLE;
+	SPipelineProgram	m_Program;
+
+	std::unordered_map<SPipelineStateDesc, VkPipeline, SStateHasher> m_Pipelines;
+	mutable std::mutex m_Mutex;
+
+	uint64_t m_HitCount = 0;
+	uint64_t m_MissCount = 0;
+	uint64_t m_BatchCount = 0;
+
+	VkShaderModule __createShaderModule(const CAsset& vCode) const;
+	void __createPipelines(const SPipelineStateDesc* vStates, size_t vCount, VkPipeline* voPipelines) const;
+};
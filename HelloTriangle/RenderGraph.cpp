@@ -0,0 +1,539 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	struct SUsageInfo
+	{
+		VkPipelineStageFlags	Stages;
+		VkAccessFlags			Access;
+		VkImageLayout			Layout;
+	};
+
+	//NOTE: indexed by ERenderResourceUsage, the layout is ignored for buffers
+	const SUsageInfo USAGE_INFOS[] =
+	{
+		{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+		{ VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL },
+		{ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+		{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+		{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR },
+	};
+	static_assert(sizeof(USAGE_INFOS) / sizeof(USAGE_INFOS[0]) == static_cast<size_t>(ERenderResourceUsage::Count), "every render resource usage needs its stages, access and layout");
+
+	//NOTE: only writes have to be made available, read bits in a source access mask would just be noise
+	const VkAccessFlags WRITE_ACCESS_FLAGS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT;
+
+	//NOTE: the read stages and access are the readers already ordered after the last write, a write or layout change has to wait for all of them
+	struct SResourceState
+	{
+		VkPipelineStageFlags	WriteStages = 0;
+		VkAccessFlags			WriteAccess = 0;
+		VkPipelineStageFlags	ReadStages = 0;
+		VkAccessFlags			ReadAccess = 0;
+		VkImageLayout			Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool STransientImageDesc::operator==(const STransientImageDesc& vOther) const
+{
+	return Format == vOther.Format && Extent.width == vOther.Extent.width && Extent.height == vOther.Extent.height && Usage == vOther.Usage && Aspect == vOther.Aspect;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::create(VkDevice vDevice, CGpuMemoryAllocator* vAllocator)
+{
+	m_VkDevice = vDevice;
+	m_pAllocator = vAllocator;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::destroy()
+{
+	reset();
+	__destroyTransientImages();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::reset()
+{
+	m_Resources.clear();
+	m_Passes.clear();
+	m_BarrierBatches.clear();
+	m_CulledPassCount = 0;
+	m_BarrierCount = 0;
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CRenderGraph::importImage(const std::string& vName, const std::vector<VkImage>& vImages, VkImageAspectFlags vAspect, ERenderResourceUsage vFinalUsage)
+{
+	SResource Resource;
+	Resource.Name = vName;
+	Resource.Kind = EResourceKind::ImportedImage;
+	Resource.Images = vImages;
+	Resource.Aspect = vAspect;
+	Resource.HasFinalUsage = true;
+	Resource.FinalUsage = vFinalUsage;
+	m_Resources.push_back(Resource);
+	return static_cast<uint32_t>(m_Resources.size() - 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CRenderGraph::importBuffer(const std::string& vName, const std::vector<VkBuffer>& vBuffers)
+{
+	SResource Resource;
+	Resource.Name = vName;
+	Resource.Kind = EResourceKind::ImportedBuffer;
+	Resource.Buffers = vBuffers;
+	m_Resources.push_back(Resource);
+	return static_cast<uint32_t>(m_Resources.size() - 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CRenderGraph::createTransientImage(const std::string& vName, const STransientImageDesc& vDesc)
+{
+	SResource Resource;
+	Resource.Name = vName;
+	Resource.Kind = EResourceKind::TransientImage;
+	Resource.Aspect = vDesc.Aspect;
+	Resource.TransientDesc = vDesc;
+	m_Resources.push_back(Resource);
+	return static_cast<uint32_t>(m_Resources.size() - 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CRenderGraph::addPass(const std::string& vName, const std::function<void(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex)>& vRecord)
+{
+	SPass Pass;
+	Pass.Name = vName;
+	Pass.Record = vRecord;
+	m_Passes.push_back(Pass);
+	return static_cast<uint32_t>(m_Passes.size() - 1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::markPassAsOutput(uint32_t vPass)
+{
+	m_Passes[vPass].IsOutput = true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::readResource(uint32_t vPass, uint32_t vResource, ERenderResourceUsage vUsage)
+{
+	//NOTE: barriers only go between passes, so a pass touching a resource twice would have to order the accesses itself
+	auto& Accesses = m_Passes[vPass].Accesses;
+	if (std::any_of(Accesses.begin(), Accesses.end(), [vResource](const SResourceAccess& vAccess) { return vAccess.Resource == vResource; }))
+		throw std::runtime_error("render graph pass accesses a resource twice!");
+
+	Accesses.push_back({ vResource, vUsage, false });
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::writeResource(uint32_t vPass, uint32_t vResource, ERenderResourceUsage vUsage)
+{
+	auto& Accesses = m_Passes[vPass].Accesses;
+	if (std::any_of(Accesses.begin(), Accesses.end(), [vResource](const SResourceAccess& vAccess) { return vAccess.Resource == vResource; }))
+		throw std::runtime_error("render graph pass accesses a resource twice!");
+
+	Accesses.push_back({ vResource, vUsage, true });
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::compile()
+{
+	__cullPasses();
+
+	std::vector<STransientImage> TransientImages;
+	for (uint32_t PassIndex = 0; PassIndex < m_Passes.size(); ++PassIndex)
+	{
+		const SPass& Pass = m_Passes[PassIndex];
+		if (Pass.IsCulled) continue;
+
+		for (const auto& Access : Pass.Accesses)
+		{
+			SResource& Resource = m_Resources[Access.Resource];
+			if (0 == Resource.FirstUseStages) Resource.FirstUseStages = USAGE_INFOS[static_cast<int>(Access.Usage)].Stages;
+			if (Resource.Kind != EResourceKind::TransientImage) continue;
+
+			auto Iter = std::find_if(TransientImages.begin(), TransientImages.end(), [&Resource](const STransientImage& vImage) { return vImage.Name == Resource.Name; });
+			if (Iter == TransientImages.end())
+			{
+				if (!Access.IsWrite) throw std::runtime_error("render graph reads a transient image before writing it!");
+
+				STransientImage Image;
+				Image.Name = Resource.Name;
+				Image.Desc = Resource.TransientDesc;
+				Image.FirstPass = PassIndex;
+				Iter = TransientImages.insert(TransientImages.end(), Image);
+			}
+			Iter->LastPass = PassIndex;
+			Resource.TransientIndex = static_cast<uint32_t>(Iter - TransientImages.begin());
+		}
+	}
+
+	//NOTE: culling or an extent change moves lifetimes around, any difference at all means the aliasing has to be redone
+	bool IsSamePlan = TransientImages.size() == m_TransientImages.size() && std::equal(TransientImages.begin(), TransientImages.end(), m_TransientImages.begin(),
+		[](const STransientImage& vLhs, const STransientImage& vRhs) { return vLhs.Name == vRhs.Name && vLhs.Desc == vRhs.Desc && vLhs.FirstPass == vRhs.FirstPass && vLhs.LastPass == vRhs.LastPass; });
+	if (!IsSamePlan)
+	{
+		__destroyTransientImages();
+		__allocateTransientImages(TransientImages);
+		m_TransientImages.swap(TransientImages);
+	}
+
+	__buildBarriers();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::execute(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex)
+{
+	size_t BatchIndex = 0;
+	for (uint32_t PassIndex = 0; PassIndex < m_Passes.size(); ++PassIndex)
+	{
+		if (m_Passes[PassIndex].IsCulled) continue;
+
+		for (; BatchIndex < m_BarrierBatches.size() && m_BarrierBatches[BatchIndex].Pass == PassIndex; ++BatchIndex)
+			__recordBarrierBatch(vCommandBuffer, m_BarrierBatches[BatchIndex], vFrame, vImageIndex);
+
+		m_Passes[PassIndex].Record(vCommandBuffer, vFrame, vImageIndex);
+	}
+
+	for (; BatchIndex < m_BarrierBatches.size(); ++BatchIndex) __recordBarrierBatch(vCommandBuffer, m_BarrierBatches[BatchIndex], vFrame, vImageIndex);
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkImageView CRenderGraph::getImageView(uint32_t vResource) const
+{
+	const SResource& Resource = m_Resources[vResource];
+	if (Resource.Kind != EResourceKind::TransientImage || 0 == Resource.FirstUseStages) return VK_NULL_HANDLE;
+
+	return m_TransientImages[Resource.TransientIndex].ImageView;
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkPipelineStageFlags CRenderGraph::getFirstUseStages(uint32_t vResource) const
+{
+	const SResource& Resource = m_Resources[vResource];
+	return Resource.FirstUseStages != 0 ? Resource.FirstUseStages : USAGE_INFOS[static_cast<int>(Resource.FinalUsage)].Stages;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	vOutput << "{ \"passes\": " << m_Passes.size() << ", \"culled_passes\": " << m_CulledPassCount << ", \"barrier_batches\": " << m_BarrierBatches.size()
+		<< ", \"barriers\": " << m_BarrierCount << ", \"transient_images\": " << m_TransientImages.size() << ", \"memory_slots\": " << m_MemorySlots.size()
+		<< ", \"transient_bytes\": " << m_TransientBytes << ", \"aliased_bytes\": " << m_AliasedTransientBytes << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::__cullPasses()
+{
+	//NOTE: walking backwards from the imported outputs, a pass survives only if something later reads what it writes
+	std::vector<bool> IsNeeded(m_Resources.size(), false);
+	for (size_t i = 0; i < m_Resources.size(); ++i) IsNeeded[i] = m_Resources[i].HasFinalUsage;
+
+	m_CulledPassCount = 0;
+	for (size_t i = m_Passes.size(); i-- > 0;)
+	{
+		SPass& Pass = m_Passes[i];
+		Pass.IsCulled = !Pass.IsOutput && std::none_of(Pass.Accesses.begin(), Pass.Accesses.end(), [&IsNeeded](const SResourceAccess& vAccess) { return vAccess.IsWrite && IsNeeded[vAccess.Resource]; });
+		if (Pass.IsCulled)
+		{
+			++m_CulledPassCount;
+			continue;
+		}
+
+		for (const auto& Access : Pass.Accesses)
+		{
+			if (!Access.IsWrite) IsNeeded[Access.Resource] = true;
+		}
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::__allocateTransientImages(std::vector<STransientImage>& vioImages)
+{
+	std::vector<VkMemoryRequirements> Requirements(vioImages.size());
+	for (size_t i = 0; i < vioImages.size(); ++i)
+	{
+		const STransientImageDesc& Desc = vioImages[i].Desc;
+
+		VkImageCreateInfo ImageInfo = {};
+		ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+		ImageInfo.format = Desc.Format;
+		ImageInfo.extent = { Desc.Extent.width, Desc.Extent.height, 1 };
+		ImageInfo.mipLevels = 1;
+		ImageInfo.arrayLayers = 1;
+		ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		ImageInfo.usage = Desc.Usage;
+		ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(m_VkDevice, &ImageInfo, nullptr, &vioImages[i].Image) != VK_SUCCESS)
+			throw std::runtime_error("failed to create transient image!");
+		vkGetImageMemoryRequirements(m_VkDevice, vioImages[i].Image, &Requirements[i]);
+	}
+
+	//NOTE: largest first, each image joins the first slot whose images are all dead by the time it is written and that offers a compatible memory type
+	std::vector<uint32_t> Order(vioImages.size());
+	for (uint32_t i = 0; i < Order.size(); ++i) Order[i] = i;
+	std::stable_sort(Order.begin(), Order.end(), [&Requirements](uint32_t vLhs, uint32_t vRhs) { return Requirements[vLhs].size > Requirements[vRhs].size; });
+
+	m_TransientBytes = 0;
+	for (uint32_t ImageIndex : Order)
+	{
+		STransientImage& Image = vioImages[ImageIndex];
+		const VkMemoryRequirements& ImageRequirements = Requirements[ImageIndex];
+		m_TransientBytes += ImageRequirements.size;
+
+		auto Slot = std::find_if(m_MemorySlots.begin(), m_MemorySlots.end(), [&](const SMemorySlot& vSlot)
+		{
+			if (0 == (vSlot.Requirements.memoryTypeBits & ImageRequirements.memoryTypeBits)) return false;
+			return std::none_of(vSlot.Images.begin(), vSlot.Images.end(), [&](uint32_t vOther) { return Image.FirstPass <= vioImages[vOther].LastPass && vioImages[vOther].FirstPass <= Image.LastPass; });
+		});
+
+		if (Slot == m_MemorySlots.end())
+		{
+			Slot = m_MemorySlots.insert(m_MemorySlots.end(), SMemorySlot());
+			Slot->Requirements = ImageRequirements;
+		}
+		else
+		{
+			Slot->Requirements.size = std::max(Slot->Requirements.size, ImageRequirements.size);
+			Slot->Requirements.alignment = std::max(Slot->Requirements.alignment, ImageRequirements.alignment);
+			Slot->Requirements.memoryTypeBits &= ImageRequirements.memoryTypeBits;
+		}
+
+		Image.MemorySlot = static_cast<uint32_t>(Slot - m_MemorySlots.begin());
+		Slot->Images.push_back(ImageIndex);
+	}
+
+	m_AliasedTransientBytes = 0;
+	for (auto& Slot : m_MemorySlots)
+	{
+		std::sort(Slot.Images.begin(), Slot.Images.end(), [&vioImages](uint32_t vLhs, uint32_t vRhs) { return vioImages[vLhs].FirstPass < vioImages[vRhs].FirstPass; });
+
+		Slot.Allocation = m_pAllocator->allocate(Slot.Requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EGpuResourceKind::Optimal);
+		m_AliasedTransientBytes += Slot.Requirements.size;
+
+		for (uint32_t ImageIndex : Slot.Images)
+		{
+			STransientImage& Image = vioImages[ImageIndex];
+			if (vkBindImageMemory(m_VkDevice, Image.Image, Slot.Allocation.Memory, Slot.Allocation.Offset) != VK_SUCCESS)
+				throw std::runtime_error("failed to bind transient image memory!");
+
+			VkImageViewCreateInfo ViewInfo = {};
+			ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			ViewInfo.image = Image.Image;
+			ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			ViewInfo.format = Image.Desc.Format;
+			ViewInfo.subresourceRange.aspectMask = Image.Desc.Aspect;
+			ViewInfo.subresourceRange.baseMipLevel = 0;
+			ViewInfo.subresourceRange.levelCount = 1;
+			ViewInfo.subresourceRange.baseArrayLayer = 0;
+			ViewInfo.subresourceRange.layerCount = 1;
+
+			if (vkCreateImageView(m_VkDevice, &ViewInfo, nullptr, &Image.ImageView) != VK_SUCCESS)
+				throw std::runtime_error("failed to create transient image view!");
+		}
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::__destroyTransientImages()
+{
+	for (auto& Image : m_TransientImages)
+	{
+		vkDestroyImageView(m_VkDevice, Image.ImageView, nullptr);
+		vkDestroyImage(m_VkDevice, Image.Image, nullptr);
+	}
+	for (auto& Slot : m_MemorySlots) m_pAllocator->free(Slot.Allocation);
+
+	m_TransientImages.clear();
+	m_MemorySlots.clear();
+	m_TransientBytes = 0;
+	m_AliasedTransientBytes = 0;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::__buildBarriers()
+{
+	m_BarrierBatches.clear();
+	m_BarrierCount = 0;
+
+	std::vector<SResourceState> States(m_Resources.size());
+
+	//NOTE: the first pass over the frame only finds where every resource ends up, the second one emits the barriers
+	auto applyAccesses = [this, &States](bool vEmit)
+	{
+		for (uint32_t PassIndex = 0; PassIndex < m_Passes.size(); ++PassIndex)
+		{
+			if (m_Passes[PassIndex].IsCulled) continue;
+
+			SBarrierBatch Batch;
+			Batch.Pass = PassIndex;
+			for (const auto& Access : m_Passes[PassIndex].Accesses)
+			{
+				const SUsageInfo& Usage = USAGE_INFOS[static_cast<int>(Access.Usage)];
+				SResourceState& State = States[Access.Resource];
+				bool IsImage = m_Resources[Access.Resource].Kind != EResourceKind::ImportedBuffer;
+				bool IsLayoutChange = IsImage && State.Layout != Usage.Layout;
+
+				SBarrier Barrier = { Access.Resource, State.WriteAccess, Usage.Access, State.Layout, IsImage ? Usage.Layout : VK_IMAGE_LAYOUT_UNDEFINED };
+				VkPipelineStageFlags SrcStages = 0;
+				bool IsBarrierNeeded = false;
+
+				if (Access.IsWrite || IsLayoutChange)
+				{
+					//NOTE: write after read only needs the readers to finish, their access never has to be made available
+					SrcStages = State.WriteStages | State.ReadStages;
+					IsBarrierNeeded = SrcStages != 0 || IsLayoutChange;
+
+					State.WriteStages = Usage.Stages;
+					State.WriteAccess = Access.IsWrite ? Usage.Access & WRITE_ACCESS_FLAGS : 0;
+					State.ReadStages = Access.IsWrite ? 0 : Usage.Stages;
+					State.ReadAccess = Access.IsWrite ? 0 : Usage.Access;
+					State.Layout = Barrier.NewLayout;
+				}
+				else if ((State.ReadStages & Usage.Stages) != Usage.Stages || (State.ReadAccess & Usage.Access) != Usage.Access)
+				{
+					SrcStages = State.WriteStages;
+					IsBarrierNeeded = SrcStages != 0;
+
+					State.ReadStages |= Usage.Stages;
+					State.ReadAccess |= Usage.Access;
+				}
+
+				if (!vEmit || !IsBarrierNeeded) continue;
+
+				Batch.SrcStages |= SrcStages != 0 ? SrcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				Batch.DstStages |= Usage.Stages;
+				Batch.Barriers.push_back(Barrier);
+			}
+
+			if (!Batch.Barriers.empty()) m_BarrierBatches.push_back(Batch);
+		}
+	};
+
+	applyAccesses(false);
+	std::vector<SResourceState> FinalStates = States;
+
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		const SResource& Resource = m_Resources[i];
+		States[i] = SResourceState();
+
+		//NOTE: an imported image is first touched at the stage its acquire semaphore blocks, so the first layout change chains onto the semaphore wait
+		if (Resource.Kind == EResourceKind::ImportedImage) States[i].WriteStages = Resource.FirstUseStages;
+		if (Resource.Kind != EResourceKind::TransientImage || 0 == Resource.FirstUseStages) continue;
+
+		//NOTE: a transient image inherits the memory from whichever image of its slot ran last, in this frame or in the frame before
+		const SMemorySlot& Slot = m_MemorySlots[m_TransientImages[Resource.TransientIndex].MemorySlot];
+		auto Position = std::find(Slot.Images.begin(), Slot.Images.end(), Resource.TransientIndex) - Slot.Images.begin();
+		uint32_t PreviousImage = Slot.Images[(Position + Slot.Images.size() - 1) % Slot.Images.size()];
+
+		for (size_t k = 0; k < m_Resources.size(); ++k)
+		{
+			if (m_Resources[k].Kind != EResourceKind::TransientImage || 0 == m_Resources[k].FirstUseStages || m_Resources[k].TransientIndex != PreviousImage) continue;
+
+			States[i].WriteStages = FinalStates[k].WriteStages | FinalStates[k].ReadStages;
+			States[i].WriteAccess = FinalStates[k].WriteAccess;
+		}
+	}
+
+	applyAccesses(true);
+
+	SBarrierBatch FinalBatch;
+	FinalBatch.Pass = static_cast<uint32_t>(m_Passes.size());
+	for (uint32_t i = 0; i < m_Resources.size(); ++i)
+	{
+		const SResource& Resource = m_Resources[i];
+		if (!Resource.HasFinalUsage || 0 == Resource.FirstUseStages) continue;
+
+		//NOTE: the last pass may already have left the image the way it is consumed, e.g. a readback copying the frame the headless path copies again
+		const SUsageInfo& Usage = USAGE_INFOS[static_cast<int>(Resource.FinalUsage)];
+		const SResourceState& State = States[i];
+		if (State.Layout == Usage.Layout && 0 == State.WriteAccess && (State.ReadStages & Usage.Stages) == Usage.Stages && (State.ReadAccess & Usage.Access) == Usage.Access) continue;
+
+		FinalBatch.SrcStages |= State.WriteStages | State.ReadStages;
+		FinalBatch.DstStages |= Usage.Stages;
+		FinalBatch.Barriers.push_back({ i, State.WriteAccess, Usage.Access, State.Layout, Usage.Layout });
+	}
+	if (!FinalBatch.Barriers.empty()) m_BarrierBatches.push_back(FinalBatch);
+
+	for (const auto& Batch : m_BarrierBatches) m_BarrierCount += static_cast<uint32_t>(Batch.Barriers.size());
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CRenderGraph::__recordBarrierBatch(VkCommandBuffer vCommandBuffer, const SBarrierBatch& vBatch, uint32_t vFrame, uint32_t vImageIndex)
+{
+	m_ImageBarriers.clear();
+	m_BufferBarriers.clear();
+
+	for (const auto& Barrier : vBatch.Barriers)
+	{
+		const SResource& Resource = m_Resources[Barrier.Resource];
+		if (Resource.Kind == EResourceKind::ImportedBuffer)
+		{
+			VkBufferMemoryBarrier BufferBarrier = {};
+			BufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			BufferBarrier.srcAccessMask = Barrier.SrcAccess;
+			BufferBarrier.dstAccessMask = Barrier.DstAccess;
+			BufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			BufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			BufferBarrier.buffer = Resource.Buffers[vFrame];
+			BufferBarrier.offset = 0;
+			BufferBarrier.size = VK_WHOLE_SIZE;
+			m_BufferBarriers.push_back(BufferBarrier);
+			continue;
+		}
+
+		VkImageMemoryBarrier ImageBarrier = {};
+		ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		ImageBarrier.srcAccessMask = Barrier.SrcAccess;
+		ImageBarrier.dstAccessMask = Barrier.DstAccess;
+		ImageBarrier.oldLayout = Barrier.OldLayout;
+		ImageBarrier.newLayout = Barrier.NewLayout;
+		ImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarrier.image = Resource.Kind == EResourceKind::ImportedImage ? Resource.Images[vImageIndex] : m_TransientImages[Resource.TransientIndex].Image;
+		ImageBarrier.subresourceRange.aspectMask = Resource.Aspect;
+		ImageBarrier.subresourceRange.baseMipLevel = 0;
+		ImageBarrier.subresourceRange.levelCount = 1;
+		ImageBarrier.subresourceRange.baseArrayLayer = 0;
+		ImageBarrier.subresourceRange.layerCount = 1;
+		m_ImageBarriers.push_back(ImageBarrier);
+	}
+
+	vkCmdPipelineBarrier(vCommandBuffer, vBatch.SrcStages, vBatch.DstStages, 0, 0, nullptr,
+		static_cast<uint32_t>(m_BufferBarriers.size()), m_BufferBarriers.data(), static_cast<uint32_t>(m_ImageBarriers.size()), m_ImageBarriers.data());
+}
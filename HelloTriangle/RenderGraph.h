@@ -0,0 +1,161 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include <ostream>
+#include <vulkan/vulkan.h>
+#include "GpuMemoryAllocator.h"
+
+enum class ERenderResourceUsage
+{
+	ColorAttachmentWrite = 0,
+	DepthAttachmentWrite,
+	FragmentShaderRead,
+	ComputeShaderRead,
+	ComputeShaderWrite,
+	IndirectRead,
+	TransferRead,
+	TransferWrite,
+	Present,
+	Count
+};
+
+struct STransientImageDesc
+{
+	VkFormat			Format = VK_FORMAT_UNDEFINED;
+	VkExtent2D			Extent = { 0, 0 };
+	VkImageUsageFlags	Usage = 0;
+	VkImageAspectFlags	Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+	bool operator==(const STransientImageDesc& vOther) const;
+};
+
+//NOTE: passes run in declaration order; compiling culls the passes nothing reads from, precomputes the barriers between the survivors and lets transient images whose lifetimes do not overlap share memory
+class CRenderGraph
+{
+public:
+	void create(VkDevice vDevice, CGpuMemoryAllocator* vAllocator);
+	void destroy();
+
+	//NOTE: drops every pass and resource declaration, transient images survive until a compile needs a different set of them
+	void reset();
+
+	//NOTE: imported images are picked per image index and imported buffers per frame in flight when the graph is executed
+	uint32_t importImage(const std::string& vName, const std::vector<VkImage>& vImages, VkImageAspectFlags vAspect, ERenderResourceUsage vFinalUsage);
+	uint32_t importBuffer(const std::string& vName, const std::vector<VkBuffer>& vBuffers);
+	uint32_t createTransientImage(const std::string& vName, const STransientImageDesc& vDesc);
+
+	uint32_t addPass(const std::string& vName, const std::function<void(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex)>& vRecord);
+	void readResource(uint32_t vPass, uint32_t vResource, ERenderResourceUsage vUsage);
+	void writeResource(uint32_t vPass, uint32_t vResource, ERenderResourceUsage vUsage);
+
+	//NOTE: for passes whose results leave the graph some other way, like copies to host memory, culling always keeps them
+	void markPassAsOutput(uint32_t vPass);
+
+	//NOTE: when the transient images change the caller must make sure no frame still using the old ones is in flight
+	void compile();
+	void execute(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex);
+
+	VkImageView getImageView(uint32_t vResource) const;
+
+	//NOTE: the stages a semaphore guarding an imported image has to block, the first barrier on the image chains onto them
+	VkPipelineStageFlags getFirstUseStages(uint32_t vResource) const;
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	enum class EResourceKind
+	{
+		ImportedImage = 0,
+		ImportedBuffer,
+		TransientImage
+	};
+
+	struct SResource
+	{
+		std::string				Name;
+		EResourceKind			Kind = EResourceKind::ImportedImage;
+		std::vector<VkImage>	Images;
+		std::vector<VkBuffer>	Buffers;
+		VkImageAspectFlags		Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		bool					HasFinalUsage = false;
+		ERenderResourceUsage	FinalUsage = ERenderResourceUsage::Present;
+		STransientImageDesc		TransientDesc;
+		uint32_t				TransientIndex = 0;
+		VkPipelineStageFlags	FirstUseStages = 0;
+	};
+
+	struct SResourceAccess
+	{
+		uint32_t				Resource;
+		ERenderResourceUsage	Usage;
+		bool					IsWrite;
+	};
+
+	struct SPass
+	{
+		std::string Name;
+		std::function<void(VkCommandBuffer vCommandBuffer, uint32_t vFrame, uint32_t vImageIndex)> Record;
+		std::vector<SResourceAccess> Accesses;
+		bool IsOutput = false;
+		bool IsCulled = false;
+	};
+
+	struct SBarrier
+	{
+		uint32_t		Resource;
+		VkAccessFlags	SrcAccess;
+		VkAccessFlags	DstAccess;
+		VkImageLayout	OldLayout;
+		VkImageLayout	NewLayout;
+	};
+
+	struct SBarrierBatch
+	{
+		uint32_t				Pass;		//the batch is recorded right before this pass, the pass count stands for the end of the frame
+		VkPipelineStageFlags	SrcStages = 0;
+		VkPipelineStageFlags	DstStages = 0;
+		std::vector<SBarrier>	Barriers;
+	};
+
+	struct STransientImage
+	{
+		std::string			Name;
+		STransientImageDesc	Desc;
+		uint32_t			FirstPass = 0;
+		uint32_t			LastPass = 0;
+		uint32_t			MemorySlot = 0;
+		VkImage				Image = VK_NULL_HANDLE;
+		VkImageView			ImageView = VK_NULL_HANDLE;
+	};
+
+	struct SMemorySlot
+	{
+		VkMemoryRequirements	Requirements = {};
+		SGpuAllocation			Allocation;
+		std::vector<uint32_t>	Images;		//ordered by first use
+	};
+
+	VkDevice				m_VkDevice = VK_NULL_HANDLE;
+	CGpuMemoryAllocator*	m_pAllocator = nullptr;
+
+	std::vector<SResource>		m_Resources;
+	std::vector<SPass>			m_Passes;
+	std::vector<SBarrierBatch>	m_BarrierBatches;
+	std::vector<STransientImage> m_TransientImages;
+	std::vector<SMemorySlot>	m_MemorySlots;
+
+	std::vector<VkImageMemoryBarrier>	m_ImageBarriers;
+	std::vector<VkBufferMemoryBarrier>	m_BufferBarriers;
+
+	uint32_t		m_CulledPassCount = 0;
+	uint32_t		m_BarrierCount = 0;
+	VkDeviceSize	m_TransientBytes = 0;
+	VkDeviceSize	m_AliasedTransientBytes = 0;
+
+	void __cullPasses();
+	void __allocateTransientImages(std::vector<STransientImage>& vioImages);
+	void __destroyTransientImages();
+	void __buildBarriers();
+	void __recordBarrierBatch(VkCommandBuffer vCommandBuffer, const SBarrierBatch& vBatch, uint32_t vFrame, uint32_t vImageIndex);
+};
@@ -0,0 +1,216 @@
+#include "ShaderHotReloader.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+
+namespace
+{
+	const std::chrono::milliseconds WATCH_INTERVAL(100);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static bool __readFile(const std::string& vFilename, std::vector<char>& voData)
+{
+	std::ifstream File(vFilename, std::ios::ate | std::ios::binary);
+	if (!File.is_open()) return false;
+
+	voData.resize(static_cast<size_t>(File.tellg()));
+	File.seekg(0);
+	File.read(voData.data(), voData.size());
+
+	return File.good();
+}
+
+//******************************************************************************************
+//FUNCTION:
+static bool __replaceFile(const std::string& vFilename, const std::vector<char>& vData)
+{
+	//NOTE: write next to the target and rename over it, so the render thread never loads a half written file
+	std::string TempFilename = vFilename + ".tmp";
+	{
+		std::ofstream File(TempFilename, std::ios::binary | std::ios::trunc);
+		if (!File.is_open()) return false;
+
+		File.write(vData.data(), vData.size());
+		if (!File.good()) return false;
+	}
+
+	std::error_code ErrorCode;
+	std::filesystem::rename(TempFilename, vFilename, ErrorCode);
+	return !ErrorCode;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static uint64_t __hashContent(const std::vector<char>& vData, const std::string& vExtension)
+{
+	//NOTE: FNV-1a, the extension is part of the key because it selects the shader stage
+	uint64_t Hash = 14695981039346656037ull;
+	auto combine = [&Hash](char vByte) { Hash = (Hash ^ static_cast<uint8_t>(vByte)) * 1099511628211ull; };
+
+	for (char Byte : vExtension) combine(Byte);
+	for (char Byte : vData) combine(Byte);
+
+	return Hash;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CShaderHotReloader::start(const std::vector<SShaderSource>& vSources, const std::string& vCacheDirectory)
+{
+	stop();
+
+	m_Shaders.clear();
+	for (const auto& Source : vSources) m_Shaders.push_back({ Source, {}, false });
+	m_CacheDirectory = vCacheDirectory;
+
+	std::error_code ErrorCode;
+	std::filesystem::create_directories(m_CacheDirectory, ErrorCode);
+	if (ErrorCode) std::cerr << "failed to create shader cache directory " << m_CacheDirectory << ": " << ErrorCode.message() << std::endl;
+
+	m_IsStopping = false;
+	m_Thread = std::thread(&CShaderHotReloader::__watchLoop, this);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CShaderHotReloader::stop()
+{
+	if (!m_Thread.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_StopSignal.notify_all();
+	m_Thread.join();
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CShaderHotReloader::consumeUpdate(std::chrono::steady_clock::time_point& voDetectTime)
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	if (!m_IsUpdatePending) return false;
+
+	m_IsUpdatePending = false;
+	voDetectTime = m_DetectTime;
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CShaderHotReloader::dumpStatisticsJson(std::ostream& vOutput) const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	vOutput << "{ \"compiles\": " << m_CompileCount << ", \"cache_hits\": " << m_CacheHitCount << ", \"failures\": " << m_FailureCount
+		<< ", \"last_compile_ms\": " << m_LastCompileTime << " }";
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CShaderHotReloader::__watchLoop()
+{
+	while (true)
+	{
+		//NOTE: plain polling of the write times, there is no portable change notification and a stat per source is cheap
+		auto DetectTime = std::chrono::steady_clock::now();
+		bool IsChanged = false;
+
+		for (auto& Shader : m_Shaders)
+		{
+			std::error_code ErrorCode;
+			auto WriteTime = std::filesystem::last_write_time(Shader.Source.SourceFile, ErrorCode);
+			if (ErrorCode || (Shader.IsScanned && WriteTime == Shader.LastWriteTime)) continue;
+
+			Shader.LastWriteTime = WriteTime;
+			Shader.IsScanned = true;
+			if (__processShader(Shader.Source)) IsChanged = true;
+		}
+
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		if (IsChanged)
+		{
+			m_IsUpdatePending = true;
+			m_DetectTime = DetectTime;
+		}
+
+		m_StopSignal.wait_for(Lock, WATCH_INTERVAL, [this]() { return m_IsStopping; });
+		if (m_IsStopping) return;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CShaderHotReloader::__processShader(const SShaderSource& vSource)
+{
+	std::vector<char> SourceCode;
+	if (!__readFile(vSource.SourceFile, SourceCode)) return false;
+
+	std::ostringstream CacheFile;
+	CacheFile << m_CacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0')
+		<< __hashContent(SourceCode, std::filesystem::path(vSource.SourceFile).extension().string()) << ".spv";
+
+	std::vector<char> Spirv;
+	if (__readFile(CacheFile.str(), Spirv) && !Spirv.empty())
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		++m_CacheHitCount;
+	}
+	else
+	{
+		auto StartTime = std::chrono::steady_clock::now();
+		bool IsCompiled = __compile(vSource.SourceFile, CacheFile.str()) && __readFile(CacheFile.str(), Spirv);
+
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		if (!IsCompiled)
+		{
+			++m_FailureCount;
+			return false;
+		}
+		++m_CompileCount;
+		m_LastCompileTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	}
+
+	//NOTE: saving a file without touching the code must not rebuild the pipeline
+	std::vector<char> CurrentSpirv;
+	if (__readFile(vSource.SpirvFile, CurrentSpirv) && CurrentSpirv == Spirv) return false;
+
+	if (!__replaceFile(vSource.SpirvFile, Spirv))
+	{
+		std::cerr << "failed to write " << vSource.SpirvFile << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+//******************************************************************************************
+//FUNCTION:
+bool CShaderHotReloader::__compile(const std::string& vSourceFile, const std::string& vSpirvFile) const
+{
+	//NOTE: the same compiler shaders/compile.bat runs, from the VULKAN sdk if it is set and from the PATH otherwise
+	const char* pVulkanSdk = std::getenv("VULKAN");
+	std::string Compiler = pVulkanSdk ? std::string(pVulkanSdk) + "/bin/glslangValidator" : "glslangValidator";
+
+	std::string TempSpirvFile = vSpirvFile + ".tmp";
+	std::string Command = "\"" + Compiler + "\" -V \"" + vSourceFile + "\" -o \"" + TempSpirvFile + "\"";
+#ifdef _WIN32
+	//NOTE: cmd.exe strips the outermost pair of quotes
+	Command = "\"" + Command + "\"";
+#endif
+
+	if (std::system(Command.c_str()) != 0)
+	{
+		std::cerr << "failed to compile shader: " << vSourceFile << std::endl;
+		return false;
+	}
+
+	std::error_code ErrorCode;
+	std::filesystem::rename(TempSpirvFile, vSpirvFile, ErrorCode);
+	return !ErrorCode;
+}
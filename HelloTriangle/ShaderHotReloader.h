@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <filesystem>
+#include <ostream>
+
+struct SShaderSource
+{
+	std::string SourceFile;
+	std::string SpirvFile;
+};
+
+class CShaderHotReloader
+{
+public:
+	~CShaderHotReloader() { stop(); }
+
+	//NOTE: SPIR-V is cached by source content in vCacheDirectory, so reverting an edit never recompiles
+	void start(const std::vector<SShaderSource>& vSources, const std::string& vCacheDirectory);
+	void stop();
+
+	bool isStarted() const { return m_Thread.joinable(); }
+
+	//NOTE: polled by the render loop between frames, true once for every batch of rewritten SPIR-V files
+	bool consumeUpdate(std::chrono::steady_clock::time_point& voDetectTime);
+
+	void dumpStatisticsJson(std::ostream& vOutput) const;
+
+private:
+	struct SWatchedShader
+	{
+		SShaderSource	Source;
+		std::filesystem::file_time_type LastWriteTime;
+		bool			IsScanned = false;
+	};
+
+	std::vector<SWatchedShader>	m_Shaders;
+	std::string					m_CacheDirectory;
+	std::thread					m_Thread;
+	mutable std::mutex			m_Mutex;
+	std::condition_variable		m_StopSignal;
+	bool						m_IsStopping = false;
+	bool						m_IsUpdatePending = false;
+	std::chrono::steady_clock::time_point m_DetectTime;
+
+	uint64_t	m_CompileCount = 0;
+	uint64_t	m_CacheHitCount = 0;
+	uint64_t	m_FailureCount = 0;
+	double		m_LastCompileTime = 0.0;
+
+	void __watchLoop();
+	bool __processShader(const SShaderSource& vSource);
+	bool __compile(const std::string& vSourceFile, const std::string& vSpirvFile) const;
+};
@@ -0,0 +1,234 @@
+#include "StreamingUploader.h"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	const VkDeviceSize STAGING_ALIGNMENT = 16;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static VkDeviceSize __alignToStaging(VkDeviceSize vSize)
+{
+	return (vSize + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::create(VkDevice vDevice, CGpuMemoryAllocator* vAllocator, VkQueue vTransferQueue, uint32_t vTransferFamily, uint32_t vGraphicsFamily, uint32_t vFrameCount, VkDeviceSize vStagingSize)
+{
+	m_VkDevice = vDevice;
+	m_pAllocator = vAllocator;
+	m_VkTransferQueue = vTransferQueue;
+	m_TransferFamily = vTransferFamily;
+	m_GraphicsFamily = vGraphicsFamily;
+	m_FrameResources.resize(vFrameCount);
+
+	VkCommandPoolCreateInfo PoolInfo = {};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	PoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	PoolInfo.queueFamilyIndex = m_TransferFamily;
+
+	VkSemaphoreCreateInfo SemaphoreInfo = {};
+	SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	for (auto& Frame : m_FrameResources)
+	{
+		if (vkCreateCommandPool(m_VkDevice, &PoolInfo, nullptr, &Frame.CommandPool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create upload command pool!");
+
+		VkCommandBufferAllocateInfo AllocInfo = {};
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = Frame.CommandPool;
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		AllocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers(m_VkDevice, &AllocInfo, &Frame.CommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate upload command buffer!");
+
+		if (vkCreateSemaphore(m_VkDevice, &SemaphoreInfo, nullptr, &Frame.Semaphore) != VK_SUCCESS)
+			throw std::runtime_error("failed to create upload semaphore!");
+	}
+
+	__createStagingBuffer(vStagingSize);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::destroy()
+{
+	if (!isCreated()) return;
+
+	for (auto& Frame : m_FrameResources)
+	{
+		vkDestroySemaphore(m_VkDevice, Frame.Semaphore, nullptr);
+		vkDestroyCommandPool(m_VkDevice, Frame.CommandPool, nullptr);
+	}
+	m_FrameResources.clear();
+
+	if (m_VkStagingBuffer != VK_NULL_HANDLE) m_pAllocator->destroyBuffer(m_VkStagingBuffer, m_StagingAllocation);
+	m_VkDevice = VK_NULL_HANDLE;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::ensureCapacity(VkDeviceSize vUploadSize, uint32_t vUploadsPerFrame)
+{
+	//NOTE: every range is rounded up on its own and never wraps, so on top of the aligned ranges of all frames the ring can lose up to one range at its end
+	VkDeviceSize AlignedSize = __alignToStaging(vUploadSize);
+	VkDeviceSize LiveSize = AlignedSize * vUploadsPerFrame * m_FrameResources.size();
+	VkDeviceSize RequiredSize = LiveSize + AlignedSize;
+	if (RequiredSize > m_StagingSize)
+	{
+		m_pAllocator->destroyBuffer(m_VkStagingBuffer, m_StagingAllocation);
+		__createStagingBuffer(RequiredSize);
+	}
+
+	if (m_StagingSize < RequiredSize) throw std::runtime_error("streaming staging ring cannot hold the uploads of every frame in flight!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::beginFrame(uint32_t vFrame)
+{
+	m_CurrentFrame = vFrame;
+	SFrameResources& Frame = m_FrameResources[vFrame];
+
+	//NOTE: frames retire in submission order, so everything staged up to the end of this frame's previous use is free again
+	m_RingTail = std::max(m_RingTail, Frame.RingEnd);
+	Frame.RingEnd = m_RingHead;
+	Frame.DstStages = 0;
+	Frame.IsRecording = false;
+	Frame.HasPendingAcquire = false;
+	Frame.ReleaseBarriers.clear();
+	Frame.AcquireBarriers.clear();
+
+	vkResetCommandPool(m_VkDevice, Frame.CommandPool, 0);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::upload(VkBuffer vDstBuffer, VkDeviceSize vDstOffset, const void* vData, VkDeviceSize vSize, VkAccessFlags vDstAccess, VkPipelineStageFlags vDstStage)
+{
+	SFrameResources& Frame = m_FrameResources[m_CurrentFrame];
+
+	if (!Frame.IsRecording)
+	{
+		VkCommandBufferBeginInfo BeginInfo = {};
+		BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		if (vkBeginCommandBuffer(Frame.CommandBuffer, &BeginInfo) != VK_SUCCESS)
+			throw std::runtime_error("failed to begin recording upload command buffer!");
+		Frame.IsRecording = true;
+	}
+
+	VkDeviceSize StagingOffset = __allocateFromRing(vSize);
+	Frame.RingEnd = m_RingHead;
+	memcpy(static_cast<char*>(m_StagingAllocation.pMappedData) + StagingOffset, vData, static_cast<size_t>(vSize));
+
+	VkBufferCopy CopyRegion = {};
+	CopyRegion.srcOffset = StagingOffset;
+	CopyRegion.dstOffset = vDstOffset;
+	CopyRegion.size = vSize;
+	vkCmdCopyBuffer(Frame.CommandBuffer, m_VkStagingBuffer, vDstBuffer, 1, &CopyRegion);
+
+	Frame.DstStages |= vDstStage;
+	if (!isOnSeparateQueueFamily()) return;
+
+	//NOTE: the buffers are exclusive to one family, the release here and the acquire on the graphics queue hand the written range over
+	VkBufferMemoryBarrier Barrier = {};
+	Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	Barrier.dstAccessMask = 0;
+	Barrier.srcQueueFamilyIndex = m_TransferFamily;
+	Barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+	Barrier.buffer = vDstBuffer;
+	Barrier.offset = vDstOffset;
+	Barrier.size = vSize;
+	Frame.ReleaseBarriers.push_back(Barrier);
+
+	Barrier.srcAccessMask = 0;
+	Barrier.dstAccessMask = vDstAccess;
+	Frame.AcquireBarriers.push_back(Barrier);
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkSemaphore CStreamingUploader::submit(VkPipelineStageFlags& voWaitStage)
+{
+	SFrameResources& Frame = m_FrameResources[m_CurrentFrame];
+	if (!Frame.IsRecording) return VK_NULL_HANDLE;
+
+	if (!Frame.ReleaseBarriers.empty())
+	{
+		vkCmdPipelineBarrier(Frame.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+			static_cast<uint32_t>(Frame.ReleaseBarriers.size()), Frame.ReleaseBarriers.data(), 0, nullptr);
+	}
+
+	if (vkEndCommandBuffer(Frame.CommandBuffer) != VK_SUCCESS)
+		throw std::runtime_error("failed to record upload command buffer!");
+	Frame.IsRecording = false;
+
+	//NOTE: no fence is needed, the graphics submission waits on the semaphore and its frame fence covers the upload as well
+	VkSubmitInfo SubmitInfo = {};
+	SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	SubmitInfo.commandBufferCount = 1;
+	SubmitInfo.pCommandBuffers = &Frame.CommandBuffer;
+	SubmitInfo.signalSemaphoreCount = 1;
+	SubmitInfo.pSignalSemaphores = &Frame.Semaphore;
+
+	if (vkQueueSubmit(m_VkTransferQueue, 1, &SubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		throw std::runtime_error("failed to submit upload command buffer!");
+
+	Frame.HasPendingAcquire = true;
+	voWaitStage = Frame.DstStages;
+	return Frame.Semaphore;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::recordAcquireBarriers(VkCommandBuffer vCommandBuffer, uint32_t vFrame)
+{
+	SFrameResources& Frame = m_FrameResources[vFrame];
+	if (!Frame.HasPendingAcquire) return;
+	Frame.HasPendingAcquire = false;
+
+	if (Frame.AcquireBarriers.empty()) return;
+
+	//NOTE: the source stages match the semaphore wait stages, which chains the acquire to the upload
+	vkCmdPipelineBarrier(vCommandBuffer, Frame.DstStages, Frame.DstStages, 0, 0, nullptr,
+		static_cast<uint32_t>(Frame.AcquireBarriers.size()), Frame.AcquireBarriers.data(), 0, nullptr);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CStreamingUploader::__createStagingBuffer(VkDeviceSize vStagingSize)
+{
+	m_StagingSize = __alignToStaging(vStagingSize);
+	m_pAllocator->createBuffer(m_StagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_VkStagingBuffer, m_StagingAllocation);
+
+	m_RingHead = 0;
+	m_RingTail = 0;
+	for (auto& Frame : m_FrameResources) Frame.RingEnd = 0;
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkDeviceSize CStreamingUploader::__allocateFromRing(VkDeviceSize vSize)
+{
+	VkDeviceSize AlignedSize = __alignToStaging(vSize);
+
+	//NOTE: a range never wraps around the end of the staging buffer, the remainder is skipped instead
+	VkDeviceSize Head = m_RingHead;
+	VkDeviceSize Position = Head % m_StagingSize;
+	if (Position + AlignedSize > m_StagingSize) Head += m_StagingSize - Position;
+
+	if (Head + AlignedSize - m_RingTail > m_StagingSize)
+		throw std::runtime_error("streaming staging ring is full!");
+
+	m_RingHead = Head + AlignedSize;
+	return Head % m_StagingSize;
+}
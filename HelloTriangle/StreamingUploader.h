@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan.h>
+#include "GpuMemoryAllocator.h"
+
+class CStreamingUploader
+{
+public:
+	void create(VkDevice vDevice, CGpuMemoryAllocator* vAllocator, VkQueue vTransferQueue, uint32_t vTransferFamily, uint32_t vGraphicsFamily, uint32_t vFrameCount, VkDeviceSize vStagingSize);
+	void destroy();
+
+	//NOTE: recreates the staging ring if it cannot take vUploadsPerFrame uploads of up to vUploadSize bytes in every frame in flight, the caller must make sure no upload is in flight
+	void ensureCapacity(VkDeviceSize vUploadSize, uint32_t vUploadsPerFrame = 1);
+
+	//NOTE: must only be called once the graphics work of the frame's previous use has completed, that is what frees its part of the ring
+	void beginFrame(uint32_t vFrame);
+	void upload(VkBuffer vDstBuffer, VkDeviceSize vDstOffset, const void* vData, VkDeviceSize vSize, VkAccessFlags vDstAccess, VkPipelineStageFlags vDstStage);
+
+	//NOTE: returns the semaphore the graphics submission of this frame has to wait on at voWaitStage, VK_NULL_HANDLE when nothing was uploaded
+	VkSemaphore submit(VkPipelineStageFlags& voWaitStage);
+	void recordAcquireBarriers(VkCommandBuffer vCommandBuffer, uint32_t vFrame);
+
+	bool isCreated() const { return m_VkDevice != VK_NULL_HANDLE; }
+	bool isOnSeparateQueueFamily() const { return m_TransferFamily != m_GraphicsFamily; }
+	VkDeviceSize getStagingSize() const { return m_StagingSize; }
+
+private:
+	struct SFrameResources
+	{
+		VkCommandPool			CommandPool = VK_NULL_HANDLE;
+		VkCommandBuffer			CommandBuffer = VK_NULL_HANDLE;
+		VkSemaphore				Semaphore = VK_NULL_HANDLE;
+		VkDeviceSize			RingEnd = 0;
+		VkPipelineStageFlags	DstStages = 0;
+		bool					IsRecording = false;
+		bool					HasPendingAcquire = false;
+		std::vector<VkBufferMemoryBarrier> ReleaseBarriers;
+		std::vector<VkBufferMemoryBarrier> AcquireBarriers;
+	};
+
+	VkDevice				m_VkDevice = VK_NULL_HANDLE;
+	CGpuMemoryAllocator*	m_pAllocator = nullptr;
+	VkQueue					m_VkTransferQueue = VK_NULL_HANDLE;
+	uint32_t				m_TransferFamily = 0;
+	uint32_t				m_GraphicsFamily = 0;
+
+	VkBuffer				m_VkStagingBuffer = VK_NULL_HANDLE;
+	SGpuAllocation			m_StagingAllocation;
+	VkDeviceSize			m_StagingSize = 0;
+
+	//NOTE: head and tail only ever grow, the position in the staging buffer is the value modulo its size
+	VkDeviceSize			m_RingHead = 0;
+	VkDeviceSize			m_RingTail = 0;
+
+	std::vector<SFrameResources> m_FrameResources;
+	uint32_t				m_CurrentFrame = 0;
+
+	void __createStagingBuffer(VkDeviceSize vStagingSize);
+	VkDeviceSize __allocateFromRing(VkDeviceSize vSize);
+};
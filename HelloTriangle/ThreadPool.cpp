@@ -0,0 +1,89 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+//******************************************************************************************
+//FUNCTION:
+CThreadPool::CThreadPool(uint32_t vThreadCount)
+{
+	vThreadCount = std::max(vThreadCount, 1u);
+	for (uint32_t i = 0; i < vThreadCount; ++i)
+		m_Threads.emplace_back(&CThreadPool::__workerLoop, this, i);
+}
+
+//******************************************************************************************
+//FUNCTION:
+CThreadPool::~CThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_WorkReadySignal.notify_all();
+
+	for (auto& Thread : m_Threads) Thread.join();
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CThreadPool::parallelFor(size_t vTaskCount, const std::function<void(uint32_t vThreadIndex, size_t vTaskIndex)>& vTask)
+{
+	if (0 == vTaskCount) return;
+
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_pTask = &vTask;
+	m_TaskCount = vTaskCount;
+	m_NextTask = 0;
+	m_BusyThreadCount = getThreadCount();
+	m_Generation++;
+	m_WorkReadySignal.notify_all();
+
+	m_WorkDoneSignal.wait(Lock, [&]() { return 0 == m_BusyThreadCount; });
+	m_pTask = nullptr;
+
+	if (m_pFirstException)
+	{
+		std::exception_ptr pException = m_pFirstException;
+		m_pFirstException = nullptr;
+		std::rethrow_exception(pException);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CThreadPool::__workerLoop(uint32_t vThreadIndex)
+{
+	uint64_t SeenGeneration = 0;
+
+	while (true)
+	{
+		const std::function<void(uint32_t, size_t)>* pTask = nullptr;
+		size_t TaskCount = 0;
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_WorkReadySignal.wait(Lock, [&]() { return m_IsStopping || m_Generation != SeenGeneration; });
+			if (m_IsStopping) return;
+
+			SeenGeneration = m_Generation;
+			pTask = m_pTask;
+			TaskCount = m_TaskCount;
+		}
+
+		try
+		{
+			for (size_t TaskIndex = m_NextTask++; TaskIndex < TaskCount; TaskIndex = m_NextTask++)
+				(*pTask)(vThreadIndex, TaskIndex);
+		}
+		catch (...)
+		{
+			//NOTE: the remaining tasks are skipped and the first failure is rethrown on the calling thread
+			m_NextTask = TaskCount;
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			if (!m_pFirstException) m_pFirstException = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			if (--m_BusyThreadCount == 0) m_WorkDoneSignal.notify_one();
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+class CThreadPool
+{
+public:
+	explicit CThreadPool(uint32_t vThreadCount);
+	~CThreadPool();
+
+	CThreadPool(const CThreadPool&) = delete;
+	CThreadPool& operator=(const CThreadPool&) = delete;
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+	void parallelFor(size_t vTaskCount, const std::function<void(uint32_t vThreadIndex, size_t vTaskIndex)>& vTask);
+
+private:
+	std::vector<std::thread>	m_Threads;
+	std::mutex					m_Mutex;
+	std::condition_variable		m_WorkReadySignal;
+	std::condition_variable		m_WorkDoneSignal;
+
+	const std::function<void(uint32_t, size_t)>* m_pTask = nullptr;
+	size_t				m_TaskCount = 0;
+	std::atomic<size_t>	m_NextTask{ 0 };
+	uint32_t			m_BusyThreadCount = 0;
+	uint64_t			m_Generation = 0;
+	bool				m_IsStopping = false;
+	std::exception_ptr	m_pFirstException;
+
+	void __workerLoop(uint32_t vThreadIndex);
+};
@@ -0,0 +1,269 @@
+#include "VertexQuantizer.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+
+//NOTE: the vector paths are picked at compile time, AVX2 needs /arch:AVX2 (or -mavx2 -mf16c) and x64 always has SSE2
+#if defined(__AVX2__)
+#define VERTEX_QUANTIZER_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_QUANTIZER_SSE2
+#endif
+#if defined(VERTEX_QUANTIZER_AVX2) || defined(VERTEX_QUANTIZER_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	const size_t SOURCE_FLOATS_PER_VERTEX = 5;
+	const uint32_t PACKED_STRIDE = 8;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static uint16_t __convertFloatToHalf(float vValue)
+{
+	uint32_t Bits;
+	memcpy(&Bits, &vValue, sizeof(Bits));
+
+	uint32_t Sign = (Bits >> 16) & 0x8000;
+	int32_t Exponent = static_cast<int32_t>((Bits >> 23) & 0xff) - 127 + 15;
+	uint32_t Mantissa = Bits & 0x7fffff;
+
+	if (((Bits >> 23) & 0xff) == 0xff) return static_cast<uint16_t>(Sign | 0x7c00 | (Mantissa ? 0x200 : 0));
+	if (Exponent >= 31) return static_cast<uint16_t>(Sign | 0x7c00);
+	if (Exponent <= 0)
+	{
+		if (Exponent < -10) return static_cast<uint16_t>(Sign);
+
+		//NOTE: denormal half, the implicit leading one becomes explicit before shifting
+		Mantissa |= 0x800000;
+		uint32_t Shift = static_cast<uint32_t>(14 - Exponent);
+		uint32_t Half = Mantissa >> Shift;
+		uint32_t Remainder = Mantissa & ((1u << Shift) - 1);
+		uint32_t Midpoint = 1u << (Shift - 1);
+		if (Remainder > Midpoint || (Remainder == Midpoint && (Half & 1))) ++Half;
+		return static_cast<uint16_t>(Sign | Half);
+	}
+
+	//NOTE: round to nearest even, a carry out of the mantissa correctly bumps the exponent
+	uint32_t Half = Sign | (static_cast<uint32_t>(Exponent) << 10) | (Mantissa >> 13);
+	uint32_t Remainder = Mantissa & 0x1fff;
+	if (Remainder > 0x1000 || (Remainder == 0x1000 && (Half & 1))) ++Half;
+	return static_cast<uint16_t>(Half);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static void __quantizeScalar(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination)
+{
+	for (size_t i = 0; i < vVertexCount; ++i)
+	{
+		const float* pVertex = vSource + i * SOURCE_FLOATS_PER_VERTEX;
+		uint16_t Position[2];
+		uint8_t Color[4] = { 0, 0, 0, 255 };
+
+		for (int k = 0; k < 2; ++k)
+		{
+			if (vFormat == EVertexFormat::Snorm16)
+				Position[k] = static_cast<uint16_t>(static_cast<int16_t>(std::lrint(std::min(std::max(pVertex[k], -1.0f), 1.0f) * 32767.0f)));
+			else
+				Position[k] = __convertFloatToHalf(pVertex[k]);
+		}
+		for (int k = 0; k < 3; ++k) Color[k] = static_cast<uint8_t>(std::lrint(std::min(std::max(pVertex[2 + k], 0.0f), 1.0f) * 255.0f));
+
+		memcpy(voDestination + i * PACKED_STRIDE, Position, sizeof(Position));
+		memcpy(voDestination + i * PACKED_STRIDE + sizeof(Position), Color, sizeof(Color));
+	}
+}
+
+#if defined(VERTEX_QUANTIZER_AVX2)
+//******************************************************************************************
+//FUNCTION:
+static size_t __quantizeAvx2(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination)
+{
+	//NOTE: eight vertices per iteration, the gathers turn the interleaved source into one register per component
+	const __m256i Offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(SOURCE_FLOATS_PER_VERTEX)));
+	const __m256 Zero = _mm256_setzero_ps(), One = _mm256_set1_ps(1.0f), MinusOne = _mm256_set1_ps(-1.0f);
+	const __m256i LowHalfMask = _mm256_set1_epi32(0xffff), ByteMask = _mm256_set1_epi32(0xff);
+
+	size_t VertexCount = vVertexCount & ~size_t(7);
+	for (size_t i = 0; i < VertexCount; i += 8)
+	{
+		const float* pBase = vSource + i * SOURCE_FLOATS_PER_VERTEX;
+		__m256 X = _mm256_i32gather_ps(pBase + 0, Offsets, 4);
+		__m256 Y = _mm256_i32gather_ps(pBase + 1, Offsets, 4);
+
+		__m256i PackedX, PackedY;
+		if (vFormat == EVertexFormat::Snorm16)
+		{
+			__m256 Scale = _mm256_set1_ps(32767.0f);
+			PackedX = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(X, MinusOne), One), Scale));
+			PackedY = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(Y, MinusOne), One), Scale));
+		}
+		else
+		{
+			PackedX = _mm256_cvtepu16_epi32(_mm256_cvtps_ph(X, _MM_FROUND_TO_NEAREST_INT));
+			PackedY = _mm256_cvtepu16_epi32(_mm256_cvtps_ph(Y, _MM_FROUND_TO_NEAREST_INT));
+		}
+		__m256i Position = _mm256_or_si256(_mm256_and_si256(PackedX, LowHalfMask), _mm256_slli_epi32(PackedY, 16));
+
+		__m256i Color = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+		for (int k = 0; k < 3; ++k)
+		{
+			__m256 Channel = _mm256_min_ps(_mm256_max_ps(_mm256_i32gather_ps(pBase + 2 + k, Offsets, 4), Zero), One);
+			__m256i Byte = _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(Channel, _mm256_set1_ps(255.0f))), ByteMask);
+			Color = _mm256_or_si256(Color, _mm256_slli_epi32(Byte, 8 * k));
+		}
+
+		//NOTE: interleave position and color words back into eight byte vertices, the unpacks work per 128-bit half
+		__m256i Low = _mm256_unpacklo_epi32(Position, Color);
+		__m256i High = _mm256_unpackhi_epi32(Position, Color);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(voDestination + i * PACKED_STRIDE), _mm256_permute2x128_si256(Low, High, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(voDestination + i * PACKED_STRIDE + 32), _mm256_permute2x128_si256(Low, High, 0x31));
+	}
+
+	return VertexCount;
+}
+#endif
+
+#if defined(VERTEX_QUANTIZER_SSE2) && !defined(VERTEX_QUANTIZER_AVX2)
+//******************************************************************************************
+//FUNCTION:
+static size_t __quantizeSse2(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination)
+{
+	//NOTE: one vertex per iteration, SSE2 has no half conversion so Half16 positions stay scalar
+	const __m128 Zero = _mm_setzero_ps(), One = _mm_set1_ps(1.0f), MinusOne = _mm_set1_ps(-1.0f);
+	const __m128 PositionScale = _mm_set1_ps(32767.0f), ColorScale = _mm_set1_ps(255.0f);
+
+	for (size_t i = 0; i < vVertexCount; ++i)
+	{
+		const float* pVertex = vSource + i * SOURCE_FLOATS_PER_VERTEX;
+		__m128 Vertex = _mm_loadu_ps(pVertex);
+		__m128 Blue = _mm_move_ss(One, _mm_load_ss(pVertex + 4));
+		__m128 Color = _mm_shuffle_ps(Vertex, Blue, _MM_SHUFFLE(1, 0, 3, 2));
+
+		int32_t Position;
+		if (vFormat == EVertexFormat::Snorm16)
+		{
+			__m128i Packed = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(Vertex, MinusOne), One), PositionScale));
+			Position = _mm_cvtsi128_si32(_mm_packs_epi32(Packed, Packed));
+		}
+		else
+		{
+			Position = static_cast<int32_t>(__convertFloatToHalf(pVertex[0]) | (static_cast<uint32_t>(__convertFloatToHalf(pVertex[1])) << 16));
+		}
+
+		__m128i PackedColor = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(Color, Zero), One), ColorScale));
+		PackedColor = _mm_packs_epi32(PackedColor, PackedColor);
+		int32_t ColorBytes = _mm_cvtsi128_si32(_mm_packus_epi16(PackedColor, PackedColor));
+
+		memcpy(voDestination + i * PACKED_STRIDE, &Position, sizeof(Position));
+		memcpy(voDestination + i * PACKED_STRIDE + 4, &ColorBytes, sizeof(ColorBytes));
+	}
+
+	return vVertexCount;
+}
+#endif
+
+//******************************************************************************************
+//FUNCTION:
+uint32_t CVertexQuantizer::getStride(EVertexFormat vFormat)
+{
+	return vFormat == EVertexFormat::Float32 ? static_cast<uint32_t>(SOURCE_FLOATS_PER_VERTEX * sizeof(float)) : PACKED_STRIDE;
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkFormat CVertexQuantizer::getPositionFormat(EVertexFormat vFormat)
+{
+	switch (vFormat)
+	{
+	case EVertexFormat::Snorm16: return VK_FORMAT_R16G16_SNORM;
+	case EVertexFormat::Half16: return VK_FORMAT_R16G16_SFLOAT;
+	default: return VK_FORMAT_R32G32_SFLOAT;
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkFormat CVertexQuantizer::getColorFormat(EVertexFormat vFormat)
+{
+	return vFormat == EVertexFormat::Float32 ? VK_FORMAT_R32G32B32_SFLOAT : VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+//******************************************************************************************
+//FUNCTION:
+VkVertexInputBindingDescription CVertexQuantizer::getBindingDescription(EVertexFormat vFormat, uint32_t vBinding)
+{
+	VkVertexInputBindingDescription BindingDescription = {};
+	BindingDescription.binding = vBinding;
+	BindingDescription.stride = getStride(vFormat);
+	BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	return BindingDescription;
+}
+
+//******************************************************************************************
+//FUNCTION:
+std::array<VkVertexInputAttributeDescription, 2> CVertexQuantizer::getAttributeDescriptions(EVertexFormat vFormat, uint32_t vBinding, uint32_t vPositionLocation, uint32_t vColorLocation)
+{
+	//NOTE: the shader inputs stay vec2 and vec3, normalized and half formats are expanded to float by the input assembler
+	std::array<VkVertexInputAttributeDescription, 2> AttributeDescriptions = {};
+	AttributeDescriptions[0].binding = vBinding;
+	AttributeDescriptions[0].location = vPositionLocation;
+	AttributeDescriptions[0].format = getPositionFormat(vFormat);
+	AttributeDescriptions[0].offset = 0;
+	AttributeDescriptions[1].binding = vBinding;
+	AttributeDescriptions[1].location = vColorLocation;
+	AttributeDescriptions[1].format = getColorFormat(vFormat);
+	AttributeDescriptions[1].offset = vFormat == EVertexFormat::Float32 ? static_cast<uint32_t>(2 * sizeof(float)) : 2 * sizeof(uint16_t);
+
+	return AttributeDescriptions;
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CVertexQuantizer::quantize(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination)
+{
+	if (vFormat == EVertexFormat::Float32)
+	{
+		memcpy(voDestination, vSource, vVertexCount * SOURCE_FLOATS_PER_VERTEX * sizeof(float));
+		return;
+	}
+	if (vFormat != EVertexFormat::Snorm16 && vFormat != EVertexFormat::Half16)
+		throw std::runtime_error("unknown vertex format!");
+
+	size_t DoneCount = 0;
+#if defined(VERTEX_QUANTIZER_AVX2)
+	DoneCount = __quantizeAvx2(vFormat, vSource, vVertexCount, voDestination);
+#elif defined(VERTEX_QUANTIZER_SSE2)
+	DoneCount = __quantizeSse2(vFormat, vSource, vVertexCount, voDestination);
+#endif
+	__quantizeScalar(vFormat, vSource + DoneCount * SOURCE_FLOATS_PER_VERTEX, vVertexCount - DoneCount, voDestination + DoneCount * PACKED_STRIDE);
+}
+
+//******************************************************************************************
+//FUNCTION:
+void CVertexQuantizer::quantizeScalar(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination)
+{
+	if (vFormat != EVertexFormat::Snorm16 && vFormat != EVertexFormat::Half16)
+		throw std::runtime_error("only quantized vertex formats have a scalar path!");
+
+	__quantizeScalar(vFormat, vSource, vVertexCount, voDestination);
+}
+
+//******************************************************************************************
+//FUNCTION:
+const char* CVertexQuantizer::getSimdPathName()
+{
+#if defined(VERTEX_QUANTIZER_AVX2)
+	return "avx2";
+#elif defined(VERTEX_QUANTIZER_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+enum class EVertexFormat
+{
+	Float32 = 0,	//R32G32_SFLOAT position, R32G32B32_SFLOAT color, 20 bytes
+	Snorm16,		//R16G16_SNORM position, R8G8B8A8_UNORM color, 8 bytes
+	Half16,			//R16G16_SFLOAT position, R8G8B8A8_UNORM color, 8 bytes
+	Count
+};
+
+class CVertexQuantizer
+{
+public:
+	static uint32_t getStride(EVertexFormat vFormat);
+	static VkFormat getPositionFormat(EVertexFormat vFormat);
+	static VkFormat getColorFormat(EVertexFormat vFormat);
+
+	static VkVertexInputBindingDescription getBindingDescription(EVertexFormat vFormat, uint32_t vBinding);
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions(EVertexFormat vFormat, uint32_t vBinding, uint32_t vPositionLocation, uint32_t vColorLocation);
+
+	//NOTE: vSource holds x, y, r, g, b per vertex; Snorm16 clamps positions to [-1, 1], so meshes must be normalized to fit
+	static void quantize(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination);
+	//NOTE: the plain C++ conversion of the quantized formats, the vector paths have to match it bit for bit
+	static void quantizeScalar(EVertexFormat vFormat, const float* vSource, size_t vVertexCount, char* voDestination);
+
+	static const char* getSimdPathName();
+};
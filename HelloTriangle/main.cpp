@@ -1,11 +1,172 @@
 #include "HelloTriangleApplication.h"
+#include <string>
+#include <cstring>
 
-int main()
+//******************************************************************************************
+//FUNCTION:
+static ECullingMode __parseCullingMode(const char* vName)
 {
-	CHelloTriangleApplication HelloTriangleApp;
+	if (strcmp(vName, "none") == 0) return ECullingMode::None;
+	if (strcmp(vName, "cpu") == 0) return ECullingMode::Cpu;
+	if (strcmp(vName, "gpu") == 0) return ECullingMode::Gpu;
 
+	throw std::runtime_error(std::string("unknown culling mode: ") + vName);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static EPresentModePolicy __parsePresentModePolicy(const char* vName)
+{
+	if (strcmp(vName, "mailbox") == 0) return EPresentModePolicy::Mailbox;
+	if (strcmp(vName, "fifo") == 0) return EPresentModePolicy::Fifo;
+	if (strcmp(vName, "fifo-relaxed") == 0) return EPresentModePolicy::FifoRelaxed;
+	if (strcmp(vName, "immediate") == 0) return EPresentModePolicy::Immediate;
+
+	throw std::runtime_error(std::string("unknown present mode: ") + vName);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static EVertexFormat __parseVertexFormat(const char* vName)
+{
+	if (strcmp(vName, "float") == 0) return EVertexFormat::Float32;
+	if (strcmp(vName, "snorm16") == 0) return EVertexFormat::Snorm16;
+	if (strcmp(vName, "half") == 0) return EVertexFormat::Half16;
+
+	throw std::runtime_error(std::string("unknown vertex format: ") + vName);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static EDrawSortOrder __parseDrawSortOrder(const char* vName)
+{
+	if (strcmp(vName, "none") == 0) return EDrawSortOrder::None;
+	if (strcmp(vName, "front-to-back") == 0) return EDrawSortOrder::FrontToBack;
+	if (strcmp(vName, "back-to-front") == 0) return EDrawSortOrder::BackToFront;
+
+	throw std::runtime_error(std::string("unknown draw sort order: ") + vName);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static ECaptureFileFormat __parseCaptureFileFormat(const char* vName)
+{
+	if (strcmp(vName, "png") == 0) return ECaptureFileFormat::Png;
+	if (strcmp(vName, "raw") == 0) return ECaptureFileFormat::Raw;
+
+	throw std::runtime_error(std::string("unknown capture format: ") + vName);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static SApplicationConfig __parseCommandLine(int vArgc, char* vArgv[])
+{
+	SApplicationConfig Config;
+
+	for (int i = 1; i < vArgc; ++i)
+	{
+		auto hasValue = [&]() { return i + 1 < vArgc; };
+
+		if (strcmp(vArgv[i], "--headless") == 0)
+			Config.Headless = true;
+		else if (strcmp(vArgv[i], "--width") == 0 && hasValue())
+			Config.Width = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--height") == 0 && hasValue())
+			Config.Height = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--frames") == 0 && hasValue())
+			Config.FrameCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--frames-in-flight") == 0 && hasValue())
+			Config.FramesInFlight = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--swapchain-images") == 0 && hasValue())
+			Config.SwapChainImageCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--present-mode") == 0 && hasValue())
+			Config.PresentModePolicy = __parsePresentModePolicy(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--device") == 0 && hasValue())
+			Config.DeviceOverride = vArgv[++i];
+		else if (strcmp(vArgv[i], "--list-devices") == 0)
+			Config.ListDevices = true;
+		else if (strcmp(vArgv[i], "--gpu-block-size-mb") == 0 && hasValue())
+			Config.GpuMemoryBlockSizeMB = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--pipeline-cache") == 0 && hasValue())
+			Config.PipelineCacheFile = vArgv[++i];
+		else if (strcmp(vArgv[i], "--no-pipeline-cache") == 0)
+			Config.PipelineCacheFile.clear();
+		else if (strcmp(vArgv[i], "--assets") == 0 && hasValue())
+			Config.AssetArchiveFile = vArgv[++i];
+		else if (strcmp(vArgv[i], "--pack-assets") == 0 && hasValue())
+			Config.PackAssetsFile = vArgv[++i];
+		else if (strcmp(vArgv[i], "--mesh-density") == 0 && hasValue())
+			Config.MeshDensity = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--no-mesh-optimize") == 0)
+			Config.OptimizeMesh = false;
+		else if (strcmp(vArgv[i], "--vertex-format") == 0 && hasValue())
+			Config.VertexFormat = __parseVertexFormat(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--draws") == 0 && hasValue())
+			Config.DrawCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--instances") == 0 && hasValue())
+			Config.InstanceCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--scene-extent") == 0 && hasValue())
+			Config.SceneExtent = std::stof(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--depth-layers") == 0 && hasValue())
+			Config.DepthLayerCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--draw-sort") == 0 && hasValue())
+			Config.DrawSortOrder = __parseDrawSortOrder(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--culling") == 0 && hasValue())
+			Config.CullingMode = __parseCullingMode(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--pulse") == 0 && hasValue())
+			Config.PulseAmplitude = std::stof(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--tint-draws") == 0)
+			Config.TintDraws = true;
+		else if (strcmp(vArgv[i], "--hot-reload") == 0)
+			Config.HotReloadShaders = true;
+		else if (strcmp(vArgv[i], "--stream") == 0)
+			Config.StreamInstanceColors = true;
+		else if (strcmp(vArgv[i], "--culling-benchmark") == 0)
+			Config.CullingBenchmark = true;
+		else if (strcmp(vArgv[i], "--pipeline-benchmark") == 0)
+			Config.PipelineBenchmark = true;
+		else if (strcmp(vArgv[i], "--pipeline-variants") == 0 && hasValue())
+			Config.PipelineBenchmarkVariants = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--overdraw-benchmark") == 0)
+			Config.OverdrawBenchmark = true;
+		else if (strcmp(vArgv[i], "--stress") == 0)
+			Config.StressTest = true;
+		else if (strcmp(vArgv[i], "--stress-max-instances") == 0 && hasValue())
+			Config.StressMaxInstances = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--record-threads") == 0 && hasValue())
+			Config.RecordThreadCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--capture") == 0 && hasValue())
+			Config.CaptureDirectory = vArgv[++i];
+		else if (strcmp(vArgv[i], "--capture-format") == 0 && hasValue())
+			Config.CaptureFileFormat = __parseCaptureFileFormat(vArgv[++i]);
+		else if (strcmp(vArgv[i], "--capture-every") == 0 && hasValue())
+			Config.CaptureInterval = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--capture-threads") == 0 && hasValue())
+			Config.CaptureThreadCount = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--capture-blocking") == 0)
+			Config.CaptureBlocking = true;
+		else if (strcmp(vArgv[i], "--capture-reference") == 0 && hasValue())
+			Config.CaptureReferenceDirectory = vArgv[++i];
+		else if (strcmp(vArgv[i], "--record-benchmark") == 0)
+			Config.RecordBenchmark = true;
+		else if (strcmp(vArgv[i], "--benchmark") == 0 && hasValue())
+			Config.BenchmarkFrames = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--benchmark-warmup") == 0 && hasValue())
+			Config.BenchmarkWarmupFrames = static_cast<uint32_t>(std::stoul(vArgv[++i]));
+		else if (strcmp(vArgv[i], "--benchmark-output") == 0 && hasValue())
+			Config.BenchmarkOutputFile = vArgv[++i];
+		else
+			throw std::runtime_error(std::string("unknown or incomplete option: ") + vArgv[i]);
+	}
+
+	return Config;
+}
+
+int main(int argc, char* argv[])
+{
 	try
 	{
+		CHelloTriangleApplication HelloTriangleApp(__parseCommandLine(argc, argv));
 		HelloTriangleApp.run();
 	}
 	catch (const std::exception& e)
@@ -15,4 +176,4 @@ int main()
 	}
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -1,3 +1,4 @@
 %VULKAN%/bin/glslangValidator.exe -V helloTriangle.vert
 %VULKAN%/bin/glslangValidator.exe -V helloTriangle.frag
+%VULKAN%/bin/glslangValidator.exe -V cullObjects.comp -o cullObjects.spv
 pause
\ No newline at end of file
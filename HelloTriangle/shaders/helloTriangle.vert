@@ -1,13 +1,29 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+layout(set = 0, binding = 0) uniform FrameUniforms
+{
+    vec4 ColorTint;
+    float Time;
+    float PulseAmplitude;
+} _Frame;
+
+layout(push_constant) uniform DrawConstants
+{
+    vec4 Tint;
+} _Draw;
+
 layout(location = 0) in vec2 _inPosition;
 layout(location = 1) in vec3 _inColor;
+layout(location = 2) in vec3 _inInstanceTransform;
+layout(location = 3) in vec3 _inInstanceColor;
+layout(location = 4) in float _inInstanceDepth;
 
 layout(location = 0) out vec3 _outFragColor;
 
 void main() 
 {
-    gl_Position = vec4(_inPosition, 0.0, 1.0);
-    _outFragColor = _inColor;
+    float Pulse = 1.0 - _Frame.PulseAmplitude * (0.5 + 0.5 * sin(_Frame.Time + float(gl_InstanceIndex) * 0.37));
+    gl_Position = vec4(_inPosition * (_inInstanceTransform.z * Pulse) + _inInstanceTransform.xy, _inInstanceDepth, 1.0);
+    _outFragColor = _inColor * _inInstanceColor * _Frame.ColorTint.rgb * _Draw.Tint.rgb;
 }
\ No newline at end of file
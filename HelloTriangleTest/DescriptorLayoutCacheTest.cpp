@@ -0,0 +1,56 @@
+#include "TestFramework.h"
+#include "DescriptorLayoutCache.h"
+
+//******************************************************************************************
+//FUNCTION:
+static VkDescriptorSetLayoutBinding __createBinding(uint32_t vBinding, VkDescriptorType vType, uint32_t vCount, VkShaderStageFlags vStages)
+{
+	VkDescriptorSetLayoutBinding Binding = {};
+	Binding.binding = vBinding;
+	Binding.descriptorType = vType;
+	Binding.descriptorCount = vCount;
+	Binding.stageFlags = vStages;
+	return Binding;
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testBindingOrderDoesNotChangeKey)
+{
+	VkDescriptorSetLayoutBinding Uniforms = __createBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT);
+	VkDescriptorSetLayoutBinding Instances = __createBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+	VkDescriptorSetLayoutBinding Textures = __createBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+	size_t Key = CDescriptorLayoutCache::hashBindings({ Uniforms, Instances, Textures });
+	CHECK(CDescriptorLayoutCache::hashBindings({ Textures, Uniforms, Instances }) == Key);
+	CHECK(CDescriptorLayoutCache::hashBindings({ Instances, Textures, Uniforms }) == Key);
+	CHECK(CDescriptorLayoutCache::hashBindings({ Textures, Instances, Uniforms }) == Key);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testEveryBindingFieldChangesKey)
+{
+	VkDescriptorSetLayoutBinding Uniforms = __createBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT);
+	VkDescriptorSetLayoutBinding Instances = __createBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+	size_t Key = CDescriptorLayoutCache::hashBindings({ Uniforms, Instances });
+
+	VkDescriptorSetLayoutBinding Changed = Instances;
+	Changed.binding = 2;
+	CHECK(CDescriptorLayoutCache::hashBindings({ Uniforms, Changed }) != Key);
+
+	Changed = Instances;
+	Changed.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	CHECK(CDescriptorLayoutCache::hashBindings({ Uniforms, Changed }) != Key);
+
+	Changed = Instances;
+	Changed.descriptorCount = 2;
+	CHECK(CDescriptorLayoutCache::hashBindings({ Uniforms, Changed }) != Key);
+
+	Changed = Instances;
+	Changed.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	CHECK(CDescriptorLayoutCache::hashBindings({ Uniforms, Changed }) != Key);
+
+	CHECK(CDescriptorLayoutCache::hashBindings({ Uniforms }) != Key);
+	CHECK(CDescriptorLayoutCache::hashBindings({ Uniforms, Instances, Instances }) != Key);
+}
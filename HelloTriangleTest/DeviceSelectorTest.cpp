@@ -0,0 +1,102 @@
+#include "TestFramework.h"
+#include "DeviceSelector.h"
+#include <cstdio>
+
+//******************************************************************************************
+//FUNCTION:
+static SPhysicalDeviceInfo __createDeviceInfo(const char* vName, VkPhysicalDeviceType vType, VkDeviceSize vDeviceLocalSize)
+{
+	SPhysicalDeviceInfo Info;
+	snprintf(Info.Properties.deviceName, sizeof(Info.Properties.deviceName), "%s", vName);
+	Info.Properties.deviceType = vType;
+	Info.Properties.limits.maxImageDimension2D = 16384;
+	Info.MemoryProperties.memoryHeapCount = 1;
+	Info.MemoryProperties.memoryHeaps[0].size = vDeviceLocalSize;
+	Info.MemoryProperties.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	Info.QueueFamilies.push_back({ VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, 1, 64, { 1, 1, 1 } });
+	Info.IsSuitable = true;
+	return Info;
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testDiscreteOutranksIntegrated)
+{
+	//NOTE: the integrated device gets more memory and every optional capability, the device type still has to dominate
+	SPhysicalDeviceInfo Integrated = __createDeviceInfo("Integrated Graphics", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 32ull << 30);
+	Integrated.Features.multiDrawIndirect = VK_TRUE;
+	Integrated.Features.drawIndirectFirstInstance = VK_TRUE;
+	Integrated.QueueFamilies.push_back({ VK_QUEUE_COMPUTE_BIT, 1, 64, { 1, 1, 1 } });
+	Integrated.QueueFamilies.push_back({ VK_QUEUE_TRANSFER_BIT, 1, 64, { 1, 1, 1 } });
+	SPhysicalDeviceInfo Discrete = __createDeviceInfo("Discrete Graphics", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 2ull << 30);
+
+	CHECK(CDeviceSelector::computeScore(Discrete) > CDeviceSelector::computeScore(Integrated));
+	CHECK(CDeviceSelector::findBest({ Integrated, Discrete }) == 1);
+	CHECK(CDeviceSelector::findBest({ Discrete, Integrated }) == 0);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testCapabilitiesOrderDevicesOfOneType)
+{
+	SPhysicalDeviceInfo Basic = __createDeviceInfo("Basic", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8ull << 30);
+	SPhysicalDeviceInfo MoreMemory = __createDeviceInfo("More Memory", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 16ull << 30);
+	SPhysicalDeviceInfo IndirectDraws = Basic;
+	IndirectDraws.Features.multiDrawIndirect = VK_TRUE;
+	IndirectDraws.Features.drawIndirectFirstInstance = VK_TRUE;
+	SPhysicalDeviceInfo DedicatedTransfer = Basic;
+	DedicatedTransfer.QueueFamilies.push_back({ VK_QUEUE_TRANSFER_BIT, 1, 64, { 1, 1, 1 } });
+
+	CHECK(CDeviceSelector::computeScore(MoreMemory) > CDeviceSelector::computeScore(Basic));
+	CHECK(CDeviceSelector::computeScore(IndirectDraws) > CDeviceSelector::computeScore(Basic));
+	CHECK(CDeviceSelector::computeScore(DedicatedTransfer) > CDeviceSelector::computeScore(Basic));
+
+	//NOTE: only one of the two indirect draw features is not enough to use gpu culling
+	SPhysicalDeviceInfo PartialIndirect = Basic;
+	PartialIndirect.Features.multiDrawIndirect = VK_TRUE;
+	CHECK(CDeviceSelector::computeScore(PartialIndirect) == CDeviceSelector::computeScore(Basic));
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testUnsuitableDevicesAreRejected)
+{
+	SPhysicalDeviceInfo Discrete = __createDeviceInfo("Discrete Graphics", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8ull << 30);
+	Discrete.IsSuitable = false;
+	SPhysicalDeviceInfo Cpu = __createDeviceInfo("Software Rasterizer", VK_PHYSICAL_DEVICE_TYPE_CPU, 0);
+
+	CHECK(CDeviceSelector::computeScore(Discrete) == -1);
+	CHECK(CDeviceSelector::computeScore(Cpu) >= 0);
+	CHECK(CDeviceSelector::findBest({ Discrete, Cpu }) == 1);
+
+	Cpu.IsSuitable = false;
+	CHECK(CDeviceSelector::findBest({ Discrete, Cpu }) == -1);
+	CHECK(CDeviceSelector::findBest({}) == -1);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testOverrideRules)
+{
+	std::vector<SPhysicalDeviceInfo> Devices =
+	{
+		__createDeviceInfo("Intel(R) UHD Graphics 630", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 1ull << 30),
+		__createDeviceInfo("NVIDIA GeForce RTX 3090", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 24ull << 30),
+		__createDeviceInfo("NVIDIA GeForce GTX 780", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 3ull << 30)
+	};
+
+	CHECK(CDeviceSelector::findOverride(Devices, "0") == 0);
+	CHECK(CDeviceSelector::findOverride(Devices, "2") == 2);
+	CHECK(CDeviceSelector::findOverride(Devices, "geforce") == 1);
+	CHECK(CDeviceSelector::findOverride(Devices, "gtx") == 2);
+	CHECK(CDeviceSelector::findOverride(Devices, "UHD GRAPHICS") == 0);
+
+	//NOTE: digits that are no valid index are model numbers
+	CHECK(CDeviceSelector::findOverride(Devices, "3090") == 1);
+	CHECK(CDeviceSelector::findOverride(Devices, "780") == 2);
+	CHECK(CDeviceSelector::findOverride(Devices, "630") == 0);
+	CHECK(CDeviceSelector::findOverride(Devices, "99999999999999999999") == -1);
+
+	CHECK(CDeviceSelector::findOverride(Devices, "5") == -1);
+	CHECK(CDeviceSelector::findOverride(Devices, "radeon") == -1);
+}
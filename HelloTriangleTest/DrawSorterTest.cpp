@@ -0,0 +1,80 @@
+#include "TestFramework.h"
+#include "DrawSorter.h"
+#include <algorithm>
+#include <limits>
+#include <random>
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testFloatKeysFollowFloatOrder)
+{
+	const std::vector<float> Depths = { -std::numeric_limits<float>::infinity(), -1.0e30f, -2.5f, -1.0f, -std::numeric_limits<float>::denorm_min(), -0.0f,
+		0.0f, std::numeric_limits<float>::denorm_min(), 1.0e-30f, 0.25f, 1.0f, 1.0f + std::numeric_limits<float>::epsilon(), 3.0e38f, std::numeric_limits<float>::infinity() };
+
+	for (size_t i = 0; i + 1 < Depths.size(); ++i)
+	{
+		uint64_t Key = CDrawSorter::makeSortKey(0, Depths[i], 0), NextKey = CDrawSorter::makeSortKey(0, Depths[i + 1], 0);
+
+		//NOTE: the two zeros compare equal as floats but keep distinct keys, negative zero just has to come first
+		CHECK(Key < NextKey);
+	}
+
+	//NOTE: the pipeline outranks any depth, the depth outranks any material
+	CHECK(CDrawSorter::makeSortKey(1, -1.0e30f, 0) > CDrawSorter::makeSortKey(0, 1.0e30f, (1u << 20) - 1));
+	CHECK(CDrawSorter::makeSortKey(0, 0.5f, 0) > CDrawSorter::makeSortKey(0, 0.25f, (1u << 20) - 1));
+	CHECK(CDrawSorter::makeSortKey(0, 0.5f, 2) > CDrawSorter::makeSortKey(0, 0.5f, 1));
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testSortMatchesStableSort)
+{
+	//NOTE: few distinct depths and materials, so many keys tie and stability actually matters
+	std::mt19937 Random(11);
+	std::vector<uint64_t> Keys(5000);
+	for (auto& Key : Keys)
+	{
+		float Depth = static_cast<float>(static_cast<int>(Random() % 64) - 32) / 8.0f;
+		Key = CDrawSorter::makeSortKey(Random() % 3, Depth, Random() % 4);
+	}
+
+	std::vector<uint32_t> Expected(Keys.size());
+	for (uint32_t i = 0; i < Expected.size(); ++i) Expected[i] = i;
+	std::stable_sort(Expected.begin(), Expected.end(), [&Keys](uint32_t vLhs, uint32_t vRhs) { return Keys[vLhs] < Keys[vRhs]; });
+
+	CDrawSorter Sorter;
+	Sorter.sort(Keys);
+	CHECK(Sorter.getOrder() == Expected);
+
+	//NOTE: reusing the sorter must not leak state from the previous sort
+	std::vector<uint64_t> FewKeys = { Keys[0], Keys[1], Keys[2] };
+	Sorter.sort(FewKeys);
+	CHECK(Sorter.getOrder().size() == 3);
+	CHECK(FewKeys[Sorter.getOrder()[0]] <= FewKeys[Sorter.getOrder()[1]] && FewKeys[Sorter.getOrder()[1]] <= FewKeys[Sorter.getOrder()[2]]);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testSharedDigitsSkipPasses)
+{
+	//NOTE: one pipeline and one material leave only the depth bytes to sort, equal keys need no pass at all
+	std::vector<uint64_t> Keys;
+	for (int i = 0; i < 100; ++i) Keys.push_back(CDrawSorter::makeSortKey(0, static_cast<float>(99 - i), 0));
+
+	CDrawSorter Sorter;
+	Sorter.sort(Keys);
+	CHECK(Sorter.getLastPassCount() <= 4);
+	bool IsAscending = true;
+	for (size_t i = 0; i < Keys.size(); ++i) IsAscending = IsAscending && Sorter.getOrder()[i] == Keys.size() - 1 - i;
+	CHECK(IsAscending);
+
+	std::vector<uint64_t> EqualKeys(50, CDrawSorter::makeSortKey(2, 0.5f, 7));
+	Sorter.sort(EqualKeys);
+	CHECK(0 == Sorter.getLastPassCount());
+	bool IsIdentity = true;
+	for (uint32_t i = 0; i < EqualKeys.size(); ++i) IsIdentity = IsIdentity && Sorter.getOrder()[i] == i;
+	CHECK(IsIdentity);
+
+	Sorter.sort({});
+	CHECK(Sorter.getOrder().empty());
+}
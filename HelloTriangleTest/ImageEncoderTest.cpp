@@ -0,0 +1,269 @@
+#include "TestFramework.h"
+#include "ImageEncoder.h"
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const uint16_t LENGTH_BASES[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA_BITS[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASES[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA_BITS[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	class CBitReader
+	{
+	public:
+		CBitReader(const uint8_t* vData, size_t vSize) : m_pData(vData), m_Size(vSize) {}
+
+		uint32_t readBits(uint32_t vCount)
+		{
+			uint32_t Value = 0;
+			for (uint32_t i = 0; i < vCount; ++i, ++m_BitPosition)
+			{
+				if (m_BitPosition / 8 >= m_Size) throw std::runtime_error("deflate stream ends early!");
+				Value |= ((m_pData[m_BitPosition / 8] >> (m_BitPosition % 8)) & 1u) << i;
+			}
+			return Value;
+		}
+
+		size_t getBytePosition() const { return (m_BitPosition + 7) / 8; }
+
+	private:
+		const uint8_t* m_pData;
+		size_t m_Size;
+		size_t m_BitPosition = 0;
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+static uint32_t __readBigEndian(const uint8_t* vData)
+{
+	return (uint32_t(vData[0]) << 24) | (uint32_t(vData[1]) << 16) | (uint32_t(vData[2]) << 8) | uint32_t(vData[3]);
+}
+
+//******************************************************************************************
+//FUNCTION:
+static uint32_t __decodeFixedLiteral(CBitReader& vioReader)
+{
+	//NOTE: huffman codes are packed starting with their most significant bit
+	uint32_t Code = 0;
+	for (uint32_t Length = 1; Length <= 9; ++Length)
+	{
+		Code = (Code << 1) | vioReader.readBits(1);
+		if (7 == Length && Code <= 23) return 256 + Code;
+		if (8 == Length && Code >= 48 && Code <= 191) return Code - 48;
+		if (8 == Length && Code >= 192 && Code <= 199) return 280 + Code - 192;
+		if (9 == Length && Code >= 400) return 144 + Code - 400;
+	}
+	throw std::runtime_error("invalid fixed huffman code!");
+}
+
+//******************************************************************************************
+//FUNCTION:
+static std::vector<uint8_t> __inflateFixed(const uint8_t* vStream, size_t vSize)
+{
+	//NOTE: only as much inflate as the encoder needs, any other block type is a test failure
+	if (vSize < 6 || vStream[0] != 0x78 || (vStream[0] * 256u + vStream[1]) % 31 != 0) throw std::runtime_error("invalid zlib header!");
+
+	CBitReader Reader(vStream + 2, vSize - 6);
+	std::vector<uint8_t> Data;
+	bool IsFinal = false;
+	while (!IsFinal)
+	{
+		IsFinal = Reader.readBits(1) != 0;
+		if (Reader.readBits(2) != 1) throw std::runtime_error("only fixed huffman blocks are expected!");
+
+		for (;;)
+		{
+			uint32_t Symbol = __decodeFixedLiteral(Reader);
+			if (Symbol < 256) { Data.push_back(static_cast<uint8_t>(Symbol)); continue; }
+			if (256 == Symbol) break;
+			if (Symbol > 285) throw std::runtime_error("invalid length symbol!");
+
+			uint32_t Length = LENGTH_BASES[Symbol - 257] + Reader.readBits(LENGTH_EXTRA_BITS[Symbol - 257]);
+			uint32_t DistanceSymbol = 0;
+			for (int i = 0; i < 5; ++i) DistanceSymbol = (DistanceSymbol << 1) | Reader.readBits(1);
+			if (DistanceSymbol >= 30) throw std::runtime_error("invalid distance symbol!");
+			uint32_t Distance = DISTANCE_BASES[DistanceSymbol] + Reader.readBits(DISTANCE_EXTRA_BITS[DistanceSymbol]);
+			if (Distance > Data.size()) throw std::runtime_error("distance reaches before the stream!");
+
+			for (uint32_t i = 0; i < Length; ++i) Data.push_back(Data[Data.size() - Distance]);
+		}
+	}
+
+	if (Reader.getBytePosition() != vSize - 6) throw std::runtime_error("unexpected bytes after the deflate stream!");
+	if (__readBigEndian(vStream + vSize - 4) != CImageEncoder::computeAdler32(Data.data(), Data.size())) throw std::runtime_error("adler32 mismatch!");
+	return Data;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static std::vector<uint8_t> __unfilterRows(const std::vector<uint8_t>& vFiltered, uint32_t vWidth, uint32_t vHeight)
+{
+	size_t RowSize = size_t(vWidth) * 4;
+	if (vFiltered.size() != (RowSize + 1) * vHeight) throw std::runtime_error("unexpected filtered image size!");
+
+	std::vector<uint8_t> Pixels(RowSize * vHeight);
+	for (uint32_t y = 0; y < vHeight; ++y)
+	{
+		uint8_t FilterType = vFiltered[y * (RowSize + 1)];
+		const uint8_t* pSource = vFiltered.data() + y * (RowSize + 1) + 1;
+		uint8_t* pRow = Pixels.data() + y * RowSize;
+		const uint8_t* pPrevious = y > 0 ? pRow - RowSize : nullptr;
+
+		for (size_t i = 0; i < RowSize; ++i)
+		{
+			int Left = i >= 4 ? pRow[i - 4] : 0, Up = pPrevious ? pPrevious[i] : 0, UpLeft = (pPrevious && i >= 4) ? pPrevious[i - 4] : 0;
+			int Predictor = 0;
+			switch (FilterType)
+			{
+			case 0: Predictor = 0; break;
+			case 1: Predictor = Left; break;
+			case 2: Predictor = Up; break;
+			case 3: Predictor = (Left + Up) / 2; break;
+			case 4:
+			{
+				int Estimate = Left + Up - UpLeft;
+				int DistanceLeft = std::abs(Estimate - Left), DistanceUp = std::abs(Estimate - Up), DistanceUpLeft = std::abs(Estimate - UpLeft);
+				Predictor = (DistanceLeft <= DistanceUp && DistanceLeft <= DistanceUpLeft) ? Left : (DistanceUp <= DistanceUpLeft ? Up : UpLeft);
+				break;
+			}
+			default: throw std::runtime_error("invalid png filter type!");
+			}
+			pRow[i] = static_cast<uint8_t>(pSource[i] + Predictor);
+		}
+	}
+	return Pixels;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static std::vector<uint8_t> __decodePng(const std::vector<uint8_t>& vPng, uint32_t& voWidth, uint32_t& voHeight)
+{
+	const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+	if (vPng.size() < 8 || memcmp(vPng.data(), Signature, 8) != 0) throw std::runtime_error("missing png signature!");
+
+	std::vector<uint8_t> Stream;
+	std::vector<std::string> ChunkTypes;
+	size_t Offset = 8;
+	while (Offset < vPng.size())
+	{
+		if (Offset + 12 > vPng.size()) throw std::runtime_error("truncated png chunk!");
+		uint32_t Length = __readBigEndian(vPng.data() + Offset);
+		if (Offset + 12 + Length > vPng.size()) throw std::runtime_error("truncated png chunk!");
+
+		const uint8_t* pType = vPng.data() + Offset + 4;
+		const uint8_t* pData = pType + 4;
+		if (__readBigEndian(pData + Length) != CImageEncoder::updateCrc32(0, pType, Length + 4)) throw std::runtime_error("png chunk crc mismatch!");
+
+		std::string Type(reinterpret_cast<const char*>(pType), 4);
+		ChunkTypes.push_back(Type);
+		if ("IHDR" == Type)
+		{
+			if (Length != 13) throw std::runtime_error("invalid IHDR size!");
+			voWidth = __readBigEndian(pData);
+			voHeight = __readBigEndian(pData + 4);
+
+			//NOTE: 8-bit RGBA, deflate, adaptive filtering, no interlacing
+			const uint8_t Format[5] = { 8, 6, 0, 0, 0 };
+			if (memcmp(pData + 8, Format, 5) != 0) throw std::runtime_error("unexpected IHDR format!");
+		}
+		else if ("IDAT" == Type) Stream.insert(Stream.end(), pData, pData + Length);
+		Offset += 12 + Length;
+	}
+
+	if (ChunkTypes.size() < 3 || ChunkTypes.front() != "IHDR" || ChunkTypes.back() != "IEND") throw std::runtime_error("unexpected png chunk order!");
+	return __unfilterRows(__inflateFixed(Stream.data(), Stream.size()), voWidth, voHeight);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testChecksumReferenceValues)
+{
+	const char* pCheck = "123456789";
+	const uint8_t* pData = reinterpret_cast<const uint8_t*>(pCheck);
+	CHECK(CImageEncoder::updateCrc32(0, pData, 9) == 0xcbf43926);
+	CHECK(CImageEncoder::updateCrc32(CImageEncoder::updateCrc32(0, pData, 4), pData + 4, 5) == 0xcbf43926);
+	CHECK(CImageEncoder::updateCrc32(0, pData, 0) == 0);
+
+	const char* pIend = "IEND";
+	CHECK(CImageEncoder::updateCrc32(0, reinterpret_cast<const uint8_t*>(pIend), 4) == 0xae426082);
+
+	const char* pWikipedia = "Wikipedia";
+	CHECK(CImageEncoder::computeAdler32(reinterpret_cast<const uint8_t*>(pWikipedia), 9) == 0x11e60398);
+	CHECK(CImageEncoder::computeAdler32(nullptr, 0) == 1);
+
+	//NOTE: long enough to cross several 5552 byte reductions, all bytes at 0xff is the worst case for the sums
+	std::vector<uint8_t> Ones(100000, 0xff);
+	uint32_t A = 1, B = 0;
+	for (uint8_t Byte : Ones)
+	{
+		A = (A + Byte) % 65521;
+		B = (B + A) % 65521;
+	}
+	CHECK(CImageEncoder::computeAdler32(Ones.data(), Ones.size()) == ((B << 16) | A));
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testPngRoundTrip)
+{
+	//NOTE: flat areas, gradients and noise make every filter type and both literals and matches show up
+	const uint32_t Width = 37, Height = 23;
+	std::vector<uint8_t> Pixels(Width * Height * 4);
+	uint32_t Seed = 12345;
+	for (uint32_t y = 0; y < Height; ++y)
+	{
+		for (uint32_t x = 0; x < Width; ++x)
+		{
+			uint8_t* pPixel = Pixels.data() + (y * Width + x) * 4;
+			Seed = Seed * 1664525u + 1013904223u;
+			pPixel[0] = y < 8 ? 200 : static_cast<uint8_t>(x * 7);
+			pPixel[1] = static_cast<uint8_t>(y * 11 + x);
+			pPixel[2] = y >= 16 ? static_cast<uint8_t>(Seed >> 24) : 0;
+			pPixel[3] = 255;
+		}
+	}
+
+	std::vector<uint8_t> Png;
+	CImageEncoder::encodePng(Pixels.data(), Width, Height, Png);
+	uint32_t DecodedWidth = 0, DecodedHeight = 0;
+	CHECK(__decodePng(Png, DecodedWidth, DecodedHeight) == Pixels);
+	CHECK(Width == DecodedWidth && Height == DecodedHeight);
+
+	//NOTE: the same pixels have to give the same bytes, otherwise identical captures could not be compared as files
+	std::vector<uint8_t> SecondPng;
+	CImageEncoder::encodePng(Pixels.data(), Width, Height, SecondPng);
+	CHECK(SecondPng == Png);
+
+	const uint8_t SinglePixel[4] = { 1, 2, 3, 4 };
+	CImageEncoder::encodePng(SinglePixel, 1, 1, Png);
+	CHECK(__decodePng(Png, DecodedWidth, DecodedHeight) == std::vector<uint8_t>(SinglePixel, SinglePixel + 4));
+	CHECK(1 == DecodedWidth && 1 == DecodedHeight);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testLongRunsUseMatches)
+{
+	//NOTE: a solid image has to compress far below its raw size, which only happens when matches are emitted and decoded correctly
+	const uint32_t Width = 256, Height = 64;
+	std::vector<uint8_t> Pixels(Width * Height * 4);
+	for (size_t i = 0; i < Pixels.size(); i += 4)
+	{
+		Pixels[i] = 30;
+		Pixels[i + 1] = 60;
+		Pixels[i + 2] = 90;
+		Pixels[i + 3] = 255;
+	}
+
+	std::vector<uint8_t> Png;
+	CImageEncoder::encodePng(Pixels.data(), Width, Height, Png);
+	CHECK(Png.size() < Pixels.size() / 20);
+
+	uint32_t DecodedWidth = 0, DecodedHeight = 0;
+	CHECK(__decodePng(Png, DecodedWidth, DecodedHeight) == Pixels);
+}
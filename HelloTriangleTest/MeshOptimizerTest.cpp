@@ -0,0 +1,140 @@
+#include "TestFramework.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	const uint32_t GRID_SIZE = 48;
+	const uint32_t ANALYSIS_CACHE_SIZE = 16;
+
+	struct SGridVertex
+	{
+		float X;
+		float Y;
+	};
+}
+
+//******************************************************************************************
+//FUNCTION:
+static std::vector<char> __createGridSoup()
+{
+	//NOTE: two triangles per cell in shuffled order, so the soup starts out with poor locality
+	std::vector<std::array<SGridVertex, 3>> Triangles;
+	for (uint32_t y = 0; y < GRID_SIZE; ++y)
+	{
+		for (uint32_t x = 0; x < GRID_SIZE; ++x)
+		{
+			SGridVertex V00 = { static_cast<float>(x), static_cast<float>(y) }, V10 = { x + 1.0f, static_cast<float>(y) };
+			SGridVertex V01 = { static_cast<float>(x), y + 1.0f }, V11 = { x + 1.0f, y + 1.0f };
+			Triangles.push_back({ V00, V10, V11 });
+			Triangles.push_back({ V00, V11, V01 });
+		}
+	}
+	std::shuffle(Triangles.begin(), Triangles.end(), std::mt19937(7));
+
+	std::vector<char> Soup(Triangles.size() * sizeof(Triangles[0]));
+	memcpy(Soup.data(), Triangles.data(), Soup.size());
+	return Soup;
+}
+
+//******************************************************************************************
+//FUNCTION:
+static std::vector<std::array<float, 6>> __expandTriangles(const std::vector<char>& vVertices, const std::vector<uint32_t>& vIndices)
+{
+	//NOTE: each triangle is rotated to start at its smallest vertex, which keeps the winding but ignores where the optimizer started it
+	std::vector<std::array<float, 6>> Triangles;
+	for (size_t i = 0; i + 2 < vIndices.size(); i += 3)
+	{
+		std::array<SGridVertex, 3> Corners;
+		for (int k = 0; k < 3; ++k) memcpy(&Corners[k], vVertices.data() + vIndices[i + k] * sizeof(SGridVertex), sizeof(SGridVertex));
+
+		auto isLess = [](const SGridVertex& vLhs, const SGridVertex& vRhs) { return vLhs.X < vRhs.X || (vLhs.X == vRhs.X && vLhs.Y < vRhs.Y); };
+		std::rotate(Corners.begin(), std::min_element(Corners.begin(), Corners.end(), isLess), Corners.end());
+		Triangles.push_back({ Corners[0].X, Corners[0].Y, Corners[1].X, Corners[1].Y, Corners[2].X, Corners[2].Y });
+	}
+	std::sort(Triangles.begin(), Triangles.end());
+	return Triangles;
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testIndexBufferMergesOnlyIdenticalVertices)
+{
+	std::vector<char> Soup = __createGridSoup();
+	std::vector<char> Vertices = Soup;
+	std::vector<uint32_t> Indices;
+	CMeshOptimizer::generateIndexBuffer(Vertices, sizeof(SGridVertex), Indices);
+
+	CHECK(Vertices.size() == (GRID_SIZE + 1) * (GRID_SIZE + 1) * sizeof(SGridVertex));
+	CHECK(Indices.size() == Soup.size() / sizeof(SGridVertex));
+
+	//NOTE: every index has to point at a vertex with exactly the bytes of the soup vertex it replaced
+	bool IsEveryVertexKept = true;
+	for (size_t i = 0; i < Indices.size(); ++i)
+		IsEveryVertexKept = IsEveryVertexKept && memcmp(Vertices.data() + Indices[i] * sizeof(SGridVertex), Soup.data() + i * sizeof(SGridVertex), sizeof(SGridVertex)) == 0;
+	CHECK(IsEveryVertexKept);
+
+	//NOTE: negative zero differs from zero in its bytes, so the two must stay separate vertices
+	SGridVertex Signed[2] = { { 0.0f, 1.0f }, { -0.0f, 1.0f } };
+	std::vector<char> SignedVertices(reinterpret_cast<const char*>(Signed), reinterpret_cast<const char*>(Signed) + sizeof(Signed));
+	CMeshOptimizer::generateIndexBuffer(SignedVertices, sizeof(SGridVertex), Indices);
+	CHECK(SignedVertices.size() == sizeof(Signed));
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testVertexCacheOptimizationImprovesAcmr)
+{
+	std::vector<char> Vertices = __createGridSoup();
+	std::vector<uint32_t> Indices;
+	CMeshOptimizer::generateIndexBuffer(Vertices, sizeof(SGridVertex), Indices);
+	auto Reference = __expandTriangles(Vertices, Indices);
+
+	size_t VertexCount = Vertices.size() / sizeof(SGridVertex);
+	SVertexCacheStatistics Before = CMeshOptimizer::analyzeVertexCache(Indices, VertexCount, ANALYSIS_CACHE_SIZE);
+	CMeshOptimizer::optimizeVertexCache(Indices, VertexCount);
+	SVertexCacheStatistics After = CMeshOptimizer::analyzeVertexCache(Indices, VertexCount, ANALYSIS_CACHE_SIZE);
+
+	//NOTE: a shuffled grid misses on almost every vertex, a reasonable ordering gets close to one miss per triangle or better
+	CHECK(Before.Acmr > 2.0);
+	CHECK(After.Acmr < 1.0);
+	CHECK(After.Acmr <= Before.Acmr);
+	CHECK(After.Atvr >= 1.0);
+	CHECK(__expandTriangles(Vertices, Indices) == Reference);
+
+	//NOTE: optimizing an already optimized order must not make it worse
+	CMeshOptimizer::optimizeVertexCache(Indices, VertexCount);
+	CHECK(CMeshOptimizer::analyzeVertexCache(Indices, VertexCount, ANALYSIS_CACHE_SIZE).Acmr <= After.Acmr + 1e-9);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testVertexFetchOptimizationKeepsGeometry)
+{
+	std::vector<char> Vertices = __createGridSoup();
+	std::vector<uint32_t> Indices;
+	CMeshOptimizer::generateIndexBuffer(Vertices, sizeof(SGridVertex), Indices);
+	CMeshOptimizer::optimizeVertexCache(Indices, Vertices.size() / sizeof(SGridVertex));
+	auto Reference = __expandTriangles(Vertices, Indices);
+
+	//NOTE: an unreferenced vertex at the end has to be dropped
+	SGridVertex Unused = { -1.0f, -1.0f };
+	Vertices.insert(Vertices.end(), reinterpret_cast<const char*>(&Unused), reinterpret_cast<const char*>(&Unused) + sizeof(Unused));
+
+	CMeshOptimizer::optimizeVertexFetch(Vertices, sizeof(SGridVertex), Indices);
+	CHECK(Vertices.size() == (GRID_SIZE + 1) * (GRID_SIZE + 1) * sizeof(SGridVertex));
+	CHECK(__expandTriangles(Vertices, Indices) == Reference);
+
+	//NOTE: vertices are laid out in first use order, so no index may skip ahead of the next new vertex
+	uint32_t NextNewVertex = 0;
+	bool IsInFirstUseOrder = true;
+	for (uint32_t Index : Indices)
+	{
+		IsInFirstUseOrder = IsInFirstUseOrder && Index <= NextNewVertex;
+		if (Index == NextNewVertex) ++NextNewVertex;
+	}
+	CHECK(IsInFirstUseOrder);
+}
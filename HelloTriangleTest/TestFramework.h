@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iostream>
+#include <exception>
+
+//NOTE: just enough to register and run checks without a third party framework; every test case runs even after an earlier one failed
+class CTestRegistry
+{
+public:
+	static CTestRegistry& getInstance()
+	{
+		static CTestRegistry Registry;
+		return Registry;
+	}
+
+	bool add(const char* vName, void (*vFunction)())
+	{
+		m_TestCases.push_back({ vName, vFunction });
+		return true;
+	}
+
+	void reportFailure(const char* vFile, int vLine, const std::string& vMessage)
+	{
+		std::cerr << vFile << "(" << vLine << "): " << vMessage << std::endl;
+		++m_CurrentFailureCount;
+	}
+
+	//NOTE: returns the number of failed test cases, an exception escaping a test case fails it too
+	int runAll()
+	{
+		int FailedCount = 0;
+		for (const auto& TestCase : m_TestCases)
+		{
+			m_CurrentFailureCount = 0;
+			try
+			{
+				TestCase.pFunction();
+			}
+			catch (const std::exception& vError)
+			{
+				reportFailure(TestCase.pName, 0, std::string("unexpected exception: ") + vError.what());
+			}
+
+			std::cerr << (m_CurrentFailureCount > 0 ? "[FAILED] " : "[passed] ") << TestCase.pName << std::endl;
+			if (m_CurrentFailureCount > 0) ++FailedCount;
+		}
+
+		std::cerr << m_TestCases.size() - FailedCount << " of " << m_TestCases.size() << " test cases passed" << std::endl;
+		return FailedCount;
+	}
+
+private:
+	struct STestCase
+	{
+		const char* pName;
+		void (*pFunction)();
+	};
+
+	std::vector<STestCase> m_TestCases;
+	int m_CurrentFailureCount = 0;
+};
+
+#define TEST_CASE(Name) \
+	static void Name(); \
+	static const bool Name##IsRegistered = CTestRegistry::getInstance().add(#Name, &Name); \
+	static void Name()
+
+#define CHECK(Expression) \
+	do { if (!(Expression)) CTestRegistry::getInstance().reportFailure(__FILE__, __LINE__, "check failed: " #Expression); } while (0)
+
+#define CHECK_THROWS(Expression) \
+	do { bool IsThrown = false; try { Expression; } catch (...) { IsThrown = true; } \
+		if (!IsThrown) CTestRegistry::getInstance().reportFailure(__FILE__, __LINE__, "expected an exception: " #Expression); } while (0)
@@ -0,0 +1,73 @@
+#include "TestFramework.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testEveryTaskRunsOnce)
+{
+	CThreadPool ThreadPool(4);
+	CHECK(ThreadPool.getThreadCount() == 4);
+
+	const size_t TaskCount = 1000;
+	std::vector<std::atomic<uint32_t>> RunCounts(TaskCount);
+	std::atomic<bool> IsThreadIndexValid{ true };
+	ThreadPool.parallelFor(TaskCount, [&](uint32_t vThreadIndex, size_t vTaskIndex)
+	{
+		if (vThreadIndex >= ThreadPool.getThreadCount()) IsThreadIndexValid = false;
+		++RunCounts[vTaskIndex];
+	});
+
+	CHECK(IsThreadIndexValid);
+	bool IsEveryTaskRunOnce = true;
+	for (const auto& Count : RunCounts) IsEveryTaskRunOnce = IsEveryTaskRunOnce && 1 == Count;
+	CHECK(IsEveryTaskRunOnce);
+
+	//NOTE: no tasks must not wake the workers at all
+	ThreadPool.parallelFor(0, [&](uint32_t, size_t) { IsThreadIndexValid = false; });
+	CHECK(IsThreadIndexValid);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testExceptionPropagatesToCaller)
+{
+	CThreadPool ThreadPool(4);
+
+	std::string Message;
+	try
+	{
+		ThreadPool.parallelFor(64, [](uint32_t, size_t vTaskIndex)
+		{
+			if (13 == vTaskIndex) throw std::runtime_error("task 13 failed");
+		});
+	}
+	catch (const std::runtime_error& vError)
+	{
+		Message = vError.what();
+	}
+	CHECK(Message == "task 13 failed");
+
+	//NOTE: a failed batch must leave the pool usable, and its exception must not show up again in the next one
+	std::atomic<size_t> RunCount{ 0 };
+	ThreadPool.parallelFor(64, [&](uint32_t, size_t) { ++RunCount; });
+	CHECK(64 == RunCount);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testSingleThreadPool)
+{
+	//NOTE: zero threads are clamped to one, otherwise parallelFor would wait forever
+	CThreadPool ThreadPool(0);
+	CHECK(ThreadPool.getThreadCount() == 1);
+
+	size_t Sum = 0;
+	ThreadPool.parallelFor(100, [&](uint32_t, size_t vTaskIndex) { Sum += vTaskIndex; });
+	CHECK(4950 == Sum);
+
+	CHECK_THROWS(ThreadPool.parallelFor(1, [](uint32_t, size_t) { throw std::runtime_error("failed"); }));
+}
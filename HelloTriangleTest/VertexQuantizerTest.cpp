@@ -0,0 +1,127 @@
+#include "TestFramework.h"
+#include "VertexQuantizer.h"
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+//******************************************************************************************
+//FUNCTION:
+static uint16_t __quantizeHalf(float vValue, bool vIsScalar)
+{
+	float Vertex[5] = { vValue, 0.0f, 0.0f, 0.0f, 0.0f };
+	char Packed[8];
+	if (vIsScalar)
+		CVertexQuantizer::quantizeScalar(EVertexFormat::Half16, Vertex, 1, Packed);
+	else
+		CVertexQuantizer::quantize(EVertexFormat::Half16, Vertex, 1, Packed);
+
+	uint16_t Half;
+	memcpy(&Half, Packed, sizeof(Half));
+	return Half;
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testHalfRoundsToNearestEven)
+{
+	for (bool IsScalar : { true, false })
+	{
+		CHECK(__quantizeHalf(1.0f, IsScalar) == 0x3c00);
+		CHECK(__quantizeHalf(-2.0f, IsScalar) == 0xc000);
+		CHECK(__quantizeHalf(-0.0f, IsScalar) == 0x8000);
+
+		//NOTE: halfway between two halves goes to the even one, anything past halfway rounds up
+		CHECK(__quantizeHalf(1.0f + std::ldexp(1.0f, -11), IsScalar) == 0x3c00);
+		CHECK(__quantizeHalf(1.0f + 3.0f * std::ldexp(1.0f, -11), IsScalar) == 0x3c02);
+		CHECK(__quantizeHalf(std::nextafter(1.0f + std::ldexp(1.0f, -11), 2.0f), IsScalar) == 0x3c01);
+
+		//NOTE: rounding up out of the largest finite half overflows to infinity
+		CHECK(__quantizeHalf(65504.0f, IsScalar) == 0x7bff);
+		CHECK(__quantizeHalf(65519.0f, IsScalar) == 0x7bff);
+		CHECK(__quantizeHalf(65520.0f, IsScalar) == 0x7c00);
+		CHECK(__quantizeHalf(std::numeric_limits<float>::infinity(), IsScalar) == 0x7c00);
+
+		uint16_t NaN = __quantizeHalf(std::numeric_limits<float>::quiet_NaN(), IsScalar);
+		CHECK((NaN & 0x7c00) == 0x7c00 && (NaN & 0x03ff) != 0);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testHalfDenormals)
+{
+	for (bool IsScalar : { true, false })
+	{
+		CHECK(__quantizeHalf(std::ldexp(1.0f, -14), IsScalar) == 0x0400);
+		CHECK(__quantizeHalf(std::ldexp(1.0f, -24), IsScalar) == 0x0001);
+		CHECK(__quantizeHalf(std::ldexp(1023.0f, -24), IsScalar) == 0x03ff);
+
+		//NOTE: ties between denormals go to even as well, including the one that rounds up into the smallest normal
+		CHECK(__quantizeHalf(std::ldexp(1.0f, -25), IsScalar) == 0x0000);
+		CHECK(__quantizeHalf(std::ldexp(3.0f, -25), IsScalar) == 0x0002);
+		CHECK(__quantizeHalf(std::ldexp(2047.0f, -25), IsScalar) == 0x0400);
+		CHECK(__quantizeHalf(std::nextafter(std::ldexp(1.0f, -25), 1.0f), IsScalar) == 0x0001);
+		CHECK(__quantizeHalf(-std::ldexp(1.0f, -24), IsScalar) == 0x8001);
+
+		//NOTE: float denormals and everything below half of the smallest half denormal flush to signed zero
+		CHECK(__quantizeHalf(std::ldexp(1.0f, -26), IsScalar) == 0x0000);
+		CHECK(__quantizeHalf(-std::numeric_limits<float>::denorm_min(), IsScalar) == 0x8000);
+	}
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testSnorm16AndColorQuantization)
+{
+	const float Vertices[] =
+	{
+		1.0f, -1.0f, 1.0f, 0.0f, 0.5f,
+		2.0f, -3.0f, 1.5f, -1.0f, 0.25f,
+		0.5f, 0.0f, 0.2f, 0.4f, 0.6f
+	};
+	char Packed[3 * 8];
+	CVertexQuantizer::quantize(EVertexFormat::Snorm16, Vertices, 3, Packed);
+
+	int16_t Positions[2];
+	uint8_t Colors[4];
+	memcpy(Positions, Packed, sizeof(Positions));
+	memcpy(Colors, Packed + 4, sizeof(Colors));
+	CHECK(Positions[0] == 32767 && Positions[1] == -32767);
+	CHECK(Colors[0] == 255 && Colors[1] == 0 && Colors[2] == 128 && Colors[3] == 255);
+
+	//NOTE: positions and colors are clamped instead of wrapping around
+	memcpy(Positions, Packed + 8, sizeof(Positions));
+	memcpy(Colors, Packed + 12, sizeof(Colors));
+	CHECK(Positions[0] == 32767 && Positions[1] == -32767);
+	CHECK(Colors[0] == 255 && Colors[1] == 0 && Colors[2] == 64 && Colors[3] == 255);
+
+	memcpy(Positions, Packed + 16, sizeof(Positions));
+	CHECK(Positions[0] == 16384 && Positions[1] == 0);
+}
+
+//******************************************************************************************
+//FUNCTION:
+TEST_CASE(testVectorPathMatchesScalar)
+{
+	//NOTE: an odd count leaves a tail for the scalar path, the values mix ordinary, clamped, tie and denormal inputs
+	const size_t VertexCount = 203;
+	std::vector<float> Vertices(VertexCount * 5);
+	for (size_t i = 0; i < Vertices.size(); ++i)
+	{
+		float Value = std::sin(static_cast<float>(i) * 0.37f) * 1.25f;
+		if (0 == i % 7) Value = std::ldexp(static_cast<float>(i % 5) + 0.5f, -24);
+		if (0 == i % 11) Value = static_cast<float>(i % 3) / 510.0f;
+		Vertices[i] = Value;
+	}
+
+	for (EVertexFormat Format : { EVertexFormat::Snorm16, EVertexFormat::Half16 })
+	{
+		std::vector<char> Vector(VertexCount * 8), Scalar(VertexCount * 8);
+		CVertexQuantizer::quantize(Format, Vertices.data(), VertexCount, Vector.data());
+		CVertexQuantizer::quantizeScalar(Format, Vertices.data(), VertexCount, Scalar.data());
+		CHECK(Vector == Scalar);
+	}
+
+	CHECK_THROWS(CVertexQuantizer::quantizeScalar(EVertexFormat::Float32, Vertices.data(), VertexCount, nullptr));
+}
@@ -0,0 +1,7 @@
+#include "TestFramework.h"
+#include <cstdlib>
+
+int main()
+{
+	return CTestRegistry::getInstance().runAll() > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}